@@ -27,12 +27,19 @@ EXPORT void lweSymEncrypt(LweSample* result, Torus32 message, double alpha, cons
  * This function encrypts a message by using key and a given noise value
 */
 EXPORT void lweSymEncryptWithExternalNoise(LweSample* result, Torus32 message, double noise, double alpha, const LweKey* key);
+/*
+ * Same as above, on a raw ciphertext: a[0..n-1] is the mask and a[n] is b
+ * (this is the layout of the keyswitch key entries)
+*/
+EXPORT void lweSymEncryptRawWithExternalNoise(Torus32* a, Torus32 message, double noise, const LweKey* key);
 
 
 /**
  * This function computes the phase of sample by using key : phi = b - a.s
  */
 EXPORT Torus32 lwePhase(const LweSample* sample, const LweKey* key);
+/** phase of a raw ciphertext (a[0..n-1],b=a[n]) */
+EXPORT Torus32 lwePhaseRaw(const Torus32* a, const LweKey* key);
 
 
 /**
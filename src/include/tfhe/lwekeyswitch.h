@@ -8,22 +8,39 @@
 #include "lweparams.h"
 #include "lwesamples.h"
 
+/**
+ * The keyswitch key is stored in one contiguous (64-byte aligned) slab.
+ * The entry (i,j,h) encodes h.s'[i]/base^(j+1) as n_out Torus32 (a)
+ * followed by 1 Torus32 (b). The trivial entries h=0 are not stored, the
+ * entries are sorted by input coefficient i, then digit position j, then
+ * digit value h=1..base-1, and two consecutive entries are stride Torus32 apart.
+ */
 struct LweKeySwitchKey {
     int32_t n; ///< length of the input key: s'
     int32_t t; ///< decomposition length
     int32_t basebit; ///< log_2(base)
     int32_t base; ///< decomposition base: a power of 2 
     const LweParams* out_params; ///< params of the output key s 
-    LweSample* ks0_raw; //tableau qui contient tout les Lwe samples de taille nlbase
-    LweSample** ks1_raw;// de taille nl  pointe vers un tableau ks0_raw dont les cases sont espaceés de base positions
-    LweSample*** ks; ///< the keyswitch elements: a n.l.base matrix
-    // de taille n pointe vers ks1 un tableau dont les cases sont espaceés de ell positions
+    int32_t stride; ///< distance between two entries: n_out+1 rounded up to a cache line
+    double current_variance; ///< the (common) variance of all the entries
+    Torus32* data; ///< the keyswitch elements: a n.t.(base-1) matrix of entries
 
 #ifdef __cplusplus
-    LweKeySwitchKey(int32_t n, int32_t t, int32_t basebit, const LweParams* out_params, LweSample* ks0_raw);
+    LweKeySwitchKey(int32_t n, int32_t t, int32_t basebit, const LweParams* out_params);
     ~LweKeySwitchKey();
     LweKeySwitchKey(const LweKeySwitchKey&) = delete;
     void operator=(const LweKeySwitchKey&) = delete;
+
+    /** number of Torus32 used by the slab: n.t.(base-1).stride */
+    int64_t data_size() const { return int64_t(n) * t * (base - 1) * stride; }
+
+    /** the entry which encodes h.s'[i]/base^(j+1), for 1<=h<base */
+    Torus32* entry(int32_t i, int32_t j, int32_t h) {
+        return data + (int64_t(i * t + j) * (base - 1) + h - 1) * stride;
+    }
+    const Torus32* entry(int32_t i, int32_t j, int32_t h) const {
+        return data + (int64_t(i * t + j) * (base - 1) + h - 1) * stride;
+    }
 #endif
 };
 
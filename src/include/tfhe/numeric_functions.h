@@ -8,8 +8,31 @@
 
 #ifdef __cplusplus
 #include <random>
-extern std::default_random_engine generator;
-extern std::uniform_int_distribution<Torus32> uniformTorus32_distrib;
+#include <vector>
+#include "tfhe_random.h"
+// each thread owns its generator, so that the library can be called from several threads
+extern thread_local TfheRandomEngine generator;
+extern thread_local std::uniform_int_distribution<Torus32> uniformTorus32_distrib;
+
+/**
+ * seeds of independent random streams, drawn from the generator of the calling thread.
+ * A parallel task reseeds the generator of its thread with its own stream, so that
+ * the random values it draws only depend on the initial seed, and not on the number
+ * of threads nor on the scheduling. The generator of the calling thread is restored
+ * when the streams are destroyed.
+ */
+class TfheRandomStreams {
+    std::vector<uint32_t> seeds;
+    TfheRandomEngine saved_generator;
+public:
+    static const int32_t SEED_WORDS = TfheRandomEngine::KEY_WORDS; ///< number of 32-bit words per stream seed
+
+    TfheRandomStreams(int32_t nb_streams);
+    ~TfheRandomStreams();
+
+    /** reseeds the generator of the calling thread with the given stream */
+    void use_stream(int32_t stream) const;
+};
 static const int64_t _two31 = INT64_C(1) << 31; // 2^31
 static const int64_t _two32 = INT64_C(1) << 32; // 2^32
 static const double _two32_double = _two32;
@@ -22,6 +45,21 @@ static const double _two31_double = _two31;
  */ 
 EXPORT Torus32 gaussian32(Torus32 message, double sigma);
 
+/** 
+ * bulk version of gaussian32: result[i] = gaussian32(messages[i], sigma)
+ * (messages may be NULL, in which case the messages are 0)
+ */ 
+EXPORT void gaussian32_array(Torus32* result, const Torus32* messages, int32_t size, double sigma);
+
+/** fills result with size independent gaussian values of standard deviation sigma */
+EXPORT void gaussianDouble_array(double* result, int32_t size, double sigma);
+
+/** fills result with size independent uniform Torus32 values */
+EXPORT void uniformTorus32_array(Torus32* result, int32_t size);
+
+/** fills result with size independent uniform binary values (0 or 1) */
+EXPORT void uniformBinary_array(int32_t* result, int32_t size);
+
 /** conversion from double to Torus32 */
 EXPORT Torus32 dtot32(double d);
 /** conversion from Torus32 to double */
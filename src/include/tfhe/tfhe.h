@@ -8,6 +8,10 @@
 
 #include "numeric_functions.h"
 
+#include "tfhe_threads.h"
+
+#include "tfhe_numa.h"
+
 #include "polynomials_arithmetic.h"
 #include "lagrangehalfc_arithmetic.h"
 
@@ -19,10 +23,34 @@
 
 #include "lwekeyswitch.h"
 
+#include "tlwekeyswitch.h"
+
 #include "lwebootstrappingkey.h"
 
 #include "tfhe_gate_bootstrapping_functions.h"
 
+#include "tfhe_leveled.h"
+
+#include "tfhe_circuit_bootstrapping.h"
+
+#include "tfhe_cmux.h"
+
+#include "tfhe_rom.h"
+
+#include "tfhe_ram.h"
+
+#include "tfhe_gate_executor.h"
+
+#include "tfhe_integer.h"
+
+#include "tfhe_netlist.h"
+
+#include "tfhe_async.h"
+
+#include "tfhe_distributed.h"
+
+#include "tfhe_sequential.h"
+
 #include "tfhe_io.h"
 
 ///////////////////////////////////////////////////
@@ -0,0 +1,135 @@
+#ifndef TFHE_ASYNC_H
+#define TFHE_ASYNC_H
+
+///@file
+///@brief This file declares the asynchronous gate API: the gates are submitted to an engine
+///which evaluates them on its own threads, and their completion is reported by a callback,
+///a completion queue, or (in C++) a future
+
+#include "tfhe_core.h"
+#include "tfhe_gate_executor.h"
+
+struct TfheAsyncEngine;
+struct TfheCompletionQueue;
+#ifndef __cplusplus
+typedef struct TfheAsyncEngine TfheAsyncEngine;
+typedef struct TfheCompletionQueue TfheCompletionQueue;
+#endif
+
+/** called (on a thread of the engine) when a gate is done */
+typedef void (*TfheGateCallback)(void *user_data);
+
+/**
+ * creates an engine with its own nb_threads threads (0 means tfhe_get_nb_threads()).
+ * The cloud key must outlive the engine.
+ */
+EXPORT TfheAsyncEngine *new_TfheAsyncEngine(const TFheGateBootstrappingCloudKeySet *bk, int32_t nb_threads);
+
+/** waits for all the submitted gates, then deletes the engine */
+EXPORT void delete_TfheAsyncEngine(TfheAsyncEngine *engine);
+
+/**
+ * submits the gate result = type(a,b,c) (or value for the constant gate), and returns immediately.
+ * The gate starts when the previously submitted gates which write its inputs, or which read or
+ * write its result, are done: a sequence of dependent gates can be submitted without waiting.
+ * The samples must stay allocated until the gate is done.
+ * @param callback called when the result is written (may be NULL)
+ */
+EXPORT void tfhe_async_submit(TfheAsyncEngine *engine, TfheGateType type, LweSample *result,
+                              const LweSample *a, const LweSample *b, const LweSample *c, int32_t value,
+                              TfheGateCallback callback, void *user_data);
+
+/** same as tfhe_async_submit, but the tag is pushed to the completion queue when the gate is done */
+EXPORT void tfhe_async_submit_to_queue(TfheAsyncEngine *engine, TfheGateType type, LweSample *result,
+                                       const LweSample *a, const LweSample *b, const LweSample *c, int32_t value,
+                                       TfheCompletionQueue *queue, uint64_t tag);
+
+/** number of submitted gates which are not done yet */
+EXPORT int32_t tfhe_async_nb_pending(TfheAsyncEngine *engine);
+
+/** waits until all the submitted gates are done */
+EXPORT void tfhe_async_wait_all(TfheAsyncEngine *engine);
+
+/** creates an empty completion queue (it can be shared by several engines) */
+EXPORT TfheCompletionQueue *new_TfheCompletionQueue();
+
+EXPORT void delete_TfheCompletionQueue(TfheCompletionQueue *queue);
+
+/** pops the tag of a completed gate: returns 1, or 0 if no gate completed yet */
+EXPORT int32_t tfhe_completion_queue_poll(TfheCompletionQueue *queue, uint64_t *tag);
+
+/** waits for a completed gate, and returns its tag */
+EXPORT uint64_t tfhe_completion_queue_wait(TfheCompletionQueue *queue);
+
+#ifdef __cplusplus
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct TfheCompletionQueue {
+    std::mutex lock;
+    std::condition_variable cv;
+    std::deque<uint64_t> tags;
+
+    void push(uint64_t tag);
+};
+
+struct TfheAsyncEngine {
+    const TFheGateBootstrappingCloudKeySet *const bk;
+
+    TfheAsyncEngine(const TFheGateBootstrappingCloudKeySet *bk, int32_t nb_threads = 0);
+    ~TfheAsyncEngine();
+    TfheAsyncEngine(const TfheAsyncEngine &) = delete;
+    void operator=(const TfheAsyncEngine &) = delete;
+
+    /** submits a gate: done() is called on a thread of the engine when the result is written */
+    void submit(TfheGateType type, LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
+                int32_t value, const std::function<void()> &done);
+
+    /** submits a gate, and returns a future which is ready when the result is written */
+    std::future<void> submit(TfheGateType type, LweSample *result, const LweSample *a, const LweSample *b,
+                             const LweSample *c, int32_t value = 0);
+
+    int32_t nb_pending();
+
+    void wait_all();
+
+private:
+    /** one submitted gate */
+    struct Task {
+        TfheGateType type;
+        LweSample *result;
+        const LweSample *in[3];
+        int32_t value;
+        std::function<void()> done;
+        std::vector<Task *> successors;
+        int32_t nb_predecessors;   ///< not done yet
+    };
+
+    /** the pending gate which writes a sample, and the pending gates which read it */
+    struct SampleState {
+        Task *writer;
+        std::vector<Task *> readers;
+    };
+
+    std::mutex lock;
+    std::condition_variable ready_cv;
+    std::condition_variable idle_cv;
+    std::deque<Task *> ready;
+    std::map<const LweSample *, SampleState> samples;
+    int32_t nb_tasks;              ///< submitted and not done
+    bool stopping;
+    std::vector<std::thread> workers;
+
+    void add_dependency(Task *from, Task *to);
+    void release(Task *task);
+    void worker_loop(int32_t index, int32_t nb_workers);
+};
+#endif
+
+#endif //TFHE_ASYNC_H
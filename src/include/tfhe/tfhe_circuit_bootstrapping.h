@@ -0,0 +1,55 @@
+#ifndef TFHE_CIRCUIT_BOOTSTRAPPING_H
+#define TFHE_CIRCUIT_BOOTSTRAPPING_H
+
+///@file
+///@brief This file declares the circuit bootstrapping: a gate bootstrapping ciphertext of a bit m is
+///converted to a TGsw sample of m, which can select between TLwe samples with one external product
+///(a CMux) instead of the two bootstraps of bootsMUX.
+///
+///Each of the l levels of the result is a bootstrap of the input to m.h[j] (under the extracted key),
+///followed by k+1 private keyswitches to the rows of the TGsw sample: row (u,j) encrypts -s_u.m.h[j]
+///for u<k, and m.h[j] for u=k. The rows inherit the error of the bootstrapping, so the gate
+///bootstrapping key must be precise: a small noise and a fine decomposition (e.g. l=6, Bg=32),
+///since the external products multiply this error by the digits of the result decomposition.
+
+#include "tfhe_core.h"
+
+struct TfheCircuitBootstrappingKey;
+#ifndef __cplusplus
+typedef struct TfheCircuitBootstrappingKey TfheCircuitBootstrappingKey;
+#endif
+
+/**
+ * creates the keys of the circuit bootstrapping from a secret keyset.
+ * The result is a TGsw sample of the tgsw key of the keyset, with the decomposition of tgsw_params
+ * (whose tlwe params must be the ones of the keyset). The keyset must outlive the result.
+ * @param ks_t,ks_basebit the decomposition of the private keyswitch (ks_t.ks_basebit < 32)
+ */
+EXPORT TfheCircuitBootstrappingKey *new_TfheCircuitBootstrappingKey(const TFheGateBootstrappingSecretKeySet *key,
+                                                                    const TGswParams *tgsw_params,
+                                                                    int32_t ks_t, int32_t ks_basebit);
+
+EXPORT void delete_TfheCircuitBootstrappingKey(TfheCircuitBootstrappingKey *cbk);
+
+/** result = TGsw(m), where x is a gate bootstrapping ciphertext of the bit m */
+EXPORT void tfhe_circuitBootstrap(TGswSample *result, const TfheCircuitBootstrappingKey *cbk, const LweSample *x);
+
+/** same as tfhe_circuitBootstrap, in the FFT domain (ready for tGswFFTExternMulToTLwe) */
+EXPORT void tfhe_circuitBootstrap_FFT(TGswSampleFFT *result, const TfheCircuitBootstrappingKey *cbk,
+                                      const LweSample *x);
+
+#ifdef __cplusplus
+struct TfheCircuitBootstrappingKey {
+    const TFheGateBootstrappingCloudKeySet *const bk;   ///< the gate bootstrapping key
+    const TGswParams *const tgsw_params;                ///< the params of the result
+    LweToTLweKeySwitchKey *const ks;                    ///< k+1 private keyswitch keys: -s_u.x for u<k, then x
+
+    TfheCircuitBootstrappingKey(const TFheGateBootstrappingCloudKeySet *bk, const TGswParams *tgsw_params,
+                                LweToTLweKeySwitchKey *ks);
+    ~TfheCircuitBootstrappingKey();
+    TfheCircuitBootstrappingKey(const TfheCircuitBootstrappingKey &) = delete;
+    void operator=(const TfheCircuitBootstrappingKey &) = delete;
+};
+#endif
+
+#endif //TFHE_CIRCUIT_BOOTSTRAPPING_H
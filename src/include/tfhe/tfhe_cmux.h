@@ -0,0 +1,84 @@
+#ifndef TFHE_CMUX_H
+#define TFHE_CMUX_H
+
+///@file
+///@brief This file declares the CMux between TLwe samples: a TGsw sample of a bit selects between two
+///TLwe samples with one external product, c0 + selector.(c1-c0), instead of the bootstraps of bootsMUX.
+///A CMux tree selects among 2^m TLwe samples with m TGsw selectors (e.g. circuit bootstrapped
+///address bits): the 2^(m-1-t) CMuxes of level t are independent, and run on several threads.
+///
+///The error of the result is the one of the selected input, plus the error of each external product:
+///the depth of a tree is limited by the precision of the selectors.
+
+#include "tfhe_core.h"
+
+struct TfheCMuxTree;
+#ifndef __cplusplus
+typedef struct TfheCMuxTree TfheCMuxTree;
+#endif
+
+/** result = selector ? c1 : c0 (result may be c0 or c1) */
+EXPORT void tLweCMux(TLweSample *result, const TGswSample *selector, const TLweSample *c0, const TLweSample *c1,
+                     const TGswParams *params);
+
+/** result = selector ? c1 : c0 (result may be c0 or c1) */
+EXPORT void tLweCMuxFFT(TLweSample *result, const TGswSampleFFT *selector, const TLweSample *c0,
+                        const TLweSample *c1, const TGswParams *params);
+
+/**
+ * creates the temporary samples of the CMux trees of depth m
+ * @param nb_threads the threads which evaluate the CMuxes of a level (0 means tfhe_get_nb_threads())
+ */
+EXPORT TfheCMuxTree *new_TfheCMuxTree(const TGswParams *params, int32_t m, int32_t nb_threads);
+
+EXPORT void delete_TfheCMuxTree(TfheCMuxTree *tree);
+
+/**
+ * result = data[x], where x = sum(selectors[i].2^i) for 0<=i<m: selectors[0] is the lsb of the index,
+ * and selects within the pairs of data at the first level of the tree.
+ * @param data the 2^m inputs (they are not modified)
+ */
+EXPORT void tfhe_cmuxTree(TLweSample *result, TfheCMuxTree *tree, const TGswSampleFFT *selectors,
+                          const TLweSample *data);
+
+#ifdef __cplusplus
+#include <vector>
+
+/**
+ * The temporary samples of one CMux. Each thread owns one,
+ * so that the CMuxes do not allocate anything.
+ */
+class TfheCMuxWorkspace {
+public:
+    const TGswParams *const params;
+    TGswFFTWorkspace *extprod;          ///< the buffers of the external product
+    TLweSample *diff;                   ///< c1-c0
+
+    explicit TfheCMuxWorkspace(const TGswParams *params);
+    ~TfheCMuxWorkspace();
+    TfheCMuxWorkspace(const TfheCMuxWorkspace &) = delete;
+    void operator=(const TfheCMuxWorkspace &) = delete;
+};
+
+/** same as tLweCMuxFFT, using the given workspace */
+void tLweCMuxFFT(TLweSample *result, const TGswSampleFFT *selector, const TLweSample *c0, const TLweSample *c1,
+                 TfheCMuxWorkspace &ws);
+
+struct TfheCMuxTree {
+    const TGswParams *const params;
+    const int32_t m;            ///< depth of the tree: 2^m inputs
+    const int32_t nb_threads;
+    TLweSample *level[2];       ///< the outputs of the even and odd levels (2^(m-1) and 2^(m-2) samples)
+    std::vector<TfheCMuxWorkspace *> workspaces;   ///< one per thread
+
+    TfheCMuxTree(const TGswParams *params, int32_t m, int32_t nb_threads);
+    ~TfheCMuxTree();
+    TfheCMuxTree(const TfheCMuxTree &) = delete;
+    void operator=(const TfheCMuxTree &) = delete;
+
+    /** number of samples of level[parity] */
+    int32_t level_size(int32_t parity) const { return m > parity + 1 ? 1 << (m - parity - 1) : 1; }
+};
+#endif
+
+#endif //TFHE_CMUX_H
@@ -32,6 +32,7 @@ struct LweParams;
 struct LweKey;
 struct LweSample;
 struct LweKeySwitchKey;
+struct LweToTLweKeySwitchKey;
 struct TLweParams;
 struct TLweKey;
 struct TLweSample;
@@ -55,6 +56,7 @@ typedef struct LweParams           LweParams;
 typedef struct LweKey              LweKey;
 typedef struct LweSample           LweSample;
 typedef struct LweKeySwitchKey     LweKeySwitchKey;
+typedef struct LweToTLweKeySwitchKey LweToTLweKeySwitchKey;
 typedef struct TLweParams       TLweParams;
 typedef struct TLweKey          TLweKey;
 typedef struct TLweSample       TLweSample;
@@ -0,0 +1,85 @@
+#ifndef TFHE_DISTRIBUTED_H
+#define TFHE_DISTRIBUTED_H
+
+///@file
+///@brief This file declares the distributed netlist evaluation: a coordinator partitions a netlist
+///between worker processes, which hold the cloud key and evaluate their gates level by level.
+///The ciphertexts go through the coordinator, over Unix or TCP sockets.
+///
+///An address is either "unix:/path/to/socket", or "host:port" for TCP (a worker listens on all
+///the interfaces when the host is empty or "*", e.g. "*:7000").
+
+#include "tfhe_core.h"
+#include "tfhe_netlist.h"
+
+struct TfheDistributedNetlist;
+#ifndef __cplusplus
+typedef struct TfheDistributedNetlist TfheDistributedNetlist;
+#endif
+
+/**
+ * opens a listening socket for a worker.
+ * @return the socket, or -1 (and prints the reason on stderr) on error
+ */
+EXPORT int32_t tfhe_worker_listen(const char *address);
+
+/**
+ * serves the coordinators which connect to the listening socket, one session at a time.
+ * The cloud key is loaded once by the caller, and shared by all the sessions.
+ * @param nb_threads the threads which evaluate the gates of a level (0 means tfhe_get_nb_threads())
+ * @param nb_sessions the number of sessions to serve before returning (0 means forever)
+ * @return the number of sessions which ended normally
+ */
+EXPORT int32_t tfhe_worker_serve(int32_t listen_socket, const TFheGateBootstrappingCloudKeySet *bk,
+                                 int32_t nb_threads, int32_t nb_sessions);
+
+/**
+ * connects to the workers, and sends them their part of the netlist: the bootstrapped gates of
+ * each level are spread evenly over the workers, next to the gates which compute their inputs.
+ * The netlist must outlive the result.
+ * @return NULL (and prints the reason on stderr) if a worker cannot be reached
+ */
+EXPORT TfheDistributedNetlist *new_TfheDistributedNetlist(const TfheNetlist *netlist, const char *const *workers,
+                                                          int32_t nb_workers,
+                                                          const TFheGateBootstrappingParameterSet *params);
+
+/** ends the sessions, and deletes the coordinator */
+EXPORT void delete_TfheDistributedNetlist(TfheDistributedNetlist *distributed);
+
+/**
+ * evaluates the netlist on the workers (see tfhe_netlist_eval).
+ * @return 1, or 0 (and prints the reason on stderr) if a worker failed
+ */
+EXPORT int32_t tfhe_distributed_eval(TfheDistributedNetlist *distributed, LweSample *outputs,
+                                     const LweSample *inputs, LweSample *state);
+
+/** number of ciphertexts sent or received by the coordinator since its creation */
+EXPORT int64_t tfhe_distributed_nb_transfers(const TfheDistributedNetlist *distributed);
+
+#ifdef __cplusplus
+#include <vector>
+
+/** the part of a netlist evaluated by one worker */
+struct TfheWorkerPlan {
+    TfheNetlist netlist;                         ///< the gates of the worker, with the wires of the whole netlist
+    std::vector<std::vector<int32_t> > send;     ///< per level: the wires returned to the coordinator
+};
+
+struct TfheDistributedNetlist {
+    const TfheNetlist *const netlist;
+    const TFheGateBootstrappingParameterSet *const params;
+    std::vector<int32_t> sockets;
+    std::vector<TfheWorkerPlan> plans;
+    std::vector<std::vector<std::vector<int32_t> > > receive;   ///< per worker and level: the wires sent to the worker
+    LweSample *wires;                                           ///< the wires known by the coordinator
+    int64_t nb_transfers;
+
+    TfheDistributedNetlist(const TfheNetlist *netlist, int32_t nb_workers,
+                           const TFheGateBootstrappingParameterSet *params);
+    ~TfheDistributedNetlist();
+    TfheDistributedNetlist(const TfheDistributedNetlist &) = delete;
+    void operator=(const TfheDistributedNetlist &) = delete;
+};
+#endif
+
+#endif //TFHE_DISTRIBUTED_H
@@ -44,6 +44,39 @@ EXPORT void bootsSymEncrypt(LweSample *result, int32_t message, const TFheGateBo
 /** decrypts a boolean */
 EXPORT int32_t bootsSymDecrypt(const LweSample *sample, const TFheGateBootstrappingSecretKeySet *params);
 
+/** encrypts an array of nbelems booleans (uses tfhe_get_nb_threads() threads) */
+EXPORT void bootsSymEncrypt_array(LweSample *result, const int32_t *messages, int32_t nbelems,
+                                  const TFheGateBootstrappingSecretKeySet *params);
+
+/** decrypts an array of nbelems booleans (uses tfhe_get_nb_threads() threads) */
+EXPORT void bootsSymDecrypt_array(int32_t *result, const LweSample *samples, int32_t nbelems,
+                                  const TFheGateBootstrappingSecretKeySet *params);
+
+/** encrypts the nbits lowest bits of message, in little endian order (result[0] is the lsb), nbits <= 64 */
+EXPORT void bootsSymEncryptInt(LweSample *result, uint64_t message, int32_t nbits,
+                               const TFheGateBootstrappingSecretKeySet *params);
+
+/** decrypts a nbits integer encrypted in little endian order (samples[0] is the lsb), nbits <= 64 */
+EXPORT uint64_t bootsSymDecryptInt(const LweSample *samples, int32_t nbits, const TFheGateBootstrappingSecretKeySet *params);
+
+/**
+ * generates the key which packs ciphertexts in one TLwe sample (the identity keyswitch from the lwe key to
+ * the tlwe key): it is given to the server with the cloud key.
+ * The key has (n+1).ks_t TLwe samples, so a small ks_t (e.g. 6 with ks_basebit=4) keeps it reasonable.
+ */
+EXPORT LweToTLweKeySwitchKey *new_gate_bootstrapping_packing_key(const TFheGateBootstrappingSecretKeySet *params,
+                                                                 int32_t ks_t, int32_t ks_basebit);
+
+/**
+ * server side: packs nbelems <= N ciphertexts in one TLwe sample of the tlwe params of the keyset
+ * (uses tfhe_get_nb_threads() threads). The result is (k+1)N Torus32, instead of (n+1) per ciphertext.
+ */
+EXPORT void bootsPack(TLweSample *result, const LweSample *samples, int32_t nbelems, const LweToTLweKeySwitchKey *ks);
+
+/** client side: decrypts the nbelems booleans packed by bootsPack */
+EXPORT void bootsSymDecryptPacked(int32_t *result, const TLweSample *packed, int32_t nbelems,
+                                  const TFheGateBootstrappingSecretKeySet *params);
+
 /** bootstrapped Constant (true or false) trivial Gate */
 EXPORT void bootsCONSTANT(LweSample *result, int32_t value, const TFheGateBootstrappingCloudKeySet *bk);
 
@@ -85,5 +118,20 @@ bootsORYN(LweSample *result, const LweSample *ca, const LweSample *cb, const TFh
 /** bootstrapped Mux(a,b,c) = a?b:c */
 EXPORT void bootsMUX(LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
                      const TFheGateBootstrappingCloudKeySet *bk);
+/** bootstrapped Majority gate: result = (a+b+c >= 2) (one bootstrap) */
+EXPORT void bootsMAJ(LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
+                     const TFheGateBootstrappingCloudKeySet *bk);
+/** bootstrapped Xor3 gate: result = a xor b xor c (one bootstrap) */
+EXPORT void bootsXOR3(LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
+                      const TFheGateBootstrappingCloudKeySet *bk);
+/** bootstrapped And3 gate: result = a and b and c (two bootstraps) */
+EXPORT void bootsAND3(LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
+                      const TFheGateBootstrappingCloudKeySet *bk);
+/** bootstrapped Or3 gate: result = a or b or c (two bootstraps) */
+EXPORT void bootsOR3(LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
+                     const TFheGateBootstrappingCloudKeySet *bk);
+/** bootstrapped full adder: sum = a xor b xor c, carry = maj(a,b,c) (two bootstraps) */
+EXPORT void bootsFULLADDER(LweSample *sum, LweSample *carry, const LweSample *a, const LweSample *b,
+                           const LweSample *c, const TFheGateBootstrappingCloudKeySet *bk);
 
 #endif// TFHE_GATE_BOOTSTRAPPING_FUNCTIONS_H
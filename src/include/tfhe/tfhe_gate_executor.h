@@ -0,0 +1,217 @@
+#ifndef TFHE_GATE_EXECUTOR_H
+#define TFHE_GATE_EXECUTOR_H
+
+///@file
+///@brief This file declares the gate-level DAG executor: a batch of gates over LweSample
+///handles is recorded, then evaluated in parallel in dependency order
+
+#include "tfhe_core.h"
+#include "tfhe_gate_bootstrapping_structures.h"
+
+/** the gates supported by the executor (same semantics as the boots* functions) */
+enum TfheGateType {
+    TFHE_GATE_CONSTANT = 0, ///< result = value (free)
+    TFHE_GATE_COPY,         ///< result = a (free)
+    TFHE_GATE_NOT,          ///< result = not(a) (free)
+    TFHE_GATE_NAND,
+    TFHE_GATE_OR,
+    TFHE_GATE_AND,
+    TFHE_GATE_XOR,
+    TFHE_GATE_XNOR,
+    TFHE_GATE_NOR,
+    TFHE_GATE_ANDNY,        ///< not(a) and b
+    TFHE_GATE_ANDYN,        ///< a and not(b)
+    TFHE_GATE_ORNY,         ///< not(a) or b
+    TFHE_GATE_ORYN,         ///< a or not(b)
+    TFHE_GATE_MUX,          ///< a?b:c
+    TFHE_GATE_MAJ,          ///< (a+b+c >= 2)
+    TFHE_GATE_XOR3,         ///< a xor b xor c
+    TFHE_GATE_NB_TYPES
+};
+#ifndef __cplusplus
+typedef enum TfheGateType TfheGateType;
+#endif
+
+/** number of inputs of a gate type (0 to 3) */
+EXPORT int32_t tfhe_gate_nb_inputs(TfheGateType type);
+
+/** number of bootstraps needed by a gate type (0, 1, or 2 for the mux) */
+EXPORT int32_t tfhe_gate_nb_bootstraps(TfheGateType type);
+
+/** evaluates a gate on plaintext booleans (the unused inputs are ignored) */
+EXPORT int32_t tfhe_gate_eval_plain(TfheGateType type, int32_t a, int32_t b, int32_t c, int32_t value);
+
+/**
+ * evaluates one gate: result = type(a,b,c), or value for the constant gate.
+ * The unused inputs may be NULL.
+ */
+EXPORT void bootsGATE(LweSample *result, TfheGateType type, const LweSample *a, const LweSample *b, const LweSample *c,
+                      int32_t value, const TFheGateBootstrappingCloudKeySet *bk);
+
+/**
+ * evaluates nb_gates independent gates results[i] = types[i](a[i],b[i],c[i]) (or values[i] for the
+ * constant gates), with the stages of the bootstraps pipelined across threads: in each of the nb_lanes
+ * lanes, one thread does the blind rotations of a stream of gates while a second thread keyswitches the
+ * previous ones, so that each thread keeps only one of the two keys in its cache.
+ * The unused input arrays and values may be NULL. nb_lanes = 0 means tfhe_get_nb_threads()/2.
+ */
+EXPORT void bootsGATE_pipelined(LweSample *results, const TfheGateType *types, const LweSample *a,
+                                const LweSample *b, const LweSample *c, const int32_t *values, int32_t nb_gates,
+                                const TFheGateBootstrappingCloudKeySet *bk, int32_t nb_lanes);
+
+struct TfheGateExecutor;
+#ifndef __cplusplus
+typedef struct TfheGateExecutor TfheGateExecutor;
+#endif
+
+/** creates an empty executor for the given cloud key */
+EXPORT TfheGateExecutor *new_TfheGateExecutor(const TFheGateBootstrappingCloudKeySet *bk);
+
+/** deletes an executor (the samples are not deleted) */
+EXPORT void delete_TfheGateExecutor(TfheGateExecutor *executor);
+
+/**
+ * records the gate result = type(a,b,c) (the unused inputs may be NULL), and returns its index.
+ * The dependencies are deduced from the samples: a gate runs after the previous gates
+ * which write its inputs, and after the previous gates which read or write its result.
+ */
+EXPORT int32_t tfhe_executor_add_gate(TfheGateExecutor *executor, TfheGateType type, LweSample *result,
+                                      const LweSample *a, const LweSample *b, const LweSample *c);
+
+/** records the constant gate result = value, and returns its index */
+EXPORT int32_t tfhe_executor_add_constant(TfheGateExecutor *executor, LweSample *result, int32_t value);
+
+/** number of recorded gates */
+EXPORT int32_t tfhe_executor_nb_gates(const TfheGateExecutor *executor);
+
+/**
+ * evaluates all the recorded gates on nb_threads threads (0 means tfhe_get_nb_threads()),
+ * and returns when they are all done. The recorded gates are kept, so the same
+ * batch can be run again (e.g. on new input values).
+ */
+EXPORT void tfhe_executor_run(TfheGateExecutor *executor, int32_t nb_threads);
+
+/** forgets all the recorded gates */
+EXPORT void tfhe_executor_clear(TfheGateExecutor *executor);
+
+/** the order of the ready gates, when there are more ready gates than threads */
+enum TfheSchedulingPolicy {
+    TFHE_SCHEDULE_FIFO = 0,          ///< in the order in which they become ready, also when stealing
+    TFHE_SCHEDULE_CRITICAL_PATH,     ///< the longest remaining path first (the default)
+    TFHE_SCHEDULE_LIFO               ///< the newest gate of the own queue first (its inputs are still in
+                                     ///< cache), and the oldest gate of another queue when stealing
+};
+#ifndef __cplusplus
+typedef enum TfheSchedulingPolicy TfheSchedulingPolicy;
+#endif
+
+EXPORT void tfhe_executor_set_policy(TfheGateExecutor *executor, TfheSchedulingPolicy policy);
+
+/**
+ * length of the longest chain of dependent gates, weighted by their number of bootstraps
+ * (2 for the mux, 0 for the free gates): the makespan of the batch with unlimited threads.
+ */
+EXPORT int32_t tfhe_executor_critical_path(TfheGateExecutor *executor);
+
+#ifdef __cplusplus
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * The temporary samples needed to evaluate one gate, including the ones of its bootstraps.
+ * Each thread owns one, so that the gates do not allocate anything.
+ */
+class TfheGateWorkspace {
+public:
+    LweSample *temp;   ///< linear combination of the inputs (in_out_params)
+    LweSample *u1;     ///< bootstrapped samples before the keyswitch (extracted params)
+    LweSample *u2;
+    LweSample *sum;
+    TfheBootstrapWorkspace *bootstrap;  ///< the buffers of the bootstraps
+
+    explicit TfheGateWorkspace(const TFheGateBootstrappingParameterSet *params);
+    ~TfheGateWorkspace();
+    TfheGateWorkspace(const TfheGateWorkspace &) = delete;
+    void operator=(const TfheGateWorkspace &) = delete;
+};
+
+/**
+ * the bootstraps of a gate which needs some (everything but the keyswitch):
+ * result is a sample of the extracted params
+ */
+void tfhe_execute_gate_woKS(LweSample *result, TfheGateType type, const LweSample *a, const LweSample *b,
+                            const LweSample *c, const TFheGateBootstrappingCloudKeySet *bk, TfheGateWorkspace &ws);
+
+/** same as bootsGATE, using the given workspace */
+void tfhe_execute_gate(LweSample *result, TfheGateType type, const LweSample *a, const LweSample *b,
+                       const LweSample *c, int32_t value, const TFheGateBootstrappingCloudKeySet *bk,
+                       TfheGateWorkspace &ws);
+
+/** the time in seconds on a steady clock (for the gate timings) */
+double tfhe_steady_time();
+
+/** one recorded gate */
+struct TfheGateNode {
+    TfheGateType type;
+    LweSample *result;
+    const LweSample *in[3];
+    int32_t value;                     ///< for the constant gate
+    std::vector<int32_t> successors;   ///< the gates which wait for this one
+    int32_t nb_predecessors;
+    int32_t priority;                  ///< the longest weighted path from the start of this gate to the end
+};
+
+struct TfheGateExecutor {
+    const TFheGateBootstrappingCloudKeySet *const bk;
+    std::vector<TfheGateNode> gates;
+    TfheSchedulingPolicy policy;
+    bool record_times;                ///< if set, run() fills start_times and end_times
+    std::vector<double> start_times;  ///< of each gate, in seconds (steady clock)
+    std::vector<double> end_times;
+
+    TfheGateExecutor(const TFheGateBootstrappingCloudKeySet *bk);
+    ~TfheGateExecutor();
+    TfheGateExecutor(const TfheGateExecutor &) = delete;
+    void operator=(const TfheGateExecutor &) = delete;
+
+    int32_t add_gate(TfheGateType type, LweSample *result, const LweSample *a, const LweSample *b,
+                     const LweSample *c, int32_t value = 0);
+
+    void run(int32_t nb_threads = 0);
+
+    void clear();
+
+    /** computes the priorities of the gates, and returns the critical path */
+    int32_t update_priorities();
+
+private:
+    /** the last gate which wrote a sample, and the gates which read it since */
+    struct SampleState {
+        int32_t last_writer;
+        std::vector<int32_t> readers;
+    };
+    std::map<const LweSample *, SampleState> samples;
+
+    /**
+     * the ready gates of one thread, in the order of the policy: a double-ended queue (fifo, lifo),
+     * or a heap of the priorities (critical path)
+     */
+    struct ReadyQueue {
+        std::mutex lock;
+        std::deque<int32_t> gates;
+    };
+    std::vector<TfheGateWorkspace *> workspaces;
+
+    void add_dependency(int32_t from, int32_t to);
+    bool before(int32_t g1, int32_t g2) const;
+    void push_ready(ReadyQueue &queue, int32_t g);
+    int32_t pop_ready(ReadyQueue &queue, bool steal);
+    void worker(int32_t id, int32_t nb_workers, std::vector<ReadyQueue> &queues,
+                std::vector<std::atomic<int32_t> > &pending, std::atomic<int32_t> &nb_done);
+};
+#endif
+
+#endif //TFHE_GATE_EXECUTOR_H
@@ -28,6 +28,17 @@ const int32_t TLWE_KEY_TYPE_UID = 85;
 const int32_t TGSW_KEY_TYPE_UID = 169;
 const int32_t LWE_KEYSWITCH_KEY_TYPE_UID = 200;
 const int32_t LWE_BOOTSTRAPPING_KEY_TYPE_UID = 201;
+/*
+ * Compact keyswitch key: 1 double (variance), then the n.t.(base-1) entries
+ * (i,j,h) with h>=1, each as n_out Torus32 (a) followed by 1 Torus32 (b).
+ * (the legacy format 200 also contains the trivial entries h=0)
+ */
+const int32_t LWE_KEYSWITCH_KEY_COMPACT_TYPE_UID = 202;
+/*
+ * Lwe to TLwe keyswitch key: 1 double (variance), then the (n+1).t entries (i,j),
+ * each as (k+1)N Torus32 (a then b).
+ */
+const int32_t LWE_TO_TLWE_KEYSWITCH_KEY_TYPE_UID = 203;
 
 /**
  * This is a generic Istream wrapper: supports getLine() and feof()
@@ -0,0 +1,134 @@
+#ifndef TFHE_INTEGER_H
+#define TFHE_INTEGER_H
+
+///@file
+///@brief This file declares the word-level arithmetic: adders, subtractors, comparators, shifters and
+///multipliers on arrays of gate bootstrapping ciphertexts (n bits, lsb first).
+///
+///The operations do not evaluate anything: they record their gates in the gate executor of a circuit,
+///which evaluates the whole batch in parallel when the circuit is run. The circuits are chosen for a
+///small depth (in bootstraps) and use the cheapest gates: the negations are free, the negated inputs
+///are folded in the ANDYN/ORYN/XNOR forms, the carries are majority gates, and the bits
+///which are known to be 0 at record time are propagated instead of being computed.
+
+#include "tfhe_core.h"
+#include "tfhe_gate_executor.h"
+
+/** the carry propagation of the adders */
+enum TfheAdderType {
+    TFHE_ADDER_RIPPLE = 0,  ///< n full adders in a chain: 2n bootstraps, depth n
+    TFHE_ADDER_PREFIX       ///< Sklansky parallel prefix: about 4n+n.log2(n) bootstraps, depth log2(n)+2
+};
+#ifndef __cplusplus
+typedef enum TfheAdderType TfheAdderType;
+#endif
+
+/** the reduction of the partial products of the multipliers */
+enum TfheMultiplierType {
+    TFHE_MULTIPLIER_ARRAY = 0,  ///< the rows are added one after the other with ripple adders: depth about 3n
+    TFHE_MULTIPLIER_DADDA       ///< Dadda tree of full adders, then a prefix adder: depth about log1.5(n)+log2(2n)
+};
+#ifndef __cplusplus
+typedef enum TfheMultiplierType TfheMultiplierType;
+#endif
+
+struct TfheIntegerCircuit;
+#ifndef __cplusplus
+typedef struct TfheIntegerCircuit TfheIntegerCircuit;
+#endif
+
+/** creates an empty circuit for the given cloud key */
+EXPORT TfheIntegerCircuit *new_TfheIntegerCircuit(const TFheGateBootstrappingCloudKeySet *bk);
+
+/** deletes a circuit and its temporary samples (the samples of the operations are not deleted) */
+EXPORT void delete_TfheIntegerCircuit(TfheIntegerCircuit *circuit);
+
+/** the executor of the circuit, in which other gates may be recorded between the operations */
+EXPORT TfheGateExecutor *tfhe_integer_executor(TfheIntegerCircuit *circuit);
+
+/**
+ * evaluates all the recorded operations on nb_threads threads (0 means tfhe_get_nb_threads()).
+ * They are kept, so that the same circuit can be run again on new inputs.
+ */
+EXPORT void tfhe_integer_run(TfheIntegerCircuit *circuit, int32_t nb_threads);
+
+/** forgets all the recorded operations, and deletes their temporary samples */
+EXPORT void tfhe_integer_clear(TfheIntegerCircuit *circuit);
+
+/** number of bootstraps of the recorded operations */
+EXPORT int32_t tfhe_integer_nb_bootstraps(const TfheIntegerCircuit *circuit);
+
+/** depth of the recorded operations, in bootstraps (see tfhe_executor_critical_path) */
+EXPORT int32_t tfhe_integer_depth(TfheIntegerCircuit *circuit);
+
+/*
+ * The operations below record their gates in the circuit. The results are written after all the
+ * inputs are read, so they may overlap the inputs.
+ */
+
+/**
+ * result = (a + b) mod 2^n
+ * @param carry the carry out (may be NULL)
+ */
+EXPORT void tfhe_integer_add(TfheIntegerCircuit *circuit, LweSample *result, LweSample *carry, const LweSample *a,
+                             const LweSample *b, int32_t n, TfheAdderType type);
+
+/**
+ * result = (a - b) mod 2^n
+ * @param borrow the borrow out, i.e. a < b unsigned (may be NULL)
+ */
+EXPORT void tfhe_integer_sub(TfheIntegerCircuit *circuit, LweSample *result, LweSample *borrow, const LweSample *a,
+                             const LweSample *b, int32_t n, TfheAdderType type);
+
+/** result = (a == b) */
+EXPORT void tfhe_integer_equal(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a,
+                               const LweSample *b, int32_t n);
+
+/** result = (a < b), as unsigned integers, or as two's complement integers if is_signed */
+EXPORT void tfhe_integer_less_than(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a,
+                                   const LweSample *b, int32_t n, int32_t is_signed);
+
+/** result = (a <= b), as unsigned integers, or as two's complement integers if is_signed */
+EXPORT void tfhe_integer_less_equal(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a,
+                                    const LweSample *b, int32_t n, int32_t is_signed);
+
+/**
+ * result = (a << shift) mod 2^n, with a barrel shifter
+ * @param shift the nb_shift_bits bits of the shift, lsb first
+ */
+EXPORT void tfhe_integer_shift_left(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a, int32_t n,
+                                    const LweSample *shift, int32_t nb_shift_bits);
+
+/**
+ * result = a >> shift, with a barrel shifter: the msb of a is shifted in if is_signed, else 0
+ * @param shift the nb_shift_bits bits of the shift, lsb first
+ */
+EXPORT void tfhe_integer_shift_right(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a, int32_t n,
+                                     const LweSample *shift, int32_t nb_shift_bits, int32_t is_signed);
+
+/** result = a * b, as unsigned integers: result has 2n bits */
+EXPORT void tfhe_integer_mul(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a, const LweSample *b,
+                             int32_t n, TfheMultiplierType type);
+
+#ifdef __cplusplus
+#include <vector>
+
+struct TfheIntegerCircuit {
+    TfheGateExecutor executor;
+    const LweParams *const params;
+    std::vector<LweSample *> blocks;   ///< the temporary samples, allocated by blocks
+    int32_t nb_used;                   ///< number of used samples of the last block
+
+    TfheIntegerCircuit(const TFheGateBootstrappingCloudKeySet *bk);
+    ~TfheIntegerCircuit();
+    TfheIntegerCircuit(const TfheIntegerCircuit &) = delete;
+    void operator=(const TfheIntegerCircuit &) = delete;
+
+    /** a new temporary sample, which lives until the circuit is cleared */
+    LweSample *new_temp();
+
+    void clear();
+};
+#endif
+
+#endif //TFHE_INTEGER_H
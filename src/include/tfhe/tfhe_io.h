@@ -339,6 +339,36 @@ EXPORT LweKeySwitchKey *new_lweKeySwitchKey_fromStream(std::istream &F);
 
 #endif
 
+/* ****************************
+ * Lwe to TLwe Keyswitch key
+**************************** */
+
+/**
+ * This function exports a lwe to tlwe keyswitch key (in binary) to a file
+ */
+EXPORT void export_lweToTLweKeySwitchKey_toFile(FILE *F, const LweToTLweKeySwitchKey *ks);
+
+/**
+ * This constructor function reads and creates a LweToTLweKeySwitchKey from a File. The result
+ * must be deleted with delete_LweToTLweKeySwitchKey();
+ */
+EXPORT LweToTLweKeySwitchKey *new_lweToTLweKeySwitchKey_fromFile(FILE *F);
+
+#ifdef __cplusplus
+
+/**
+ * This function exports a lwe to tlwe keyswitch key (in binary) to a stream
+ */
+EXPORT void export_lweToTLweKeySwitchKey_toStream(std::ostream &F, const LweToTLweKeySwitchKey *ks);
+
+/**
+ * This constructor function reads and creates a LweToTLweKeySwitchKey from a stream. The result
+ * must be deleted with delete_LweToTLweKeySwitchKey();
+ */
+EXPORT LweToTLweKeySwitchKey *new_lweToTLweKeySwitchKey_fromStream(std::istream &F);
+
+#endif
+
 /* ****************************
  * Lwe Bootstrapping key
 **************************** */
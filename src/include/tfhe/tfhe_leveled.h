@@ -0,0 +1,68 @@
+#ifndef TFHE_LEVELED_H
+#define TFHE_LEVELED_H
+
+///@file
+///@brief This file declares the leveled evaluation of the linear gates: a xor adds its inputs instead of
+///bootstrapping them, and a sample is bootstrapped only when the variance of the sum (current_variance)
+///would exceed the bound of the parameters. A chain of xors (parity, CRC, linear layers) then costs one
+///bootstrapping every few additions, instead of one per gate.
+///
+///The leveled samples encode a bit b as b/2, so that the xor is the addition and the not adds 1/2. Their
+///margin is 1/4, twice the margin of the gate bootstrapping ciphertexts (+-1/8), so their variance is
+///bounded by (2.alpha_max)^2, minus the rounding variance of the bootstrapping.
+
+#include "tfhe_core.h"
+#include "tfhe_gate_bootstrapping_structures.h"
+
+/**
+ * estimated variance of the output of a gate bootstrapping: the n external products of the blind
+ * rotation (noise of the bootstrapping key and precision of the decomposition), then the keyswitch
+ * (noise of the keyswitch key and precision of its decomposition)
+ */
+EXPORT double bootsBootstrapVariance(const TFheGateBootstrappingParameterSet *params);
+
+/** variance of the rounding of the input of a bootstrapping to the multiples of 1/2N */
+EXPORT double bootsRoundingVariance(const TFheGateBootstrappingParameterSet *params);
+
+/** the largest variance of a leveled sample which can be bootstrapped */
+EXPORT double bootsLeveledMaxVariance(const TFheGateBootstrappingParameterSet *params);
+
+/** encrypts a boolean as a leveled sample */
+EXPORT void bootsLeveledSymEncrypt(LweSample *result, int32_t message, const TFheGateBootstrappingSecretKeySet *key);
+
+/** decrypts a leveled sample */
+EXPORT int32_t bootsLeveledSymDecrypt(const LweSample *sample, const TFheGateBootstrappingSecretKeySet *key);
+
+/**
+ * result = the leveled sample of a gate bootstrapping ciphertext (2x+1/4, without bootstrapping).
+ * The gates do not track the noise of their blind rotation, so the variance of x is at least the
+ * variance of a bootstrapping.
+ */
+EXPORT void bootsLeveledFromGate(LweSample *result, const LweSample *x, const TFheGateBootstrappingCloudKeySet *bk);
+
+/** result = the gate bootstrapping ciphertext of a leveled sample (one bootstrapping) */
+EXPORT void bootsLeveledToGate(LweSample *result, const LweSample *x, const TFheGateBootstrappingCloudKeySet *bk);
+
+/** result = x, bootstrapped: its variance is bootsBootstrapVariance */
+EXPORT void bootsLeveledRefresh(LweSample *result, const LweSample *x, const TFheGateBootstrappingCloudKeySet *bk);
+
+/** result = not(x) (free) */
+EXPORT void bootsLeveledNOT(LweSample *result, const LweSample *x, const TFheGateBootstrappingCloudKeySet *bk);
+
+/**
+ * result = a xor b: a and b are added, after the noisiest of them is bootstrapped if the variance of
+ * the sum would exceed bootsLeveledMaxVariance (and the other one if it is still exceeded).
+ * Returns the number of bootstrappings (0 to 2).
+ */
+EXPORT int32_t bootsLeveledXOR(LweSample *result, const LweSample *a, const LweSample *b,
+                               const TFheGateBootstrappingCloudKeySet *bk);
+
+/**
+ * result = xor of the nb_samples samples (nb_samples >= 1): they are added in order, and the sum is
+ * bootstrapped when the next addition would exceed bootsLeveledMaxVariance.
+ * Returns the number of bootstrappings.
+ */
+EXPORT int32_t bootsLeveledParity(LweSample *result, const LweSample *samples, int32_t nb_samples,
+                                  const TFheGateBootstrappingCloudKeySet *bk);
+
+#endif //TFHE_LEVELED_H
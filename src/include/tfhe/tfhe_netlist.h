@@ -0,0 +1,148 @@
+#ifndef TFHE_NETLIST_H
+#define TFHE_NETLIST_H
+
+///@file
+///@brief This file declares the netlist evaluator: a boolean circuit read from a BLIF or
+///a Yosys JSON file is evaluated on ciphertexts, level by level, in parallel
+
+#include "tfhe_core.h"
+#include "tfhe_gate_executor.h"
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <iosfwd>
+#else
+#include <stdio.h>
+#endif
+
+struct TfheNetlist;
+#ifndef __cplusplus
+typedef struct TfheNetlist TfheNetlist;
+#endif
+
+/**
+ * reads a netlist in the BLIF format: .inputs, .outputs, .names (any cover), .latch, .conn,
+ * and the Yosys internal cells ($_AND_, $_MUX_, $_DFF_P_...) in .subckt or .gate lines.
+ * Only the first model is read. Returns NULL (and prints the reason on stderr) on error.
+ * The result must be deleted with delete_TfheNetlist().
+ */
+EXPORT TfheNetlist *new_TfheNetlist_fromBlifFile(FILE *F);
+
+/**
+ * reads a netlist written by the write_json command of Yosys, after techmapping to the
+ * internal cells ($_AND_, $_MUX_, $_DFF_P_...). If there are several modules, the one
+ * with the top attribute is read. Returns NULL (and prints the reason on stderr) on error.
+ */
+EXPORT TfheNetlist *new_TfheNetlist_fromYosysJsonFile(FILE *F);
+
+/** reads a netlist file: .json files are read as Yosys JSON, the others as BLIF */
+EXPORT TfheNetlist *new_TfheNetlist_fromFileName(const char *filename);
+
+EXPORT void delete_TfheNetlist(TfheNetlist *netlist);
+
+/**
+ * simplifies the netlist before its evaluation: folds the constants, absorbs the inverters and copies
+ * into the gates which read them (e.g. and(not(a),b) becomes andny(a,b)), and removes the gates which
+ * do not compute an output or a register. The inputs, outputs and registers are unchanged.
+ * @return the number of bootstraps saved per evaluation
+ */
+EXPORT int32_t tfhe_netlist_optimize(TfheNetlist *netlist);
+
+/** number of input bits (the bits of a multi-bit port are consecutive, lsb first) */
+EXPORT int32_t tfhe_netlist_nb_inputs(const TfheNetlist *netlist);
+/** number of output bits */
+EXPORT int32_t tfhe_netlist_nb_outputs(const TfheNetlist *netlist);
+/** number of registers (latches or flip-flops) */
+EXPORT int32_t tfhe_netlist_nb_registers(const TfheNetlist *netlist);
+/** number of gates, including the free ones (constant, copy, not) */
+EXPORT int32_t tfhe_netlist_nb_gates(const TfheNetlist *netlist);
+/** number of bootstraps needed by one evaluation */
+EXPORT int32_t tfhe_netlist_nb_bootstraps(const TfheNetlist *netlist);
+/** number of levels (bootstrapping depth) */
+EXPORT int32_t tfhe_netlist_nb_levels(const TfheNetlist *netlist);
+
+/** name of an input bit, e.g. "a[3]" */
+EXPORT const char *tfhe_netlist_input_name(const TfheNetlist *netlist, int32_t i);
+/** name of an output bit */
+EXPORT const char *tfhe_netlist_output_name(const TfheNetlist *netlist, int32_t i);
+/** initial value (0 or 1) of a register */
+EXPORT int32_t tfhe_netlist_register_init(const TfheNetlist *netlist, int32_t i);
+
+/**
+ * evaluates the netlist on ciphertexts (one clock cycle for a sequential netlist).
+ * The gates of a level are evaluated in parallel on nb_threads threads (0 means tfhe_get_nb_threads()).
+ * @param outputs the nb_outputs output bits
+ * @param inputs the nb_inputs input bits
+ * @param state the nb_registers register bits, replaced by their next values (NULL if there are no registers)
+ */
+EXPORT void tfhe_netlist_eval(const TfheNetlist *netlist, LweSample *outputs, const LweSample *inputs,
+                              LweSample *state, const TFheGateBootstrappingCloudKeySet *bk, int32_t nb_threads);
+
+/** same as tfhe_netlist_eval, on plaintext bits */
+EXPORT void tfhe_netlist_eval_plain(const TfheNetlist *netlist, int32_t *outputs, const int32_t *inputs,
+                                    int32_t *state);
+
+#ifdef __cplusplus
+#include <string>
+#include <vector>
+
+/** one gate of a netlist: wire out = type(wire in[0], in[1], in[2]) */
+struct TfheNetlistGate {
+    TfheGateType type;
+    int32_t out;
+    int32_t in[3];   ///< -1 when unused
+    int32_t value;   ///< for the constant gate
+};
+
+/** a register: q is the current value (read by the gates), d the next one */
+struct TfheNetlistRegister {
+    int32_t d;
+    int32_t q;
+    int32_t init;
+};
+
+/**
+ * The gates of one level: the bootstrapped gates [begin,free_begin[ only read wires of the previous
+ * levels, so they are independent. Then the free gates [free_begin,end[ run in order.
+ */
+struct TfheNetlistLevel {
+    int32_t begin;
+    int32_t free_begin;
+    int32_t end;
+};
+
+struct TfheNetlist {
+    int32_t nb_wires;
+    std::vector<std::string> input_names;
+    std::vector<std::string> output_names;
+    std::vector<int32_t> inputs;    ///< the wire of each input bit
+    std::vector<int32_t> outputs;   ///< the wire of each output bit
+    std::vector<TfheNetlistRegister> registers;
+    std::vector<TfheNetlistGate> gates;    ///< sorted by level
+    std::vector<TfheNetlistLevel> levels;
+
+    TfheNetlist();
+
+    /**
+     * sorts the gates by level, and fills the levels.
+     * @return false if the netlist has a combinational loop or a wire without a driver
+     */
+    bool levelize(std::string &error);
+};
+
+/**
+ * evaluates the gates of one level on the wires (an array of nb_wires samples).
+ * The bootstrapped gates run in parallel, on one thread per workspace.
+ */
+void tfhe_netlist_eval_level(const TfheNetlist *netlist, int32_t level, LweSample *wires,
+                             const TFheGateBootstrappingCloudKeySet *bk,
+                             const std::vector<TfheGateWorkspace *> &workspaces);
+
+/** reads a BLIF netlist from a stream (see new_TfheNetlist_fromBlifFile) */
+EXPORT TfheNetlist *new_TfheNetlist_fromBlifStream(std::istream &in);
+
+/** reads a Yosys JSON netlist from a stream (see new_TfheNetlist_fromYosysJsonFile) */
+EXPORT TfheNetlist *new_TfheNetlist_fromYosysJsonStream(std::istream &in);
+#endif
+
+#endif //TFHE_NETLIST_H
@@ -0,0 +1,75 @@
+#ifndef TFHE_NUMA_H
+#define TFHE_NUMA_H
+
+///@file
+///@brief This file declares the NUMA support: the topology (read from sysfs on Linux), the
+///binding of the threads to the nodes, and the per-node replicas of the cloud keys
+
+#include "tfhe_core.h"
+
+/** number of NUMA nodes (1 if the topology is unknown) */
+EXPORT int32_t tfhe_numa_nb_nodes();
+
+/** node of a cpu (0 if unknown) */
+EXPORT int32_t tfhe_numa_node_of_cpu(int32_t cpu);
+
+/** node of the cpu which runs the calling thread */
+EXPORT int32_t tfhe_numa_current_node();
+
+/** the node of the worker index among nb_workers: the workers are spread evenly over the nodes */
+EXPORT int32_t tfhe_numa_node_of_worker(int32_t index, int32_t nb_workers);
+
+/**
+ * binds the calling thread to the cpus of a node.
+ * @return 1 on success, 0 if the binding is not supported
+ */
+EXPORT int32_t tfhe_numa_bind_thread(int32_t node);
+
+/**
+ * enables (1) or disables (0, the default) the replication of the cloud keys: each node gets its
+ * own copy of the bootstrapping and keyswitch keys, and the evaluators (gate executor, netlists,
+ * asynchronous engine, pipelined gates) bind their threads to the nodes and use the local copy.
+ * The workers of the thread team of the library (tfhe_parallel_for) are bound once, at their first
+ * loop after the replication is enabled, and stay bound.
+ */
+EXPORT void tfhe_set_numa_replication(int32_t enabled);
+
+EXPORT int32_t tfhe_get_numa_replication();
+
+/**
+ * the replica of a cloud key for a node. It is created on first use by a thread bound to the node,
+ * so that its memory is local to the node. Without replication, returns bk.
+ */
+EXPORT const TFheGateBootstrappingCloudKeySet *tfhe_numa_cloud_key(const TFheGateBootstrappingCloudKeySet *bk,
+                                                                   int32_t node);
+
+/** the replica of a cloud key for the node of the calling thread (bk without replication) */
+EXPORT const TFheGateBootstrappingCloudKeySet *tfhe_numa_local_cloud_key(const TFheGateBootstrappingCloudKeySet *bk);
+
+/** the node of the replica last returned to the calling thread by tfhe_numa_local_cloud_key (-1 for none) */
+EXPORT int32_t tfhe_numa_thread_replica();
+
+/** deletes the replicas of a cloud key (called by delete_gate_bootstrapping_cloud_keyset) */
+EXPORT void tfhe_numa_release_replicas(const TFheGateBootstrappingCloudKeySet *bk);
+
+#ifdef __cplusplus
+#include <vector>
+
+/**
+ * Binds the calling thread to the node of a worker while it exists, if the replication of the keys
+ * is enabled, and restores the previous affinity when it is destroyed.
+ */
+class TfheNumaBinding {
+public:
+    TfheNumaBinding(int32_t index, int32_t nb_workers);
+    ~TfheNumaBinding();
+    TfheNumaBinding(const TfheNumaBinding &) = delete;
+    void operator=(const TfheNumaBinding &) = delete;
+
+private:
+    bool bound;
+    std::vector<int32_t> saved_cpus;
+};
+#endif
+
+#endif //TFHE_NUMA_H
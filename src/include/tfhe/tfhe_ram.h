@@ -0,0 +1,99 @@
+#ifndef TFHE_RAM_H
+#define TFHE_RAM_H
+
+///@file
+///@brief This file declares the encrypted RAM: 2^m words of word_size bits, read and written at encrypted
+///addresses. Each word is a TLwe sample whose coefficient b is its bit b (+-1/8).
+///
+///A read selects the word with a CMux tree over the address bits, and extracts its bits. A write updates
+///every cell: cell a becomes (address == a) ? word : cell, with one CMux per address bit, and the cells
+///are updated in parallel. Each write adds the error of m external products to every cell, so the cells
+///are refreshed periodically: each bit is bootstrapped and keyswitched back to the cell (the identity
+///keyswitch of the circuit bootstrapping key).
+
+#include "tfhe_core.h"
+#include "tfhe_circuit_bootstrapping.h"
+
+struct TfheRam;
+#ifndef __cplusplus
+typedef struct TfheRam TfheRam;
+#endif
+
+/**
+ * creates a RAM of 2^m words of word_size bits (word_size <= N), all set to 0 (trivial samples)
+ * @param cbk the circuit bootstrapping key, which gives the params of the address bits, the bootstrapping
+ *        and the keyswitches (it must outlive the RAM)
+ * @param nb_threads the threads which update the cells (0 means tfhe_get_nb_threads())
+ * @param refresh_period the cells are refreshed after this number of writes (0 means never)
+ */
+EXPORT TfheRam *new_TfheRam(int32_t m, int32_t word_size, const TfheCircuitBootstrappingKey *cbk,
+                            int32_t nb_threads, int32_t refresh_period);
+
+EXPORT void delete_TfheRam(TfheRam *ram);
+
+/**
+ * result = the word_size bits of the word at the address sum(address[i].2^i) for 0<=i<m,
+ * as gate bootstrapping ciphertexts
+ * @param address the m bits of the address, lsb first, as TGsw samples (e.g. circuit bootstrapped)
+ */
+EXPORT void tfhe_ram_read(LweSample *result, TfheRam *ram, const TGswSampleFFT *address);
+
+/**
+ * writes a word at the address sum(address[i].2^i) for 0<=i<m
+ * @param word the word, packed as the cells: its coefficient b is its bit b (+-1/8)
+ */
+EXPORT void tfhe_ram_write(TfheRam *ram, const TGswSampleFFT *address, const TLweSample *word);
+
+/** same as tfhe_ram_read, with the address bits given as gate bootstrapping ciphertexts */
+EXPORT void tfhe_ram_read_bits(LweSample *result, TfheRam *ram, const LweSample *address);
+
+/** same as tfhe_ram_write, with the address and the word_size bits of the word as gate bootstrapping ciphertexts */
+EXPORT void tfhe_ram_write_bits(TfheRam *ram, const LweSample *address, const LweSample *word);
+
+/** bootstraps every bit of every cell, which resets the error of the cells */
+EXPORT void tfhe_ram_refresh(TfheRam *ram);
+
+#ifdef __cplusplus
+#include <vector>
+#include "tfhe_cmux.h"
+
+/** the temporary samples of one thread of the RAM */
+class TfheRamWorkspace {
+public:
+    TfheCMuxWorkspace cmux;
+    TLweSample *cell;       ///< the new value of a cell
+    TLweSample *bit;        ///< one bit, as the constant coefficient of a TLwe sample
+    TorusPolynomial *temp;  ///< a rotated polynomial of bit
+    LweSample *extracted;   ///< one bit of a cell (extracted params)
+    LweSample *small;       ///< one bit of a cell, keyswitched (in_out params)
+
+    explicit TfheRamWorkspace(const TfheCircuitBootstrappingKey *cbk);
+    ~TfheRamWorkspace();
+    TfheRamWorkspace(const TfheRamWorkspace &) = delete;
+    void operator=(const TfheRamWorkspace &) = delete;
+};
+
+struct TfheRam {
+    const TfheCircuitBootstrappingKey *const cbk;
+    const int32_t m;                ///< number of address bits
+    const int32_t word_size;        ///< number of bits of a word
+    const int32_t nb_threads;
+    const int32_t refresh_period;   ///< number of writes between two refreshes (0 means never)
+    int32_t nb_writes;              ///< number of writes since the last refresh
+    TLweSample *cells;              ///< the 2^m words
+    TfheCMuxTree *tree;             ///< the CMux tree of the reads
+    std::vector<TfheRamWorkspace *> workspaces;   ///< one per thread
+    TLweSample *word;               ///< the packed word of tfhe_ram_write_bits
+    LweSample *extracted;           ///< the word_size bits of a read, before the keyswitch
+    Torus32 *reversed;              ///< the 2N coefficients of the reversed mask of the extraction
+    TGswSampleFFT *address;         ///< the m circuit bootstrapped address bits of the *_bits functions
+
+    TfheRam(int32_t m, int32_t word_size, const TfheCircuitBootstrappingKey *cbk, int32_t nb_threads,
+            int32_t refresh_period);
+    ~TfheRam();
+    TfheRam(const TfheRam &) = delete;
+    void operator=(const TfheRam &) = delete;
+};
+#endif
+
+#endif //TFHE_RAM_H
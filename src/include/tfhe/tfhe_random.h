@@ -0,0 +1,85 @@
+#ifndef TFHE_RANDOM_H
+#define TFHE_RANDOM_H
+
+///@file
+///@brief This file declares the cryptographic random generator of the library
+
+#ifndef __cplusplus
+#error This file should only be included in a C++ file, for internal use only
+#endif
+
+#include <random>
+#include <stdint.h>
+
+/**
+ * ChaCha20-based random generator (256-bit key, 64-bit block counter).
+ * It satisfies the UniformRandomBitGenerator requirements, so it can be used
+ * with the std distributions, and also provides bulk generation of uniform words
+ * and of standard normal values (Box-Muller, computed in batches).
+ * It is not thread-safe: each thread owns its generator (see numeric_functions.h).
+ */
+class TfheRandomEngine {
+public:
+    typedef uint32_t result_type;
+
+    static const int32_t KEY_WORDS = 8;     ///< number of 32-bit words of the key
+    static const int32_t LANES = 8;         ///< number of blocks computed at once
+    static const int32_t BUFFER_WORDS = 16 * LANES;
+    static const int32_t NORMAL_BUFFER = 128;
+
+private:
+    uint32_t key[KEY_WORDS];
+    uint64_t counter;
+    uint32_t buffer[BUFFER_WORDS];
+    int32_t buffer_pos;
+    double normals[NORMAL_BUFFER];
+    int32_t normal_pos;
+
+    /** computes the next LANES blocks of keystream into out */
+    void generate_blocks(uint32_t *out);
+
+public:
+    /** the generator is seeded from std::random_device */
+    TfheRandomEngine();
+
+    /** the generator is seeded with the given seed sequence */
+    explicit TfheRandomEngine(std::seed_seq &seeds);
+
+    /** resets the generator with the given seed sequence */
+    void seed(std::seed_seq &seeds);
+
+    /** resets the generator with the given 256-bit key */
+    void seed_key(const uint32_t *new_key);
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    result_type operator()() {
+        if (buffer_pos == BUFFER_WORDS) {
+            generate_blocks(buffer);
+            buffer_pos = 0;
+        }
+        return buffer[buffer_pos++];
+    }
+
+    /** skips the next nb_words outputs */
+    void discard(uint64_t nb_words);
+
+    /** fills out with the next size outputs of the generator */
+    void fill(uint32_t *out, int32_t size);
+
+    /** returns a standard normal value (mean 0, stdev 1) */
+    double standard_normal() {
+        if (normal_pos == NORMAL_BUFFER) {
+            fill_standard_normal(normals, NORMAL_BUFFER);
+            normal_pos = 0;
+        }
+        return normals[normal_pos++];
+    }
+
+    /** fills out with size independent standard normal values */
+    void fill_standard_normal(double *out, int32_t size);
+};
+
+#endif //TFHE_RANDOM_H
@@ -0,0 +1,69 @@
+#ifndef TFHE_ROM_H
+#define TFHE_ROM_H
+
+///@file
+///@brief This file declares the encrypted ROM: a public table of 2^m words is read at an encrypted
+///address with m external products, instead of a tree of bootsMUX gates.
+///
+///The table is packed vertically in the plaintexts of TLwe samples: the coefficient w.word_size+b of a
+///polynomial is the bit b of its w-th word (+-1/8). The nu low bits of the address blindly rotate the
+///polynomial selected by a CMux tree over the m-nu high bits, so that the word lands on the coefficients
+///0..word_size-1, which are extracted and keyswitched to gate bootstrapping ciphertexts.
+
+#include "tfhe_core.h"
+#include "tfhe_circuit_bootstrapping.h"
+
+struct TfheRom;
+#ifndef __cplusplus
+typedef struct TfheRom TfheRom;
+#endif
+
+/**
+ * creates a ROM of 2^m words of word_size bits (word_size <= 32 and word_size <= N)
+ * @param table the 2^m words: bit b of table[x] is the bit b of the word at address x
+ * @param cbk the circuit bootstrapping key, which gives the params of the address bits and the keyswitch
+ *        of the result (it must outlive the ROM)
+ * @param nb_threads the threads of the CMux tree and of the keyswitches (0 means tfhe_get_nb_threads())
+ */
+EXPORT TfheRom *new_TfheRom(const uint32_t *table, int32_t m, int32_t word_size,
+                            const TfheCircuitBootstrappingKey *cbk, int32_t nb_threads);
+
+EXPORT void delete_TfheRom(TfheRom *rom);
+
+/**
+ * result = the word_size bits of the word at the address sum(address[i].2^i) for 0<=i<m,
+ * as gate bootstrapping ciphertexts
+ * @param address the m bits of the address, lsb first, as TGsw samples (e.g. circuit bootstrapped)
+ */
+EXPORT void tfhe_rom_read(LweSample *result, TfheRom *rom, const TGswSampleFFT *address);
+
+/** same as tfhe_rom_read, with the address bits given as gate bootstrapping ciphertexts */
+EXPORT void tfhe_rom_read_bits(LweSample *result, TfheRom *rom, const LweSample *address);
+
+#ifdef __cplusplus
+#include "tfhe_cmux.h"
+
+struct TfheRom {
+    const TfheCircuitBootstrappingKey *const cbk;
+    const int32_t m;            ///< number of address bits
+    const int32_t word_size;    ///< number of bits of a word
+    const int32_t nu;           ///< number of low address bits, which select the word in a polynomial
+    const int32_t nb_threads;
+    TLweSample *packed;         ///< the 2^(m-nu) polynomials of the table (noiseless trivial samples)
+    TfheCMuxTree *tree;         ///< the CMux tree over the m-nu high address bits
+    TGswFFTWorkspace *extprod;  ///< the external products of the blind rotation
+    TLweSample *acc;            ///< the selected polynomial, then rotated
+    TLweSample *rotated;        ///< (X^-a - 1).acc
+    LweSample *extracted;       ///< the word_size extracted bits, before the keyswitch
+    Torus32 *reversed;          ///< the 2N coefficients of the reversed mask of the extraction
+    TGswSampleFFT *address;     ///< the m circuit bootstrapped address bits of tfhe_rom_read_bits
+
+    TfheRom(const uint32_t *table, int32_t m, int32_t word_size, const TfheCircuitBootstrappingKey *cbk,
+            int32_t nb_threads);
+    ~TfheRom();
+    TfheRom(const TfheRom &) = delete;
+    void operator=(const TfheRom &) = delete;
+};
+#endif
+
+#endif //TFHE_ROM_H
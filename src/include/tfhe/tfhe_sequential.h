@@ -0,0 +1,97 @@
+#ifndef TFHE_SEQUENTIAL_H
+#define TFHE_SEQUENTIAL_H
+
+///@file
+///@brief This file declares the sequential engine: a sequential netlist is evaluated for many clock
+///cycles, with its registers kept in resident ciphertexts. The cycles are unrolled by windows into a
+///gate executor, so that the gates of a cycle start as soon as their inputs of the previous cycle are
+///ready, instead of waiting for the end of the whole previous cycle.
+
+#include "tfhe_core.h"
+#include "tfhe_netlist.h"
+
+struct TfheSequentialEngine;
+#ifndef __cplusplus
+typedef struct TfheSequentialEngine TfheSequentialEngine;
+#endif
+
+/** the timing of one clock cycle, in seconds since the creation of the engine */
+struct TfheCycleStats {
+    double start;   ///< start of the first gate of the cycle
+    double end;     ///< end of the last gate of the cycle
+};
+#ifndef __cplusplus
+typedef struct TfheCycleStats TfheCycleStats;
+#endif
+
+/**
+ * creates an engine for a netlist, with the registers set to their initial values.
+ * The netlist must outlive the engine.
+ * @param nb_threads the threads which evaluate the gates (0 means tfhe_get_nb_threads())
+ * @param window the number of consecutive cycles unrolled together (0 means 2); the cycles of a window
+ *        overlap, and the windows run one after the other
+ */
+EXPORT TfheSequentialEngine *new_TfheSequentialEngine(const TfheNetlist *netlist,
+                                                      const TFheGateBootstrappingCloudKeySet *bk,
+                                                      int32_t nb_threads, int32_t window);
+
+EXPORT void delete_TfheSequentialEngine(TfheSequentialEngine *engine);
+
+/**
+ * the nb_registers ciphertexts of the registers, between two runs: they may be read, or
+ * overwritten (e.g. with an encrypted initial state)
+ */
+EXPORT LweSample *tfhe_sequential_state(TfheSequentialEngine *engine);
+
+/** sets the registers to their initial values (trivial ciphertexts) */
+EXPORT void tfhe_sequential_reset(TfheSequentialEngine *engine);
+
+/**
+ * evaluates nb_cycles clock cycles.
+ * @param outputs the nb_outputs output bits of each cycle (nb_cycles*nb_outputs samples, by cycle)
+ * @param inputs the nb_inputs input bits of each cycle (nb_cycles*nb_inputs samples, by cycle)
+ */
+EXPORT void tfhe_sequential_run(TfheSequentialEngine *engine, LweSample *outputs, const LweSample *inputs,
+                                int32_t nb_cycles);
+
+/** number of cycles evaluated since the creation of the engine */
+EXPORT int32_t tfhe_sequential_nb_cycles(const TfheSequentialEngine *engine);
+
+/** the timing of a cycle (0 <= cycle < tfhe_sequential_nb_cycles) */
+EXPORT TfheCycleStats tfhe_sequential_cycle_stats(const TfheSequentialEngine *engine, int32_t cycle);
+
+#ifdef __cplusplus
+#include <vector>
+
+struct TfheSequentialEngine {
+    const TfheNetlist *const netlist;
+    const TFheGateBootstrappingCloudKeySet *const bk;
+    const int32_t nb_threads;
+    const int32_t window;
+    const double creation_time;
+    LweSample *state;
+    LweSample *next_state;      ///< the registers at the end of a window, before they are copied to state
+    std::vector<LweSample *> wires;    ///< the wires of each cycle of a window
+    LweSample *outputs;                ///< the outputs of each cycle of a window
+    std::vector<TfheGateExecutor *> executors;         ///< by number of cycles (NULL until needed)
+    std::vector<std::vector<int32_t> > cycle_of_gate;  ///< by number of cycles: the cycle of each gate
+    std::vector<TfheCycleStats> stats;
+    std::vector<int32_t> register_of_wire;             ///< the register of each q wire, else -1
+
+    TfheSequentialEngine(const TfheNetlist *netlist, const TFheGateBootstrappingCloudKeySet *bk,
+                         int32_t nb_threads, int32_t window);
+    ~TfheSequentialEngine();
+    TfheSequentialEngine(const TfheSequentialEngine &) = delete;
+    void operator=(const TfheSequentialEngine &) = delete;
+
+    void run(LweSample *outputs, const LweSample *inputs, int32_t nb_cycles);
+
+private:
+    /** the sample which holds a wire during a cycle of the window */
+    LweSample *sample(int32_t cycle, int32_t wire);
+    /** unrolls nb_cycles cycles (once per number of cycles) */
+    TfheGateExecutor *executor(int32_t nb_cycles);
+};
+#endif
+
+#endif //TFHE_SEQUENTIAL_H
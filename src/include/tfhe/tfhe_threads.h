@@ -0,0 +1,149 @@
+#ifndef TFHE_THREADS_H
+#define TFHE_THREADS_H
+
+///@file
+///@brief This file declares the multi-threading settings and helpers of the library
+
+#include "tfhe_core.h"
+
+/**
+ * sets the number of threads used by the multi-threaded functions of the library
+ * (key generation, key conversion...). 0 means one thread per hardware core.
+ */
+EXPORT void tfhe_set_nb_threads(int32_t nb_threads);
+
+/** returns the number of threads used by the multi-threaded functions of the library */
+EXPORT int32_t tfhe_get_nb_threads();
+
+/**
+ * sets the number of threads used inside one gate (latency mode): the keyswitch
+ * of each gate is split across them. 1 (the default) keeps the gates sequential,
+ * which is best when many gates are evaluated in parallel. 0 means tfhe_get_nb_threads().
+ */
+EXPORT void tfhe_set_nb_gate_threads(int32_t nb_threads);
+
+/** returns the number of threads used inside one gate */
+EXPORT int32_t tfhe_get_nb_gate_threads();
+
+#ifdef __cplusplus
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A team of persistent worker threads, woken up for each parallel loop.
+ * Between two loops, the workers spin for a short while before sleeping,
+ * so that back-to-back loops (e.g. the keyswitch of successive gates) do not
+ * pay for the thread creation nor for the wake-up.
+ * The team grows on demand up to the largest number of threads requested.
+ * Only one loop runs at a time: a loop started while the team is busy (or from
+ * inside a task) runs sequentially in the calling thread.
+ */
+class TfheThreadTeam {
+public:
+    TfheThreadTeam();
+    ~TfheThreadTeam();
+    TfheThreadTeam(const TfheThreadTeam &) = delete;
+    void operator=(const TfheThreadTeam &) = delete;
+
+    /**
+     * calls task(i) for all i in [0,nb_tasks[, on nb_threads threads (including the calling one).
+     * The tasks are dispatched dynamically, so their execution order is unspecified.
+     * @param nb_threads the number of threads (0 means tfhe_get_nb_threads())
+     */
+    void run(int32_t nb_tasks, const std::function<void(int32_t)> &task, int32_t nb_threads = 0);
+
+private:
+    static const int32_t SPIN_ITERATIONS = 2000;
+
+    std::vector<std::thread> workers;
+    std::mutex run_mutex;          ///< held during a loop
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable done_cv;
+    std::atomic<uint64_t> generation; ///< incremented at each loop
+    std::atomic<int32_t> next_task;
+    std::atomic<int32_t> nb_running;  ///< workers which did not finish the current loop
+    const std::function<void(int32_t)> *task;
+    int32_t nb_tasks;
+    int32_t nb_active;             ///< the workers 1..nb_active-1 take part in the current loop
+    bool stopping;
+
+    void grow(int32_t nb_workers);
+    void worker_loop(int32_t index, uint64_t seen);
+    void work();
+};
+
+/** the thread team used by the library */
+TfheThreadTeam &tfhe_thread_team();
+
+/**
+ * calls task(i) for all i in [0,nb_tasks[, on nb_threads threads (including the calling one),
+ * using the thread team of the library.
+ * The tasks are dispatched dynamically, so their execution order is unspecified.
+ * @param nb_tasks the number of tasks
+ * @param task the function to call on each task index
+ * @param nb_threads the number of threads (0 means tfhe_get_nb_threads())
+ */
+void tfhe_parallel_for(int32_t nb_tasks, const std::function<void(int32_t)> &task, int32_t nb_threads = 0);
+
+/**
+ * A bounded lock-free queue between one producer thread and one consumer thread.
+ * The blocking push and pop spin for a short while, then poll with short sleeps.
+ */
+template<typename T>
+class TfheSpscQueue {
+public:
+    explicit TfheSpscQueue(int32_t capacity) : slots(capacity + 1), head(0), tail(0) {}
+    TfheSpscQueue(const TfheSpscQueue &) = delete;
+    void operator=(const TfheSpscQueue &) = delete;
+
+    /** producer side: returns false if the queue is full */
+    bool try_push(const T &value) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        const size_t next = (t + 1 == slots.size()) ? 0 : t + 1;
+        if (next == head.load(std::memory_order_acquire)) return false;
+        slots[t] = value;
+        tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /** consumer side: returns false if the queue is empty */
+    bool try_pop(T &value) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        value = slots[h];
+        head.store((h + 1 == slots.size()) ? 0 : h + 1, std::memory_order_release);
+        return true;
+    }
+
+    void push(const T &value) {
+        for (int32_t s = 0; !try_push(value); s++) wait(s);
+    }
+
+    T pop() {
+        T value;
+        for (int32_t s = 0; !try_pop(value); s++) wait(s);
+        return value;
+    }
+
+private:
+    static const int32_t SPIN_ITERATIONS = 1000;
+
+    std::vector<T> slots;
+    std::atomic<size_t> head;   ///< next slot to pop
+    char padding[64];           ///< keeps head and tail in different cache lines
+    std::atomic<size_t> tail;   ///< next slot to push
+
+    static void wait(int32_t iteration) {
+        if (iteration < SPIN_ITERATIONS) std::this_thread::yield();
+        else std::this_thread::sleep_for(std::chrono::microseconds(20));
+    }
+};
+#endif
+
+#endif //TFHE_THREADS_H
@@ -88,6 +88,55 @@ EXPORT void tfhe_bootstrap_FFT(LweSample *result, const LweBootstrappingKeyFFT *
 // EXPORT void tfhe_bootstrapFFT(LweSample* result, const LweBootstrappingKeyFFT* bk, Torus32 mu1, Torus32 mu0, const LweSample* x);
 // EXPORT void tfhe_createLweBootstrappingKeyFFT(LweBootstrappingKeyFFT* bk, const LweKey* key_in, const TGswKey* rgsw_key);
 
+#ifdef __cplusplus
+/**
+ * The temporary polynomials of an external product. Each thread owns one,
+ * so that the external products do not allocate anything.
+ */
+struct TGswFFTWorkspace {
+    const TGswParams *params;
+    IntPolynomial *deca;                ///< decomposed accumulator (kpl polynomials)
+    LagrangeHalfCPolynomial *decaFFT;   ///< fft version of deca
+    TLweSampleFFT *tmpa;                ///< the external product, in the fft domain
+};
+
+TGswFFTWorkspace *new_TGswFFTWorkspace(const TGswParams *params);
+void delete_TGswFFTWorkspace(TGswFFTWorkspace *ws);
+
+/** same as tGswFFTExternMulToTLwe, using the given workspace */
+void tGswFFTExternMulToTLwe(TLweSample *accum, const TGswSampleFFT *gsw, TGswFFTWorkspace &ws);
+
+/**
+ * The temporary samples of a bootstrap with n input coefficients. Each thread owns one,
+ * so that the bootstraps do not allocate anything.
+ */
+struct TfheBootstrapWorkspace {
+    int32_t n;
+    int32_t *bara;                  ///< the mask of the input, switched to Z/2N
+    TorusPolynomial *testvect;      ///< the test vector [mu,...,mu]
+    TorusPolynomial *testvectbis;   ///< the rotated test vector
+    TLweSample *acc;                ///< the accumulator of the blind rotation, and its next value
+    TLweSample *temp;
+    TGswFFTWorkspace *extprod;      ///< the buffers of the external products
+};
+
+TfheBootstrapWorkspace *new_TfheBootstrapWorkspace(const TGswParams *bk_params, int32_t n);
+void delete_TfheBootstrapWorkspace(TfheBootstrapWorkspace *ws);
+
+/** same as tfhe_blindRotate_FFT, using the given workspace (but its accumulator) */
+void tfhe_blindRotate_FFT(TLweSample *accum, const TGswSampleFFT *bk, const int32_t *bara, const int32_t n,
+                          const TGswParams *bk_params, TfheBootstrapWorkspace &ws);
+
+/** same as tfhe_blindRotateAndExtract_FFT, using the given workspace (but its mask bara) */
+void tfhe_blindRotateAndExtract_FFT(LweSample *result, const TorusPolynomial *v, const TGswSampleFFT *bk,
+                                    const int32_t barb, const int32_t *bara, const int32_t n,
+                                    const TGswParams *bk_params, TfheBootstrapWorkspace &ws);
+
+/** same as tfhe_bootstrap_woKS_FFT, using the given workspace */
+void tfhe_bootstrap_woKS_FFT(LweSample *result, const LweBootstrappingKeyFFT *bk, Torus32 mu, const LweSample *x,
+                             TfheBootstrapWorkspace &ws);
+#endif
+
 
 
 
@@ -55,11 +55,42 @@ EXPORT void tLweExtractLweSampleIndex(LweSample *result, const TLweSample *x, co
 EXPORT void
 tLweExtractLweSample(LweSample *result, const TLweSample *x, const LweParams *params, const TLweParams *rparams);
 
+/**
+ * extracts the coefficients first..first+nb_samples-1 of x to result[0..nb_samples-1], in one pass:
+ * the mask is reversed (negacyclically) once, then each sample is a contiguous slice of it
+ * @param rev a buffer of 2N coefficients, for the reversed mask
+ */
+EXPORT void tLweExtractLweSamples(LweSample *result, const TLweSample *x, const int32_t first, const int32_t nb_samples,
+                                  const LweParams *params, const TLweParams *rparams, Torus32 *rev);
+
 
 //extractions TLwe -> Lwe
 EXPORT void tLweExtractKey(LweKey *result, const TLweKey *); //sans doute un param supplémentaire
 //EXPORT void tLweExtractSample(LweSample* result, const TLweSample* x);
 
+//keyswitch Lwe -> TLwe
+/**
+ * fills the key of the functional keyswitch f(x)=x.P(X) (see LweToTLweKeySwitchKey), whose n,t,basebit
+ * fields are already set. The entries are encrypted under out_key, with the noise out_key->params->alpha_min.
+ */
+EXPORT void tLweCreateFunctionalKeySwitchKey(LweToTLweKeySwitchKey *result, const LweKey *in_key, const IntPolynomial *P,
+                                             const TLweKey *out_key);
+/** result = TLwe(P(X).phase(sample)), where P is the polynomial embedded in ks */
+EXPORT void tLweFunctionalKeySwitch(TLweSample *result, const LweToTLweKeySwitchKey *ks, const LweSample *sample);
+/**
+ * fills the key of the identity keyswitch (P=1): it can be published, and packs samples with
+ * tLwePackingKeySwitch. The private keyswitch uses a secret P with tLweCreateFunctionalKeySwitchKey.
+ */
+EXPORT void tLweCreateKeySwitchKey(LweToTLweKeySwitchKey *result, const LweKey *in_key, const TLweKey *out_key);
+/**
+ * public functional keyswitch which packs nb_samples <= N samples in one TLwe sample:
+ * result = TLwe(sum(X^q.P(X).phase(samples[q]))) for 0<=q<nb_samples, so that the coefficient q of the
+ * phase is the phase of samples[q] (with the identity key).
+ * @param nb_threads the threads which split the input coefficients (0 means tfhe_get_nb_threads())
+ */
+EXPORT void tLwePackingKeySwitch(TLweSample *result, const LweToTLweKeySwitchKey *ks, const LweSample *samples,
+                                 int32_t nb_samples, int32_t nb_threads);
+
 //FFT operations
 
 EXPORT void tLweToFFTConvert(TLweSampleFFT *result, const TLweSample *source, const TLweParams *params);
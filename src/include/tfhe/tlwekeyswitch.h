@@ -0,0 +1,56 @@
+#ifndef TLWEKEYSWITCH_H
+#define TLWEKEYSWITCH_H
+
+///@file
+///@brief This file contains the declaration of the LWE to TLWE keyswitch structures
+
+#include "tfhe_core.h"
+#include "tlwe.h"
+
+/**
+ * The key of a functional keyswitch from LWE samples (key s of length n) to TLWE samples.
+ * The b of the input is handled as an extra coefficient a[n] of key s[n]=-1, so that the
+ * phase of the input is -sum(a[i].s[i]) for 0<=i<=n. The entry (i,j) encrypts f(s[i]/base^(j+1))
+ * where f(x)=x.P(X) for an integer polynomial P: the result of the keyswitch encrypts
+ * P(X).phase(input). P is secret for the private keyswitch of the circuit bootstrapping.
+ */
+struct LweToTLweKeySwitchKey {
+    int32_t n; ///< length of the input key: s
+    int32_t t; ///< decomposition length
+    int32_t basebit; ///< log_2(base)
+    int32_t base; ///< decomposition base: a power of 2
+    const TLweParams* out_params; ///< params of the output key
+    double current_variance; ///< the (common) variance of all the entries
+    TLweSample* ks; ///< the (n+1).t entries, sorted by input coefficient i, then digit position j
+
+#ifdef __cplusplus
+    LweToTLweKeySwitchKey(int32_t n, int32_t t, int32_t basebit, const TLweParams* out_params);
+    ~LweToTLweKeySwitchKey();
+    LweToTLweKeySwitchKey(const LweToTLweKeySwitchKey&) = delete;
+    void operator=(const LweToTLweKeySwitchKey&) = delete;
+
+    /** the entry which encodes f(s[i]/base^(j+1)) */
+    TLweSample* entry(int32_t i, int32_t j) { return ks + i * t + j; }
+    const TLweSample* entry(int32_t i, int32_t j) const { return ks + i * t + j; }
+#endif
+};
+
+//initialize the LweToTLweKeySwitchKey structure
+//(equivalent of the C++ constructor)
+EXPORT void init_LweToTLweKeySwitchKey(LweToTLweKeySwitchKey* obj, int32_t n, int32_t t, int32_t basebit, const TLweParams* out_params);
+
+//destroys the LweToTLweKeySwitchKey structure
+//(equivalent of the C++ destructor)
+EXPORT void destroy_LweToTLweKeySwitchKey(LweToTLweKeySwitchKey* obj);
+
+//allocates and initialize the LweToTLweKeySwitchKey structure
+//(equivalent of the C++ new)
+EXPORT LweToTLweKeySwitchKey* new_LweToTLweKeySwitchKey(int32_t n, int32_t t, int32_t basebit, const TLweParams* out_params);
+EXPORT LweToTLweKeySwitchKey* new_LweToTLweKeySwitchKey_array(int32_t nbelts, int32_t n, int32_t t, int32_t basebit, const TLweParams* out_params);
+
+//destroys and frees the LweToTLweKeySwitchKey structure
+//(equivalent of the C++ delete)
+EXPORT void delete_LweToTLweKeySwitchKey(LweToTLweKeySwitchKey* obj);
+EXPORT void delete_LweToTLweKeySwitchKey_array(int32_t nbelts, LweToTLweKeySwitchKey* obj);
+
+#endif // TLWEKEYSWITCH_H
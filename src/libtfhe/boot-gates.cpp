@@ -371,3 +371,133 @@ EXPORT void bootsMUX(LweSample *result, const LweSample *a, const LweSample *b,
 
 
 
+/*
+ * Homomorphic bootstrapped Majority gate: result = (a+b+c >= 2)
+ * The phase a+b+c is in {-3/8,-1/8,1/8,3/8}: its sign is the majority, with one bootstrap
+ * (the margin is still 1/8, but the noise of the three inputs adds up)
+ * Takes in input 3 LWE samples (with message space [-1/8,1/8], noise<1/16)
+ * Outputs a LWE bootstrapped sample (with message space [-1/8,1/8], noise<1/16)
+*/
+EXPORT void bootsMAJ(LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
+                     const TFheGateBootstrappingCloudKeySet *bk) {
+    static const Torus32 MU = modSwitchToTorus32(1, 8);
+    const LweParams *in_out_params = bk->params->in_out_params;
+
+    LweSample *temp_result = new_LweSample(in_out_params);
+
+    //compute: (0,0) + a + b + c
+    lweNoiselessTrivial(temp_result, 0, in_out_params);
+    lweAddTo(temp_result, a, in_out_params);
+    lweAddTo(temp_result, b, in_out_params);
+    lweAddTo(temp_result, c, in_out_params);
+
+    //if the phase is positive, the result is 1/8
+    //if the phase is positive, else the result is -1/8
+    tfhe_bootstrap_FFT(result, bk->bkFFT, MU, temp_result);
+
+    delete_LweSample(temp_result);
+}
+
+
+/*
+ * Homomorphic bootstrapped Xor3 gate: result = a xor b xor c
+ * The phase -2(a+b+c) is 1/4 for an odd number of true inputs, and -1/4 else (modulo 1)
+ * Takes in input 3 LWE samples (with message space [-1/8,1/8], noise<1/16)
+ * Outputs a LWE bootstrapped sample (with message space [-1/8,1/8], noise<1/16)
+*/
+EXPORT void bootsXOR3(LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
+                      const TFheGateBootstrappingCloudKeySet *bk) {
+    static const Torus32 MU = modSwitchToTorus32(1, 8);
+    const LweParams *in_out_params = bk->params->in_out_params;
+
+    LweSample *temp_result = new_LweSample(in_out_params);
+
+    //compute: (0,0) - 2*(a + b + c)
+    lweNoiselessTrivial(temp_result, 0, in_out_params);
+    lweSubMulTo(temp_result, 2, a, in_out_params);
+    lweSubMulTo(temp_result, 2, b, in_out_params);
+    lweSubMulTo(temp_result, 2, c, in_out_params);
+
+    //if the phase is positive, the result is 1/8
+    //if the phase is positive, else the result is -1/8
+    tfhe_bootstrap_FFT(result, bk->bkFFT, MU, temp_result);
+
+    delete_LweSample(temp_result);
+}
+
+
+/*
+ * Homomorphic bootstrapped And3 gate: result = a and b and c
+ * Unlike the majority, it takes two bootstraps: the phases of a+b+c are 1/2 apart two by two,
+ * and the negacyclic bootstrap maps phases 1/2 apart to opposite values, so no single bootstrap
+ * separates 3/8 from the three others.
+*/
+EXPORT void bootsAND3(LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
+                      const TFheGateBootstrappingCloudKeySet *bk) {
+    const LweParams *in_out_params = bk->params->in_out_params;
+
+    LweSample *temp_result = new_LweSample(in_out_params);
+
+    bootsAND(temp_result, a, b, bk);
+    bootsAND(result, temp_result, c, bk);
+
+    delete_LweSample(temp_result);
+}
+
+
+/*
+ * Homomorphic bootstrapped Or3 gate: result = a or b or c
+ * It takes two bootstraps, for the same reason as bootsAND3
+*/
+EXPORT void bootsOR3(LweSample *result, const LweSample *a, const LweSample *b, const LweSample *c,
+                     const TFheGateBootstrappingCloudKeySet *bk) {
+    const LweParams *in_out_params = bk->params->in_out_params;
+
+    LweSample *temp_result = new_LweSample(in_out_params);
+
+    bootsOR(temp_result, a, b, bk);
+    bootsOR(result, temp_result, c, bk);
+
+    delete_LweSample(temp_result);
+}
+
+
+/*
+ * Homomorphic bootstrapped full adder: sum = a xor b xor c, carry = maj(a,b,c)
+ * Two independent bootstraps (instead of the five gates of two half adders); both keyswitches are
+ * deferred after the bootstraps, so sum and carry may be any of the inputs.
+*/
+EXPORT void bootsFULLADDER(LweSample *sum, LweSample *carry, const LweSample *a, const LweSample *b,
+                           const LweSample *c, const TFheGateBootstrappingCloudKeySet *bk) {
+    static const Torus32 MU = modSwitchToTorus32(1, 8);
+    const LweParams *in_out_params = bk->params->in_out_params;
+    const LweParams *extracted_params = &bk->params->tgsw_params->tlwe_params->extracted_lweparams;
+
+    LweSample *temp_result = new_LweSample(in_out_params);
+    LweSample *u1 = new_LweSample(extracted_params);
+    LweSample *u2 = new_LweSample(extracted_params);
+
+    //compute "MAJ(a,b,c)": (0,0) + a + b + c
+    lweNoiselessTrivial(temp_result, 0, in_out_params);
+    lweAddTo(temp_result, a, in_out_params);
+    lweAddTo(temp_result, b, in_out_params);
+    lweAddTo(temp_result, c, in_out_params);
+    // Bootstrap without KeySwitch
+    tfhe_bootstrap_woKS_FFT(u1, bk->bkFFT, MU, temp_result);
+
+    //compute "XOR3(a,b,c)": (0,0) - 2*(a + b + c)
+    lweNoiselessTrivial(temp_result, 0, in_out_params);
+    lweSubMulTo(temp_result, 2, a, in_out_params);
+    lweSubMulTo(temp_result, 2, b, in_out_params);
+    lweSubMulTo(temp_result, 2, c, in_out_params);
+    // Bootstrap without KeySwitch
+    tfhe_bootstrap_woKS_FFT(u2, bk->bkFFT, MU, temp_result);
+
+    // Key switching
+    lweKeySwitch(carry, bk->bkFFT->ks, u1);
+    lweKeySwitch(sum, bk->bkFFT->ks, u2);
+
+    delete_LweSample(u2);
+    delete_LweSample(u1);
+    delete_LweSample(temp_result);
+}
@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <cstring>
 #include "tfhe.h"
 
 using namespace std;
@@ -33,20 +34,18 @@ EXPORT void init_LweBootstrappingKeyFFT(LweBootstrappingKeyFFT *obj, const LweBo
     const int32_t N = extract_params->n;
 
     LweKeySwitchKey *ks = new_LweKeySwitchKey(N, t, basebit, in_out_params);
-    // Copy the KeySwitching key
-    for (int32_t i = 0; i < N; i++) {
-        for (int32_t j = 0; j < t; j++) {
-            for (int32_t p = 0; p < base; p++) {
-                lweCopy(&ks->ks[i][j][p], &bk->ks->ks[i][j][p], in_out_params);
-            }
-        }
-    }
+    // Copy the KeySwitching key (one contiguous block of t.(base-1) entries per input coefficient)
+    const int64_t block_size = int64_t(t) * (base - 1) * ks->stride;
+    tfhe_parallel_for(N, [&](int32_t i) {
+        memcpy(ks->data + i * block_size, bk->ks->data + i * block_size, block_size * sizeof(Torus32));
+    });
+    ks->current_variance = bk->ks->current_variance;
 
     // Bootstrapping Key FFT 
     TGswSampleFFT *bkFFT = new_TGswSampleFFT_array(n, bk_params);
-    for (int32_t i = 0; i < n; ++i) {
+    tfhe_parallel_for(n, [&](int32_t i) {
         tGswToFFTConvert(&bkFFT[i], &bk->bk[i], bk_params);
-    }
+    });
 
     new(obj) LweBootstrappingKeyFFT(in_out_params, bk_params, accum_params, extract_params, bkFFT, ks);
 }
@@ -64,13 +63,37 @@ EXPORT void destroy_LweBootstrappingKeyFFT(LweBootstrappingKeyFFT *obj) {
 }
 
 
+TfheBootstrapWorkspace *new_TfheBootstrapWorkspace(const TGswParams *bk_params, int32_t n) {
+    const TLweParams *accum_params = bk_params->tlwe_params;
+    TfheBootstrapWorkspace *ws = new TfheBootstrapWorkspace;
+    ws->n = n;
+    ws->bara = new int32_t[n];
+    ws->testvect = new_TorusPolynomial(accum_params->N);
+    ws->testvectbis = new_TorusPolynomial(accum_params->N);
+    ws->acc = new_TLweSample(accum_params);
+    ws->temp = new_TLweSample(accum_params);
+    ws->extprod = new_TGswFFTWorkspace(bk_params);
+    return ws;
+}
+
+void delete_TfheBootstrapWorkspace(TfheBootstrapWorkspace *ws) {
+    delete_TGswFFTWorkspace(ws->extprod);
+    delete_TLweSample(ws->temp);
+    delete_TLweSample(ws->acc);
+    delete_TorusPolynomial(ws->testvectbis);
+    delete_TorusPolynomial(ws->testvect);
+    delete[] ws->bara;
+    delete ws;
+}
+
+
 void tfhe_MuxRotate_FFT(TLweSample *result, const TLweSample *accum, const TGswSampleFFT *bki, const int32_t barai,
-                        const TGswParams *bk_params) {
+                        const TGswParams *bk_params, TGswFFTWorkspace &extprod) {
     // ACC = BKi*[(X^barai-1)*ACC]+ACC
     // temp = (X^barai-1)*ACC
     tLweMulByXaiMinusOne(result, barai, accum, bk_params->tlwe_params);
     // temp *= BKi
-    tGswFFTExternMulToTLwe(result, bki, bk_params);
+    tGswFFTExternMulToTLwe(result, bki, extprod);
     // ACC += temp
     tLweAddTo(result, accum, bk_params->tlwe_params);
 }
@@ -79,36 +102,50 @@ void tfhe_MuxRotate_FFT(TLweSample *result, const TLweSample *accum, const TGswS
 #if defined INCLUDE_ALL || defined INCLUDE_TFHE_BLIND_ROTATE_FFT
 #undef INCLUDE_TFHE_BLIND_ROTATE_FFT
 /**
- * multiply the accumulator by X^sum(bara_i.s_i)
- * @param accum the TLWE sample to multiply
+ * multiply the accumulator by X^sum(bara_i.s_i), with the temporary samples of the workspace
+ * @param accum the TLWE sample to multiply (it may not be ws.temp)
  * @param bk An array of n TGSW FFT samples where bk_i encodes s_i
  * @param bara An array of n coefficients between 0 and 2N-1
  * @param bk_params The parameters of bk
  */
-EXPORT void tfhe_blindRotate_FFT(TLweSample *accum,
-                                 const TGswSampleFFT *bkFFT,
-                                 const int32_t *bara,
-                                 const int32_t n,
-                                 const TGswParams *bk_params) {
-
-    //TGswSampleFFT* temp = new_TGswSampleFFT(bk_params);
-    TLweSample *temp = new_TLweSample(bk_params->tlwe_params);
-    TLweSample *temp2 = temp;
+void tfhe_blindRotate_FFT(TLweSample *accum,
+                          const TGswSampleFFT *bkFFT,
+                          const int32_t *bara,
+                          const int32_t n,
+                          const TGswParams *bk_params,
+                          TfheBootstrapWorkspace &ws) {
+
+    TLweSample *temp2 = ws.temp;
     TLweSample *temp3 = accum;
 
     for (int32_t i = 0; i < n; i++) {
         const int32_t barai = bara[i];
         if (barai == 0) continue; //indeed, this is an easy case!
 
-        tfhe_MuxRotate_FFT(temp2, temp3, bkFFT + i, barai, bk_params);
+        tfhe_MuxRotate_FFT(temp2, temp3, bkFFT + i, barai, bk_params, *ws.extprod);
         swap(temp2, temp3);
     }
     if (temp3 != accum) {
         tLweCopy(accum, temp3, bk_params->tlwe_params);
     }
+}
 
-    delete_TLweSample(temp);
-    //delete_TGswSampleFFT(temp);
+/**
+ * multiply the accumulator by X^sum(bara_i.s_i)
+ * @param accum the TLWE sample to multiply
+ * @param bk An array of n TGSW FFT samples where bk_i encodes s_i
+ * @param bara An array of n coefficients between 0 and 2N-1
+ * @param bk_params The parameters of bk
+ */
+EXPORT void tfhe_blindRotate_FFT(TLweSample *accum,
+                                 const TGswSampleFFT *bkFFT,
+                                 const int32_t *bara,
+                                 const int32_t n,
+                                 const TGswParams *bk_params) {
+
+    TfheBootstrapWorkspace *ws = new_TfheBootstrapWorkspace(bk_params, n);
+    tfhe_blindRotate_FFT(accum, bkFFT, bara, n, bk_params, *ws);
+    delete_TfheBootstrapWorkspace(ws);
 }
 #endif
 
@@ -116,21 +153,22 @@ EXPORT void tfhe_blindRotate_FFT(TLweSample *accum,
 #if defined INCLUDE_ALL || defined INCLUDE_TFHE_BLIND_ROTATE_AND_EXTRACT_FFT
 #undef INCLUDE_TFHE_BLIND_ROTATE_AND_EXTRACT_FFT
 /**
- * result = LWE(v_p) where p=barb-sum(bara_i.s_i) mod 2N
+ * result = LWE(v_p) where p=barb-sum(bara_i.s_i) mod 2N, with the temporary samples of the workspace
  * @param result the output LWE sample
- * @param v a 2N-elt anticyclic function (represented by a TorusPolynomial)
+ * @param v a 2N-elt anticyclic function (represented by a TorusPolynomial, it may be ws.testvect)
  * @param bk An array of n TGSW FFT samples where bk_i encodes s_i
  * @param barb A coefficients between 0 and 2N-1
  * @param bara An array of n coefficients between 0 and 2N-1
  * @param bk_params The parameters of bk
  */
-EXPORT void tfhe_blindRotateAndExtract_FFT(LweSample *result,
-                                           const TorusPolynomial *v,
-                                           const TGswSampleFFT *bk,
-                                           const int32_t barb,
-                                           const int32_t *bara,
-                                           const int32_t n,
-                                           const TGswParams *bk_params) {
+void tfhe_blindRotateAndExtract_FFT(LweSample *result,
+                                    const TorusPolynomial *v,
+                                    const TGswSampleFFT *bk,
+                                    const int32_t barb,
+                                    const int32_t *bara,
+                                    const int32_t n,
+                                    const TGswParams *bk_params,
+                                    TfheBootstrapWorkspace &ws) {
 
     const TLweParams *accum_params = bk_params->tlwe_params;
     const LweParams *extract_params = &accum_params->extracted_lweparams;
@@ -138,21 +176,40 @@ EXPORT void tfhe_blindRotateAndExtract_FFT(LweSample *result,
     const int32_t _2N = 2 * N;
 
     // Test polynomial 
-    TorusPolynomial *testvectbis = new_TorusPolynomial(N);
+    TorusPolynomial *testvectbis = ws.testvectbis;
     // Accumulator
-    TLweSample *acc = new_TLweSample(accum_params);
+    TLweSample *acc = ws.acc;
 
     // testvector = X^{2N-barb}*v
     if (barb != 0) torusPolynomialMulByXai(testvectbis, _2N - barb, v);
     else torusPolynomialCopy(testvectbis, v);
     tLweNoiselessTrivial(acc, testvectbis, accum_params);
     // Blind rotation
-    tfhe_blindRotate_FFT(acc, bk, bara, n, bk_params);
+    tfhe_blindRotate_FFT(acc, bk, bara, n, bk_params, ws);
     // Extraction
     tLweExtractLweSample(result, acc, extract_params, accum_params);
+}
 
-    delete_TLweSample(acc);
-    delete_TorusPolynomial(testvectbis);
+/**
+ * result = LWE(v_p) where p=barb-sum(bara_i.s_i) mod 2N
+ * @param result the output LWE sample
+ * @param v a 2N-elt anticyclic function (represented by a TorusPolynomial)
+ * @param bk An array of n TGSW FFT samples where bk_i encodes s_i
+ * @param barb A coefficients between 0 and 2N-1
+ * @param bara An array of n coefficients between 0 and 2N-1
+ * @param bk_params The parameters of bk
+ */
+EXPORT void tfhe_blindRotateAndExtract_FFT(LweSample *result,
+                                           const TorusPolynomial *v,
+                                           const TGswSampleFFT *bk,
+                                           const int32_t barb,
+                                           const int32_t *bara,
+                                           const int32_t n,
+                                           const TGswParams *bk_params) {
+
+    TfheBootstrapWorkspace *ws = new_TfheBootstrapWorkspace(bk_params, n);
+    tfhe_blindRotateAndExtract_FFT(result, v, bk, barb, bara, n, bk_params, *ws);
+    delete_TfheBootstrapWorkspace(ws);
 }
 #endif
 
@@ -160,16 +217,17 @@ EXPORT void tfhe_blindRotateAndExtract_FFT(LweSample *result,
 #if defined INCLUDE_ALL || defined INCLUDE_TFHE_BOOTSTRAP_WO_KS_FFT
 #undef INCLUDE_TFHE_BOOTSTRAP_WO_KS_FFT
 /**
- * result = LWE(mu) iff phase(x)>0, LWE(-mu) iff phase(x)<0
+ * result = LWE(mu) iff phase(x)>0, LWE(-mu) iff phase(x)<0, with the temporary samples of the workspace
  * @param result The resulting LweSample
  * @param bk The bootstrapping + keyswitch key
  * @param mu The output message (if phase(x)>0)
  * @param x The input sample
  */
-EXPORT void tfhe_bootstrap_woKS_FFT(LweSample *result,
-                                    const LweBootstrappingKeyFFT *bk,
-                                    Torus32 mu,
-                                    const LweSample *x) {
+void tfhe_bootstrap_woKS_FFT(LweSample *result,
+                             const LweBootstrappingKeyFFT *bk,
+                             Torus32 mu,
+                             const LweSample *x,
+                             TfheBootstrapWorkspace &ws) {
 
     const TGswParams *bk_params = bk->bk_params;
     const TLweParams *accum_params = bk->accum_params;
@@ -178,8 +236,8 @@ EXPORT void tfhe_bootstrap_woKS_FFT(LweSample *result,
     const int32_t Nx2 = 2 * N;
     const int32_t n = in_params->n;
 
-    TorusPolynomial *testvect = new_TorusPolynomial(N);
-    int32_t *bara = new int32_t[N];
+    TorusPolynomial *testvect = ws.testvect;
+    int32_t *bara = ws.bara;
 
 
     // Modulus switching
@@ -192,11 +250,24 @@ EXPORT void tfhe_bootstrap_woKS_FFT(LweSample *result,
     for (int32_t i = 0; i < N; i++) testvect->coefsT[i] = mu;
 
     // Bootstrapping rotation and extraction
-    tfhe_blindRotateAndExtract_FFT(result, testvect, bk->bkFFT, barb, bara, n, bk_params);
+    tfhe_blindRotateAndExtract_FFT(result, testvect, bk->bkFFT, barb, bara, n, bk_params, ws);
+}
 
+/**
+ * result = LWE(mu) iff phase(x)>0, LWE(-mu) iff phase(x)<0
+ * @param result The resulting LweSample
+ * @param bk The bootstrapping + keyswitch key
+ * @param mu The output message (if phase(x)>0)
+ * @param x The input sample
+ */
+EXPORT void tfhe_bootstrap_woKS_FFT(LweSample *result,
+                                    const LweBootstrappingKeyFFT *bk,
+                                    Torus32 mu,
+                                    const LweSample *x) {
 
-    delete[] bara;
-    delete_TorusPolynomial(testvect);
+    TfheBootstrapWorkspace *ws = new_TfheBootstrapWorkspace(bk->bk_params, bk->in_out_params->n);
+    tfhe_bootstrap_woKS_FFT(result, bk, mu, x, *ws);
+    delete_TfheBootstrapWorkspace(ws);
 }
 #endif
 
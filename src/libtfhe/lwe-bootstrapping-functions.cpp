@@ -210,9 +210,11 @@ EXPORT void tfhe_createLweBootstrappingKey(
     //const int32_t N = accum_params->N;
     //cout << "create the bootstrapping key bk ("  << "  " << n*kpl*(k+1)*N*4 << " bytes)" << endl;
     //cout << "  with noise_stdev: " << alpha << endl;
-    for (int32_t i = 0; i < n; i++) {
+    TfheRandomStreams streams(n);
+    tfhe_parallel_for(n, [&](int32_t i) {
+        streams.use_stream(i);
         tGswSymEncryptInt(&bk->bk[i], kin[i], alpha, rgsw_key);
-    }
+    });
 
 }
 #endif
@@ -20,14 +20,65 @@ using namespace std;
  */
 EXPORT void lweKeyGen(LweKey* result) {
   const int32_t n = result->params->n;
-  uniform_int_distribution<int32_t> distribution(0,1);
 
-  for (int32_t i=0; i<n; i++) 
-    result->key[i]=distribution(generator);
+  uniformBinary_array(result->key, n);
 }
 
 
 
+#ifdef __AVX2__
+/** returns sum(a[i].b[i]) (mod 2^32) using avx instructions (of size n, not necessarily multiple of 16) */
+static int32_t __attribute__ ((noinline)) intVecDotProduct_avx(const int32_t* a, const int32_t* b, int64_t n) {
+    const int64_t n0 = n & ~INT64_C(15); //the asm loop processes 16 coefficients per iteration
+    const int32_t* aend = a + n0;
+    int32_t result = 0;
+    if (n0 > 0) {
+        __asm__ __volatile__ (
+            "vpxor %%ymm0,%%ymm0,%%ymm0\n"       //two independent accumulators
+            "vpxor %%ymm1,%%ymm1,%%ymm1\n"
+            "1:\n"
+            "vmovdqu (%[a]),%%ymm2\n"
+            "vmovdqu 32(%[a]),%%ymm3\n"
+            "vpmulld (%[b]),%%ymm2,%%ymm2\n"
+            "vpmulld 32(%[b]),%%ymm3,%%ymm3\n"
+            "vpaddd %%ymm2,%%ymm0,%%ymm0\n"
+            "vpaddd %%ymm3,%%ymm1,%%ymm1\n"
+            "addq $64,%[a]\n"                  //advance a by 16*4
+            "addq $64,%[b]\n"                  //advance b by 16*4
+            "cmpq %[aend],%[a]\n"              //until aend
+            "jb 1b\n"
+            "vpaddd %%ymm1,%%ymm0,%%ymm0\n"     //horizontal sum of the 8 lanes
+            "vextracti128 $1,%%ymm0,%%xmm1\n"
+            "vpaddd %%xmm1,%%xmm0,%%xmm0\n"
+            "vpshufd $0x4E,%%xmm0,%%xmm1\n"
+            "vpaddd %%xmm1,%%xmm0,%%xmm0\n"
+            "vpshufd $0xB1,%%xmm0,%%xmm1\n"
+            "vpaddd %%xmm1,%%xmm0,%%xmm0\n"
+            "vmovd %%xmm0,%[res]\n"
+            "vzeroupper\n"
+            : [a] "+r"(a), [b] "+r"(b), [res] "=r"(result) //output
+            : [aend] "r"(aend)                          //input
+            : "ymm0", "ymm1", "ymm2", "ymm3", "cc", "memory" //clobber list
+        );
+    }
+    for (int64_t i = 0; i < n - n0; ++i) result += a[i]*b[i];
+    return result;
+}
+#endif
+
+/** returns sum(a[i].key[i]) */
+static inline Torus32 lweDotProduct(const Torus32* a, const int32_t* key, const int32_t n) {
+#ifdef __AVX2__
+    return intVecDotProduct_avx(a, key, n);
+#else
+    Torus32 axs = 0;
+    for (int32_t i = 0; i < n; ++i) 
+	   axs += a[i]*key[i]; 
+    return axs;
+#endif
+}
+
+
 /**
  * This function encrypts message by using key, with stdev alpha
  * The Lwe sample for the result must be allocated and initialized
@@ -37,11 +88,8 @@ EXPORT void lweSymEncrypt(LweSample* result, Torus32 message, double alpha, cons
     const int32_t n = key->params->n;
 
     result->b = gaussian32(message, alpha); 
-    for (int32_t i = 0; i < n; ++i)
-    {
-        result->a[i] = uniformTorus32_distrib(generator);
-        result->b += result->a[i]*key->key[i];
-    }
+    uniformTorus32_array(result->a, n);
+    result->b += lweDotProduct(result->a, key->key, n);
 
     result->current_variance = alpha*alpha;
 }
@@ -54,15 +102,22 @@ EXPORT void lweSymEncryptWithExternalNoise(LweSample* result, Torus32 message, d
     const int32_t n = key->params->n;
 
     result->b = message + dtot32(noise); 
-    for (int32_t i = 0; i < n; ++i)
-    {
-        result->a[i] = uniformTorus32_distrib(generator);
-        result->b += result->a[i]*key->key[i];
-    }
+    uniformTorus32_array(result->a, n);
+    result->b += lweDotProduct(result->a, key->key, n);
 
     result->current_variance = alpha*alpha;
 }
 
+/* 
+ * Same as above, on a raw ciphertext: a[0..n-1] is the mask and a[n] is b
+*/
+EXPORT void lweSymEncryptRawWithExternalNoise(Torus32* a, Torus32 message, double noise, const LweKey* key){
+    const int32_t n = key->params->n;
+
+    uniformTorus32_array(a, n);
+    a[n] = message + dtot32(noise) + lweDotProduct(a, key->key, n);
+}
+
 
 
 
@@ -71,13 +126,17 @@ EXPORT void lweSymEncryptWithExternalNoise(LweSample* result, Torus32 message, d
  */
 EXPORT Torus32 lwePhase(const LweSample* sample, const LweKey* key){
     const int32_t n = key->params->n;
-    Torus32 axs = 0;
-    const Torus32 *__restrict a = sample->a;
-    const int32_t * __restrict k = key->key;
 
-    for (int32_t i = 0; i < n; ++i) 
-	   axs += a[i]*k[i]; 
-    return sample->b - axs;
+    return sample->b - lweDotProduct(sample->a, key->key, n);
+}
+
+/**
+ * phase of a raw ciphertext (a[0..n-1],b=a[n])
+ */
+EXPORT Torus32 lwePhaseRaw(const Torus32* a, const LweKey* key){
+    const int32_t n = key->params->n;
+
+    return a[n] - lweDotProduct(a, key->key, n);
 }
 
 
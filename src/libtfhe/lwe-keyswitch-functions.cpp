@@ -3,7 +3,11 @@
 #include "lwe-functions.h"
 #include "lwekeyswitch.h"
 #include "numeric_functions.h"
+#include "tfhe_threads.h"
 #include <random>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 
 
 using namespace std;
@@ -25,6 +29,7 @@ void renormalizeKSkey(LweKeySwitchKey* ks, const LweKey* out_key, const int32_t*
     const int32_t basebit = ks->basebit;
     const int32_t t = ks->t;
     const int32_t base = 1<<basebit; 
+    const int32_t n_out = ks->out_params->n;
 
     Torus32 phase;
     Torus32 temp_err; 
@@ -36,7 +41,7 @@ void renormalizeKSkey(LweKeySwitchKey* ks, const LweKey* out_key, const int32_t*
         for (int32_t j = 0; j < t; ++j) {
             for (int32_t h = 1; h < base; ++h) { // pas le terme en 0
                 // compute the phase 
-                phase = lwePhase(&ks->ks[i][j][h], out_key);
+                phase = lwePhaseRaw(ks->entry(i,j,h), out_key);
                 // compute the error 
                 Torus32 x = (in_key[i]*h)*(1<<(32-(j+1)*basebit));
                 temp_err = phase - x;
@@ -52,7 +57,7 @@ void renormalizeKSkey(LweKeySwitchKey* ks, const LweKey* out_key, const int32_t*
     for (int32_t i = 0; i < n; ++i) {
         for (int32_t j = 0; j < t; ++j) {
             for (int32_t h = 1; h < base; ++h) { // pas le terme en 0
-                ks->ks[i][j][h].b -= error;                
+                ks->entry(i,j,h)[n_out] -= error;
             }
         }
     }
@@ -73,74 +78,243 @@ void renormalizeKSkey(LweKeySwitchKey* ks, const LweKey* out_key, const int32_t*
 
 /**
  * fills the KeySwitching key array
- * @param result The (n x t x base) array of samples. 
- *        result[i][j][k] encodes k.s[i]/base^(j+1)
+ * @param result The keyswitch key, whose n,t,basebit fields are already set
+ *        result->entry(i,j,h) encodes h.s[i]/base^(j+1) (for 1<=h<base)
  * @param out_key The LWE key to encode all the output samples 
  * @param out_alpha The standard deviation of all output samples
  * @param in_key The (binary) input key
- * @param n The size of the input key
- * @param t The precision of the keyswitch (technically, 1/2.base^t)
- * @param basebit Log_2 of base
  */
-void lweCreateKeySwitchKey_fromArray(LweSample*** result, 
+void lweCreateKeySwitchKey_fromArray(LweKeySwitchKey* result, 
 	const LweKey* out_key, const double out_alpha, 
-	const int32_t* in_key, const int32_t n, const int32_t t, const int32_t basebit){
+	const int32_t* in_key){
+    const int32_t n=result->n;
+    const int32_t t=result->t;
+    const int32_t basebit=result->basebit;
     const int32_t base=1<<basebit;       // base=2 in [CGGI16]
 
+    double* noise = new double[base-1];
     for(int32_t i=0;i<n;i++) {
     	for(int32_t j=0;j<t;j++){
-    	    for(int32_t k=0;k<base;k++){
+	    gaussianDouble_array(noise, base-1, out_alpha);
+    	    for(int32_t k=1;k<base;k++){
 		Torus32 x=(in_key[i]*k)*(1<<(32-(j+1)*basebit));
-		lweSymEncrypt(&result[i][j][k],x,out_alpha,out_key);
-		//printf("i,j,k,ki,x,phase=%d,%d,%d,%d,%d,%d\n",i,j,k,in_key->key[i],x,lwePhase(&result->ks[i][j][k],out_key));
+		lweSymEncryptRawWithExternalNoise(result->entry(i,j,k),x,noise[k-1],out_key);
     	    }
     	}
     }
+    result->current_variance = out_alpha*out_alpha;
+    delete[] noise;
+}
+
+
+/*
+ * Keyswitch engine
+ * The digits of the input are first decomposed into the list of the selected
+ * rows of the key, then the output vector is processed by blocks of
+ * KS_BLOCK coefficients: each block stays in registers while all the selected
+ * rows are subtracted from it, and the rows KS_PREFETCH_DISTANCE steps ahead are
+ * prefetched. The row list is padded with KS_PREFETCH_DISTANCE extra pointers so
+ * that the prefetches never read past its end.
+ */
+static const int32_t KS_BLOCK = 64;             ///< number of Torus32 per block (multiple of 16)
+static const int32_t KS_PREFETCH_DISTANCE = 8;  ///< prefetch the rows 8 steps ahead
+
+#ifdef __AVX2__
+/** acc[0..63] -= sum_k rows[k][offset..offset+63] (nb_rows>0, 8 ymm accumulators) */
+EXPORT void __attribute__ ((noinline)) lweKeySwitchBlock_avx2(Torus32* acc, const Torus32* const* rows, int64_t nb_rows, int64_t offset) {
+    const Torus32* const* rows_end = rows + nb_rows;
+    const int64_t byte_offset = offset * sizeof(Torus32);
+    __asm__ __volatile__ (
+        "vmovdqu (%[acc]),%%ymm0\n"
+        "vmovdqu 32(%[acc]),%%ymm1\n"
+        "vmovdqu 64(%[acc]),%%ymm2\n"
+        "vmovdqu 96(%[acc]),%%ymm3\n"
+        "vmovdqu 128(%[acc]),%%ymm4\n"
+        "vmovdqu 160(%[acc]),%%ymm5\n"
+        "vmovdqu 192(%[acc]),%%ymm6\n"
+        "vmovdqu 224(%[acc]),%%ymm7\n"
+        "1:\n"
+        "movq (%[rows]),%%rax\n"             //current row
+        "movq %c[pf](%[rows]),%%rdx\n"       //row to prefetch
+        "addq %[off],%%rax\n"
+        "addq %[off],%%rdx\n"
+        "prefetcht0 (%%rdx)\n"
+        "prefetcht0 64(%%rdx)\n"
+        "prefetcht0 128(%%rdx)\n"
+        "prefetcht0 192(%%rdx)\n"
+        "vpsubd (%%rax),%%ymm0,%%ymm0\n"
+        "vpsubd 32(%%rax),%%ymm1,%%ymm1\n"
+        "vpsubd 64(%%rax),%%ymm2,%%ymm2\n"
+        "vpsubd 96(%%rax),%%ymm3,%%ymm3\n"
+        "vpsubd 128(%%rax),%%ymm4,%%ymm4\n"
+        "vpsubd 160(%%rax),%%ymm5,%%ymm5\n"
+        "vpsubd 192(%%rax),%%ymm6,%%ymm6\n"
+        "vpsubd 224(%%rax),%%ymm7,%%ymm7\n"
+        "addq $8,%[rows]\n"
+        "cmpq %[rows_end],%[rows]\n"
+        "jb 1b\n"
+        "vmovdqu %%ymm0,(%[acc])\n"
+        "vmovdqu %%ymm1,32(%[acc])\n"
+        "vmovdqu %%ymm2,64(%[acc])\n"
+        "vmovdqu %%ymm3,96(%[acc])\n"
+        "vmovdqu %%ymm4,128(%[acc])\n"
+        "vmovdqu %%ymm5,160(%[acc])\n"
+        "vmovdqu %%ymm6,192(%[acc])\n"
+        "vmovdqu %%ymm7,224(%[acc])\n"
+        "vzeroupper\n"
+        : [rows] "+r"(rows)                                                  //output
+        : [acc] "r"(acc), [rows_end] "r"(rows_end), [off] "r"(byte_offset),
+          [pf] "i"(KS_PREFETCH_DISTANCE * sizeof(Torus32*))                  //input
+        : "rax", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+          "cc", "memory"                                                     //clobber list
+    );
 }
+#endif
 
+#ifdef __AVX512F__
+/** acc[0..63] -= sum_k rows[k][offset..offset+63] (nb_rows>0, 4 zmm accumulators) */
+EXPORT void __attribute__ ((noinline)) lweKeySwitchBlock_avx512(Torus32* acc, const Torus32* const* rows, int64_t nb_rows, int64_t offset) {
+    const Torus32* const* rows_end = rows + nb_rows;
+    const int64_t byte_offset = offset * sizeof(Torus32);
+    __asm__ __volatile__ (
+        "vmovdqu32 (%[acc]),%%zmm0\n"
+        "vmovdqu32 64(%[acc]),%%zmm1\n"
+        "vmovdqu32 128(%[acc]),%%zmm2\n"
+        "vmovdqu32 192(%[acc]),%%zmm3\n"
+        "1:\n"
+        "movq (%[rows]),%%rax\n"             //current row
+        "movq %c[pf](%[rows]),%%rdx\n"       //row to prefetch
+        "addq %[off],%%rax\n"
+        "addq %[off],%%rdx\n"
+        "prefetcht0 (%%rdx)\n"
+        "prefetcht0 64(%%rdx)\n"
+        "prefetcht0 128(%%rdx)\n"
+        "prefetcht0 192(%%rdx)\n"
+        "vpsubd (%%rax),%%zmm0,%%zmm0\n"
+        "vpsubd 64(%%rax),%%zmm1,%%zmm1\n"
+        "vpsubd 128(%%rax),%%zmm2,%%zmm2\n"
+        "vpsubd 192(%%rax),%%zmm3,%%zmm3\n"
+        "addq $8,%[rows]\n"
+        "cmpq %[rows_end],%[rows]\n"
+        "jb 1b\n"
+        "vmovdqu32 %%zmm0,(%[acc])\n"
+        "vmovdqu32 %%zmm1,64(%[acc])\n"
+        "vmovdqu32 %%zmm2,128(%[acc])\n"
+        "vmovdqu32 %%zmm3,192(%[acc])\n"
+        "vzeroupper\n"
+        : [rows] "+r"(rows)                                                  //output
+        : [acc] "r"(acc), [rows_end] "r"(rows_end), [off] "r"(byte_offset),
+          [pf] "i"(KS_PREFETCH_DISTANCE * sizeof(Torus32*))                  //input
+        : "rax", "rdx", "xmm0", "xmm1", "xmm2", "xmm3", "cc", "memory"       //clobber list
+    );
+}
+#endif
+
+/** acc[0..size-1] -= sum_k rows[k][offset..offset+size-1] (portable version) */
+static inline void lweKeySwitchBlock_scalar(Torus32* acc, const Torus32* const* rows, int64_t nb_rows, int64_t offset, int32_t size) {
+    for (int64_t k=0; k<nb_rows; k++) {
+	const Torus32* row=rows[k]+offset;
+	for (int32_t p=0; p<size; p++) acc[p]-=row[p];
+    }
+}
 
 /**
- * translates the message of the result sample by -sum(a[i].s[i]) where s is the secret
- * embedded in ks.
- * @param result the LWE sample to translate by -sum(ai.si). 
- * @param ks The (n x t x base) key switching key 
- *        ks[i][j][k] encodes k.s[i]/base^(j+1)
- * @param params The common LWE parameters of ks and result
- * @param ai The input torus array
- * @param n The size of the input key
- * @param t The precision of the keyswitch (technically, 1/2.base^t)
- * @param basebit Log_2 of base
+ * decomposes the input coefficients begin<=i<end and fills rows with the
+ * selected entries of ks (followed by the KS_PREFETCH_DISTANCE padding pointers).
+ * @return the number of selected entries
  */
-void lweKeySwitchTranslate_fromArray(LweSample* result, 
-	const LweSample*** ks, const LweParams* params, 
-	const Torus32* ai, 
-	const int32_t n, const int32_t t, const int32_t basebit){
+int64_t lweKeySwitchSelectRows(vector<const Torus32*>& rows,
+	const LweKeySwitchKey* ks, const Torus32* ai,
+	const int32_t begin, const int32_t end){
+    const int32_t t=ks->t;
+    const int32_t basebit=ks->basebit;
     const int32_t base=1<<basebit;       // base=2 in [CGGI16]
     const int32_t prec_offset=1<<(32-(1+basebit*t)); //precision
     const int32_t mask=base-1;
 
-    for (int32_t i=0;i<n;i++){
+    rows.resize(int64_t(end-begin)*t+KS_PREFETCH_DISTANCE);
+    int64_t nb_rows=0;
+    for (int32_t i=begin;i<end;i++){
 	const uint32_t aibar=ai[i]+prec_offset;
 	for (int32_t j=0;j<t;j++){
 	    const uint32_t aij=(aibar>>(32-(j+1)*basebit)) & mask;
-	    if(aij != 0) {lweSubTo(result,&ks[i][j][aij],params);}
+	    if(aij != 0) rows[nb_rows++]=ks->entry(i,j,aij);
 	}
     }
+    for (int32_t k=0; k<KS_PREFETCH_DISTANCE; k++) 
+	rows[nb_rows+k]=(nb_rows>0)?rows[nb_rows-1]:ks->data;
+    return nb_rows;
 }
 
+/** acc[begin..end-1] -= sum_k rows[k][begin..end-1], one block of KS_BLOCK coefficients at a time */
+void lweKeySwitchSubRows(Torus32* acc, const Torus32* const* rows, int64_t nb_rows, int32_t begin, int32_t end){
+    if (nb_rows==0) return;
+    int32_t off=begin;
+#if defined __AVX512F__ || defined __AVX2__
+    for (; off+KS_BLOCK<=end; off+=KS_BLOCK) {
+#ifdef __AVX512F__
+	lweKeySwitchBlock_avx512(acc+off, rows, nb_rows, off);
+#else
+	lweKeySwitchBlock_avx2(acc+off, rows, nb_rows, off);
+#endif
+    }
+#endif
+    for (; off<end; off+=KS_BLOCK) {
+	const int32_t size=(end-off<KS_BLOCK)?end-off:KS_BLOCK;
+	lweKeySwitchBlock_scalar(acc+off, rows, nb_rows, off, size);
+    }
+}
 
 
-EXPORT void lweCreateKeySwitchKey_old(LweKeySwitchKey* result, const LweKey* in_key, const LweKey* out_key){
-    const int32_t n=result->n;
-    const int32_t basebit=result->basebit;
-    const int32_t t=result->t;
+/**
+ * translates the message of the result sample by -sum(a[i].s[i]) where s is the secret
+ * embedded in ks.
+ * @param result the LWE sample to translate by -sum(ai.si). 
+ * @param ks The keyswitch key: ks->entry(i,j,h) encodes h.s[i]/base^(j+1)
+ * @param ai The input torus array
+ * @param begin,end Only the input coefficients begin<=i<end are processed
+ */
+void lweKeySwitchTranslate_fromArray(LweSample* result, 
+	const LweKeySwitchKey* ks, const Torus32* ai, 
+	const int32_t begin, const int32_t end){
+    static thread_local vector<const Torus32*> rows;
+    static thread_local vector<Torus32> acc;
+    const int32_t n_out=ks->out_params->n;
+    const int32_t stride=ks->stride;
+
+    const int64_t nb_rows=lweKeySwitchSelectRows(rows, ks, ai, begin, end);
+
+    // (a,b) followed by the padding, which is zero in all the rows
+    acc.assign(stride, 0);
+    for (int32_t p=0; p<n_out; p++) acc[p]=result->a[p];
+    acc[n_out]=result->b;
+    const int32_t nb_threads=tfhe_get_nb_gate_threads();
+    if (nb_threads>1) {
+	// latency mode: the blocks of output coefficients are split across the thread team
+	const int32_t nb_blocks=(stride+KS_BLOCK-1)/KS_BLOCK;
+	Torus32* acc_data=acc.data();
+	const Torus32* const* rows_data=rows.data();
+	tfhe_parallel_for(nb_blocks, [=](int32_t blk) {
+	    const int32_t block_end=(blk+1)*KS_BLOCK;
+	    lweKeySwitchSubRows(acc_data, rows_data, nb_rows, blk*KS_BLOCK, (block_end<stride)?block_end:stride);
+	}, nb_threads);
+    } else {
+	lweKeySwitchSubRows(acc.data(), rows.data(), nb_rows, 0, stride);
+    }
+    for (int32_t p=0; p<n_out; p++) result->a[p]=acc[p];
+    result->b=acc[n_out];
+    result->current_variance+=nb_rows*ks->current_variance;
+}
 
+
+
+EXPORT void lweCreateKeySwitchKey_old(LweKeySwitchKey* result, const LweKey* in_key, const LweKey* out_key){
     //TODO check the parameters
 
 
-    lweCreateKeySwitchKey_fromArray(result->ks,
+    lweCreateKeySwitchKey_fromArray(result,
 	    out_key, out_key->params->alpha_min,
-	    in_key->key, n, t, basebit);
+	    in_key->key);
 
     // renormalize
     renormalizeKSkey(result, out_key, in_key->key); // ILA: reverifier 
@@ -173,44 +347,29 @@ EXPORT void lweCreateKeySwitchKey(LweKeySwitchKey* result, const LweKey* in_key,
 
     // chose a random vector of gaussian noises
     double* noise = new double[sizeks];
-    for (int32_t i = 0; i < sizeks; ++i){
-        normal_distribution<double> distribution(0.,alpha); 
-        noise[i] = distribution(generator);
-        err += noise[i];
-    }
+    gaussianDouble_array(noise, sizeks, alpha);
+    for (int32_t i = 0; i < sizeks; ++i) err += noise[i];
     // recenter the noises
     err = err/sizeks;
     for (int32_t i = 0; i < sizeks; ++i) noise[i] -= err;
 
 
-    // generate the ks
-    int32_t index = 0; 
-    for (int32_t i = 0; i < n; ++i) {
+    // generate the ks (one task per input coefficient, each with its own random stream)
+    TfheRandomStreams streams(n);
+    tfhe_parallel_for(n, [&](int32_t i) {
+        streams.use_stream(i);
+        int32_t index = i*t*(base-1);
         for (int32_t j = 0; j < t; ++j) {
-
-            // term h=0 as trivial encryption of 0 (it will not be used in the KeySwitching)
-            lweNoiselessTrivial(&result->ks[i][j][0], 0, out_key->params);
-            //lweSymEncrypt(&result->ks[i][j][0],0,alpha,out_key);
-
-            for (int32_t h = 1; h < base; ++h) { // pas le terme en 0
-                /*
-                // noiseless encryption
-                result->ks[i][j][h].b = (in_key->key[i]*h)*(1<<(32-(j+1)*basebit));
-                for (int32_t p = 0; p < n_out; ++p) {
-                    result->ks[i][j][h].a[p] = uniformTorus32_distrib(generator);
-                    result->ks[i][j][h].b += result->ks[i][j][h].a[p] * out_key->key[p];
-                }
-                // add the noise 
-                result->ks[i][j][h].b += dtot32(noise[index]);
-                */
+            for (int32_t h = 1; h < base; ++h) { // pas le terme en 0 (il n'est pas stocke)
                 Torus32 mess = (in_key->key[i]*h)*(1<<(32-(j+1)*basebit));
-                lweSymEncryptWithExternalNoise(&result->ks[i][j][h], mess, noise[index], alpha, out_key);
+                lweSymEncryptRawWithExternalNoise(result->entry(i,j,h), mess, noise[index], out_key);
                 index += 1;
             }
         }
-    }
+    });
 
 
+    result->current_variance = alpha*alpha;
     delete[] noise; 
 }
 
@@ -228,33 +387,32 @@ EXPORT void lweCreateKeySwitchKey(LweKeySwitchKey* result, const LweKey* in_key,
 EXPORT void lweKeySwitch(LweSample* result, const LweKeySwitchKey* ks, const LweSample* sample){
     const LweParams* params=ks->out_params;
     const int32_t n=ks->n;
-    const int32_t basebit=ks->basebit;
-    const int32_t t=ks->t;
 
     lweNoiselessTrivial(result,sample->b,params);
     lweKeySwitchTranslate_fromArray(result,
-	    (const LweSample***) ks->ks, params,
-	    sample->a, n, t, basebit);
+	    ks, sample->a, 0, n);
 }
 
 /**
  * LweKeySwitchKey constructor function
  */
 EXPORT void init_LweKeySwitchKey(LweKeySwitchKey* obj, int32_t n, int32_t t, int32_t basebit, const LweParams* out_params) {
-    const int32_t base=1<<basebit;
-    LweSample* ks0_raw = new_LweSample_array(n*t*base, out_params);
-
-    new(obj) LweKeySwitchKey(n,t,basebit,out_params, ks0_raw);
+    new(obj) LweKeySwitchKey(n,t,basebit,out_params);
+    // one slab, aligned on a cache line
+    void* data = 0;
+    if (posix_memalign(&data, 64, obj->data_size()*sizeof(Torus32)) != 0) {
+        cerr << "unable to allocate the keyswitch key" << endl;
+        abort();
+    }
+    memset(data, 0, obj->data_size()*sizeof(Torus32));
+    obj->data = (Torus32*) data;
 }
 
 /**
  * LweKeySwitchKey destructor
  */
 EXPORT void destroy_LweKeySwitchKey(LweKeySwitchKey* obj) {
-    const int32_t n = obj->n;
-    const int32_t t = obj->t;
-    const int32_t base = obj->base;
-    delete_LweSample_array(n*t*base,obj->ks0_raw);
+    free(obj->data);
 
     obj->~LweKeySwitchKey();
 }
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <random>
 #include <cassert>
+#include <cstring>
 #include "tfhe_core.h"
 #include "numeric_functions.h"
 #include "lweparams.h"
@@ -60,6 +61,68 @@ EXPORT void tLweExtractLweSample(LweSample* result, const TLweSample* x, const L
 }
 
 
+#ifdef __AVX2__
+/** rev[m] = a[n-1-m] and rev[n+m] = -a[n-1-m] for 0<=m<n, using avx instructions (n multiple of 8) */
+static void __attribute__ ((noinline)) torus32ReverseNegacyclic_avx(Torus32* rev, const Torus32* a, int64_t n) {
+    static const int32_t reverse[8] = {7, 6, 5, 4, 3, 2, 1, 0};
+    const Torus32* src = a + n - 8;
+    const Torus32* rev_end = rev + n;
+    const int64_t byte_n = n * sizeof(Torus32);
+    __asm__ __volatile__ (
+        "vmovdqu (%[perm]),%%ymm2\n"
+        "vpxor %%ymm3,%%ymm3,%%ymm3\n"
+        "1:\n"
+        "vpermd (%[src]),%%ymm2,%%ymm0\n"     //8 coefficients, reversed
+        "vpsubd %%ymm0,%%ymm3,%%ymm1\n"       //and their opposites
+        "vmovdqu %%ymm0,(%[rev])\n"
+        "vmovdqu %%ymm1,(%[rev],%[bn])\n"
+        "subq $32,%[src]\n"
+        "addq $32,%[rev]\n"
+        "cmpq %[rev_end],%[rev]\n"
+        "jb 1b\n"
+        "vzeroupper\n"
+        : [src] "+r"(src), [rev] "+r"(rev)                    //output
+        : [perm] "r"(reverse), [rev_end] "r"(rev_end), [bn] "r"(byte_n) //input
+        : "ymm0", "ymm1", "ymm2", "ymm3", "cc", "memory"      //clobber list
+    );
+}
+#endif
+
+/**
+ * rev = (a[N-1],...,a[0],-a[N-1],...,-a[0]): the mask of the extraction of the coefficient index
+ * is rev[N-1-index..2N-2-index]
+ */
+static void torus32ReverseNegacyclic(Torus32* rev, const Torus32* a, const int32_t N) {
+#ifdef __AVX2__
+    if (N % 8 == 0) {
+        torus32ReverseNegacyclic_avx(rev, a, N);
+        return;
+    }
+#endif
+    for (int32_t m=0; m<N; m++) {
+        rev[m] = a[N-1-m];
+        rev[N+m] = -a[N-1-m];
+    }
+}
+
+EXPORT void tLweExtractLweSamples(LweSample* result, const TLweSample* x, const int32_t first, const int32_t nb_samples,
+                                  const LweParams* params, const TLweParams* rparams, Torus32* rev) {
+    const int32_t N = rparams->N;
+    const int32_t k = rparams->k;
+    assert(params->n == k*N);
+    assert(first >= 0 && first + nb_samples <= N);
+
+    // one reversal per mask polynomial, then one contiguous copy per sample
+    for (int32_t i=0; i<k; i++) {
+        torus32ReverseNegacyclic(rev, x->a[i].coefsT, N);
+        for (int32_t s=0; s<nb_samples; s++)
+            memcpy(result[s].a + i*N, rev + N-1-(first+s), N*sizeof(Torus32));
+    }
+    for (int32_t s=0; s<nb_samples; s++)
+        result[s].b = x->b->coefsT[first+s];
+}
+
+
 
 //extractions Ring Lwe -> Lwe
 EXPORT void tLweExtractKey(LweKey* result, const TLweKey* key) //sans doute un param supplémentaire
@@ -1,24 +1,17 @@
 #include "lwekeyswitch.h"
 
-LweKeySwitchKey::LweKeySwitchKey(int32_t n, int32_t t, int32_t basebit, const LweParams* out_params, LweSample* ks0_raw){
+LweKeySwitchKey::LweKeySwitchKey(int32_t n, int32_t t, int32_t basebit, const LweParams* out_params){
     this->basebit=basebit;
     this->out_params=out_params; 
     this->n=n;
     this->t=t;
     this->base=1<<basebit;
-    this->ks0_raw = ks0_raw;
-    ks1_raw = new LweSample*[n*t];
-    ks = new LweSample**[n];
-
-   
-    for (int32_t p = 0; p < n*t; ++p)
-	    ks1_raw[p] = ks0_raw + base*p;
-	for (int32_t p = 0; p < n; ++p)
-	    ks[p] = ks1_raw + t*p;
+    // a, b, then padding up to a multiple of 16 Torus32 (one cache line)
+    this->stride=(out_params->n+1+15) & ~15;
+    this->current_variance=0.;
+    this->data=0; //allocated by init_LweKeySwitchKey
 }
 
 LweKeySwitchKey::~LweKeySwitchKey() {
-    delete[] ks1_raw;
-    delete[] ks;
 }
 
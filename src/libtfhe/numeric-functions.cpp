@@ -8,8 +8,8 @@
 
 using namespace std;
 
-default_random_engine generator;
-uniform_int_distribution<Torus32> uniformTorus32_distrib(INT32_MIN, INT32_MAX);
+thread_local TfheRandomEngine generator;
+thread_local uniform_int_distribution<Torus32> uniformTorus32_distrib(INT32_MIN, INT32_MAX);
 uniform_int_distribution<int32_t> uniformInt_distrib(INT_MIN, INT_MAX);
 
 /** sets the seed of the random number generator to the given values */
@@ -18,14 +18,56 @@ EXPORT void tfhe_random_generator_setSeed(uint32_t* values, int32_t size) {
     generator.seed(seeds);
 }
 
+TfheRandomStreams::TfheRandomStreams(int32_t nb_streams): seeds(nb_streams * SEED_WORDS) {
+    generator.fill(seeds.data(), seeds.size());
+    saved_generator = generator;
+}
+
+TfheRandomStreams::~TfheRandomStreams() {
+    generator = saved_generator;
+}
+
+void TfheRandomStreams::use_stream(int32_t stream) const {
+    generator.seed_key(seeds.data() + stream * SEED_WORDS);
+}
+
 // Gaussian sample centered in message, with standard deviation sigma
 EXPORT Torus32 gaussian32(Torus32 message, double sigma){
     //Attention: all the implementation will use the stdev instead of the gaussian fourier param
-    normal_distribution<double> distribution(0.,sigma); //TODO: can we create a global distrib of param 1 and multiply by sigma?
-    double err = distribution(generator);
+    double err = sigma * generator.standard_normal();
     return message + dtot32(err);
 }
 
+EXPORT void gaussian32_array(Torus32* result, const Torus32* messages, int32_t size, double sigma){
+    const int32_t CHUNK = 128;
+    double err[CHUNK];
+    for (int32_t pos = 0; pos < size; pos += CHUNK) {
+        const int32_t nb = min(CHUNK, size - pos);
+        generator.fill_standard_normal(err, nb);
+        for (int32_t i = 0; i < nb; i++) {
+            result[pos + i] = (messages ? messages[pos + i] : 0) + dtot32(sigma * err[i]);
+        }
+    }
+}
+
+EXPORT void gaussianDouble_array(double* result, int32_t size, double sigma){
+    generator.fill_standard_normal(result, size);
+    for (int32_t i = 0; i < size; i++) result[i] *= sigma;
+}
+
+EXPORT void uniformTorus32_array(Torus32* result, int32_t size){
+    generator.fill((uint32_t*) result, size);
+}
+
+EXPORT void uniformBinary_array(int32_t* result, int32_t size){
+    uint32_t bits = 0;
+    for (int32_t i = 0; i < size; i++) {
+        if ((i & 31) == 0) bits = generator();
+        result[i] = bits & 1;
+        bits >>= 1;
+    }
+}
+
 
 
 // from double to Torus32
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <memory>
+#include "tfhe.h"
+#include "tfhe_async.h"
+
+using namespace std;
+
+
+void TfheCompletionQueue::push(uint64_t tag) {
+    {
+        lock_guard<mutex> guard(lock);
+        tags.push_back(tag);
+    }
+    cv.notify_one();
+}
+
+
+TfheAsyncEngine::TfheAsyncEngine(const TFheGateBootstrappingCloudKeySet *bk, int32_t nb_threads) :
+        bk(bk), nb_tasks(0), stopping(false) {
+    if (nb_threads <= 0) nb_threads = tfhe_get_nb_threads();
+    for (int32_t i = 0; i < nb_threads; i++) {
+        workers.push_back(thread(&TfheAsyncEngine::worker_loop, this, i, nb_threads));
+    }
+}
+
+TfheAsyncEngine::~TfheAsyncEngine() {
+    wait_all();
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    ready_cv.notify_all();
+    for (thread &worker: workers) worker.join();
+}
+
+void TfheAsyncEngine::add_dependency(Task *from, Task *to) {
+    if (from == 0 || from == to) return;
+    if (!from->successors.empty() && from->successors.back() == to) return;
+    from->successors.push_back(to);
+    to->nb_predecessors++;
+}
+
+void TfheAsyncEngine::submit(TfheGateType type, LweSample *result, const LweSample *a, const LweSample *b,
+                             const LweSample *c, int32_t value, const function<void()> &done) {
+    const int32_t nb_inputs = tfhe_gate_nb_inputs(type);
+    Task *task = new Task();
+    task->type = type;
+    task->result = result;
+    task->in[0] = (nb_inputs > 0) ? a : 0;
+    task->in[1] = (nb_inputs > 1) ? b : 0;
+    task->in[2] = (nb_inputs > 2) ? c : 0;
+    task->value = value;
+    task->done = done;
+    task->nb_predecessors = 0;
+
+    {
+        lock_guard<mutex> guard(lock);
+        // read after write
+        for (int32_t i = 0; i < nb_inputs; i++) {
+            SampleState &state = samples[task->in[i]];
+            add_dependency(state.writer, task);
+            state.readers.push_back(task);
+        }
+        // write after write, and write after read
+        SampleState &state = samples[result];
+        add_dependency(state.writer, task);
+        for (Task *reader: state.readers) add_dependency(reader, task);
+        state.writer = task;
+        state.readers.clear();
+
+        nb_tasks++;
+        if (task->nb_predecessors == 0) ready.push_back(task);
+    }
+    if (task->nb_predecessors == 0) ready_cv.notify_one();
+}
+
+future<void> TfheAsyncEngine::submit(TfheGateType type, LweSample *result, const LweSample *a, const LweSample *b,
+                                     const LweSample *c, int32_t value) {
+    shared_ptr<promise<void> > done = make_shared<promise<void> >();
+    submit(type, result, a, b, c, value, [done]() { done->set_value(); });
+    return done->get_future();
+}
+
+int32_t TfheAsyncEngine::nb_pending() {
+    lock_guard<mutex> guard(lock);
+    return nb_tasks;
+}
+
+void TfheAsyncEngine::wait_all() {
+    unique_lock<mutex> guard(lock);
+    idle_cv.wait(guard, [this] { return nb_tasks == 0; });
+}
+
+// called with the lock held, when the result of the task is written
+void TfheAsyncEngine::release(Task *task) {
+    for (int32_t i = 0; i < 3; i++) {
+        if (task->in[i] == 0) continue;
+        map<const LweSample *, SampleState>::iterator it = samples.find(task->in[i]);
+        if (it == samples.end()) continue; // already released (repeated input)
+        vector<Task *> &readers = it->second.readers;
+        readers.erase(std::remove(readers.begin(), readers.end(), task), readers.end());
+        if (it->second.writer == 0 && readers.empty()) samples.erase(it);
+    }
+    map<const LweSample *, SampleState>::iterator it = samples.find(task->result);
+    if (it != samples.end()) {
+        if (it->second.writer == task) it->second.writer = 0;
+        if (it->second.writer == 0 && it->second.readers.empty()) samples.erase(it);
+    }
+    for (Task *successor: task->successors) {
+        if (--successor->nb_predecessors == 0) {
+            ready.push_back(successor);
+            ready_cv.notify_one();
+        }
+    }
+}
+
+void TfheAsyncEngine::worker_loop(int32_t index, int32_t nb_workers) {
+    TfheNumaBinding binding(index, nb_workers);
+    const TFheGateBootstrappingCloudKeySet *key = tfhe_numa_local_cloud_key(bk);
+    TfheGateWorkspace ws(bk->params);
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        ready_cv.wait(guard, [this] { return stopping || !ready.empty(); });
+        if (ready.empty()) return;
+        Task *task = ready.front();
+        ready.pop_front();
+        guard.unlock();
+
+        tfhe_execute_gate(task->result, task->type, task->in[0], task->in[1], task->in[2], task->value, key, ws);
+        function<void()> done;
+        done.swap(task->done);
+
+        guard.lock();
+        release(task);
+        delete task;
+        guard.unlock();
+        if (done) done();
+        guard.lock();
+        if (--nb_tasks == 0) idle_cv.notify_all();
+    }
+}
+
+
+EXPORT TfheAsyncEngine *new_TfheAsyncEngine(const TFheGateBootstrappingCloudKeySet *bk, int32_t nb_threads) {
+    return new TfheAsyncEngine(bk, nb_threads);
+}
+
+EXPORT void delete_TfheAsyncEngine(TfheAsyncEngine *engine) {
+    delete engine;
+}
+
+EXPORT void tfhe_async_submit(TfheAsyncEngine *engine, TfheGateType type, LweSample *result,
+                              const LweSample *a, const LweSample *b, const LweSample *c, int32_t value,
+                              TfheGateCallback callback, void *user_data) {
+    function<void()> done;
+    if (callback) done = [callback, user_data]() { callback(user_data); };
+    engine->submit(type, result, a, b, c, value, done);
+}
+
+EXPORT void tfhe_async_submit_to_queue(TfheAsyncEngine *engine, TfheGateType type, LweSample *result,
+                                       const LweSample *a, const LweSample *b, const LweSample *c, int32_t value,
+                                       TfheCompletionQueue *queue, uint64_t tag) {
+    engine->submit(type, result, a, b, c, value, [queue, tag]() { queue->push(tag); });
+}
+
+EXPORT int32_t tfhe_async_nb_pending(TfheAsyncEngine *engine) {
+    return engine->nb_pending();
+}
+
+EXPORT void tfhe_async_wait_all(TfheAsyncEngine *engine) {
+    engine->wait_all();
+}
+
+EXPORT TfheCompletionQueue *new_TfheCompletionQueue() {
+    return new TfheCompletionQueue();
+}
+
+EXPORT void delete_TfheCompletionQueue(TfheCompletionQueue *queue) {
+    delete queue;
+}
+
+EXPORT int32_t tfhe_completion_queue_poll(TfheCompletionQueue *queue, uint64_t *tag) {
+    lock_guard<mutex> guard(queue->lock);
+    if (queue->tags.empty()) return 0;
+    *tag = queue->tags.front();
+    queue->tags.pop_front();
+    return 1;
+}
+
+EXPORT uint64_t tfhe_completion_queue_wait(TfheCompletionQueue *queue) {
+    unique_lock<mutex> guard(queue->lock);
+    queue->cv.wait(guard, [queue] { return !queue->tags.empty(); });
+    const uint64_t tag = queue->tags.front();
+    queue->tags.pop_front();
+    return tag;
+}
@@ -0,0 +1,69 @@
+#include "tfhe.h"
+#include "tfhe_circuit_bootstrapping.h"
+
+using namespace std;
+
+
+TfheCircuitBootstrappingKey::TfheCircuitBootstrappingKey(const TFheGateBootstrappingCloudKeySet *bk,
+                                                         const TGswParams *tgsw_params, LweToTLweKeySwitchKey *ks) :
+        bk(bk), tgsw_params(tgsw_params), ks(ks) {}
+
+TfheCircuitBootstrappingKey::~TfheCircuitBootstrappingKey() {
+    delete_LweToTLweKeySwitchKey_array(tgsw_params->tlwe_params->k + 1, ks);
+}
+
+
+EXPORT TfheCircuitBootstrappingKey *new_TfheCircuitBootstrappingKey(const TFheGateBootstrappingSecretKeySet *key,
+                                                                    const TGswParams *tgsw_params,
+                                                                    int32_t ks_t, int32_t ks_basebit) {
+    const TLweParams *accum_params = key->params->tgsw_params->tlwe_params;
+    if (tgsw_params->tlwe_params != accum_params)
+        die_dramatically("the circuit bootstrapping must use the tlwe params of the gate bootstrapping");
+    if (ks_t * ks_basebit >= 32) die_dramatically("the private keyswitch must have less than 32 bits of precision");
+    const TLweKey *tlwe_key = &key->tgsw_key->tlwe_key;
+    const int32_t N = accum_params->N;
+    const int32_t k = accum_params->k;
+
+    // the input of the keyswitches is a bootstrapped sample, under the extracted key
+    LweKey *extracted_key = new_LweKey(&accum_params->extracted_lweparams);
+    tLweExtractKey(extracted_key, tlwe_key);
+    LweToTLweKeySwitchKey *ks = new_LweToTLweKeySwitchKey_array(k + 1, k * N, ks_t, ks_basebit, accum_params);
+    IntPolynomial *P = new_IntPolynomial(N);
+    for (int32_t u = 0; u <= k; u++) {
+        for (int32_t i = 0; i < N; i++) P->coefs[i] = (u < k) ? -tlwe_key->key[u].coefs[i] : (i == 0);
+        tLweCreateFunctionalKeySwitchKey(ks + u, extracted_key, P, tlwe_key);
+    }
+    delete_IntPolynomial(P);
+    delete_LweKey(extracted_key);
+    return new TfheCircuitBootstrappingKey(&key->cloud, tgsw_params, ks);
+}
+
+EXPORT void delete_TfheCircuitBootstrappingKey(TfheCircuitBootstrappingKey *cbk) {
+    delete cbk;
+}
+
+
+EXPORT void tfhe_circuitBootstrap(TGswSample *result, const TfheCircuitBootstrappingKey *cbk, const LweSample *x) {
+    const TGswParams *params = cbk->tgsw_params;
+    const LweBootstrappingKeyFFT *bk = cbk->bk->bkFFT;
+    const int32_t k = params->tlwe_params->k;
+
+    // the levels are independent: one task per level
+    tfhe_parallel_for(params->l, [&](int32_t j) {
+        LweSample *u = new_LweSample(&bk->accum_params->extracted_lweparams);
+        // bootstrap to +-h[j]/2, then shift to m.h[j]
+        const Torus32 mu = params->h[j] / 2;
+        tfhe_bootstrap_woKS_FFT(u, bk, mu, x);
+        u->b += mu;
+        for (int32_t bloc = 0; bloc <= k; bloc++) tLweFunctionalKeySwitch(&result->bloc_sample[bloc][j], cbk->ks + bloc, u);
+        delete_LweSample(u);
+    });
+}
+
+EXPORT void tfhe_circuitBootstrap_FFT(TGswSampleFFT *result, const TfheCircuitBootstrappingKey *cbk,
+                                      const LweSample *x) {
+    TGswSample *temp = new_TGswSample(cbk->tgsw_params);
+    tfhe_circuitBootstrap(temp, cbk, x);
+    tGswToFFTConvert(result, temp, cbk->tgsw_params);
+    delete_TGswSample(temp);
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include "tfhe.h"
+#include "tfhe_cmux.h"
+
+using namespace std;
+
+
+TfheCMuxWorkspace::TfheCMuxWorkspace(const TGswParams *params) : params(params) {
+    extprod = new_TGswFFTWorkspace(params);
+    diff = new_TLweSample(params->tlwe_params);
+}
+
+TfheCMuxWorkspace::~TfheCMuxWorkspace() {
+    delete_TLweSample(diff);
+    delete_TGswFFTWorkspace(extprod);
+}
+
+void tLweCMuxFFT(TLweSample *result, const TGswSampleFFT *selector, const TLweSample *c0, const TLweSample *c1,
+                 TfheCMuxWorkspace &ws) {
+    const TLweParams *tlwe_params = ws.params->tlwe_params;
+
+    // the difference is computed first, so that result may be c0 or c1
+    tLweCopy(ws.diff, c1, tlwe_params);
+    tLweSubTo(ws.diff, c0, tlwe_params);
+    tGswFFTExternMulToTLwe(ws.diff, selector, *ws.extprod);
+    if (result != c0) tLweCopy(result, c0, tlwe_params);
+    tLweAddTo(result, ws.diff, tlwe_params);
+}
+
+
+EXPORT void tLweCMux(TLweSample *result, const TGswSample *selector, const TLweSample *c0, const TLweSample *c1,
+                     const TGswParams *params) {
+    const TLweParams *tlwe_params = params->tlwe_params;
+    TLweSample *diff = new_TLweSample(tlwe_params);
+
+    tLweCopy(diff, c1, tlwe_params);
+    tLweSubTo(diff, c0, tlwe_params);
+    tGswExternMulToTLwe(diff, selector, params);
+    if (result != c0) tLweCopy(result, c0, tlwe_params);
+    tLweAddTo(result, diff, tlwe_params);
+    delete_TLweSample(diff);
+}
+
+EXPORT void tLweCMuxFFT(TLweSample *result, const TGswSampleFFT *selector, const TLweSample *c0,
+                        const TLweSample *c1, const TGswParams *params) {
+    TfheCMuxWorkspace ws(params);
+    tLweCMuxFFT(result, selector, c0, c1, ws);
+}
+
+
+TfheCMuxTree::TfheCMuxTree(const TGswParams *params, int32_t m, int32_t nb_threads) :
+        params(params), m(m), nb_threads(nb_threads > 0 ? nb_threads : tfhe_get_nb_threads()) {
+    for (int32_t parity = 0; parity < 2; parity++)
+        level[parity] = new_TLweSample_array(level_size(parity), params->tlwe_params);
+    // no level has more than 2^(m-1) CMuxes
+    const int32_t nb_workspaces = min(this->nb_threads, level_size(0));
+    for (int32_t i = 0; i < nb_workspaces; i++) workspaces.push_back(new TfheCMuxWorkspace(params));
+}
+
+TfheCMuxTree::~TfheCMuxTree() {
+    for (TfheCMuxWorkspace *ws: workspaces) delete ws;
+    for (int32_t parity = 0; parity < 2; parity++) delete_TLweSample_array(level_size(parity), level[parity]);
+}
+
+EXPORT TfheCMuxTree *new_TfheCMuxTree(const TGswParams *params, int32_t m, int32_t nb_threads) {
+    return new TfheCMuxTree(params, m, nb_threads);
+}
+
+EXPORT void delete_TfheCMuxTree(TfheCMuxTree *tree) {
+    delete tree;
+}
+
+EXPORT void tfhe_cmuxTree(TLweSample *result, TfheCMuxTree *tree, const TGswSampleFFT *selectors,
+                          const TLweSample *data) {
+    const int32_t m = tree->m;
+    if (m == 0) {
+        tLweCopy(result, data, tree->params->tlwe_params);
+        return;
+    }
+
+    // level t reads the outputs of level t-1 (or data), and writes to the other buffer (or result)
+    const TLweSample *in = data;
+    for (int32_t t = 0; t < m; t++) {
+        TLweSample *out = (t == m - 1) ? result : tree->level[t % 2];
+        const int32_t nb_cmux = 1 << (m - t - 1);
+        const int32_t nb_workers = min(nb_cmux, (int32_t) tree->workspaces.size());
+        // one task per workspace, each evaluating every nb_workers-th CMux of the level
+        tfhe_parallel_for(nb_workers, [&](int32_t w) {
+            for (int32_t i = w; i < nb_cmux; i += nb_workers)
+                tLweCMuxFFT(out + i, selectors + t, in + 2 * i, in + 2 * i + 1, *tree->workspaces[w]);
+        }, nb_workers);
+        in = out;
+    }
+}
@@ -0,0 +1,512 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "tfhe.h"
+#include "tfhe_io.h"
+#include "tfhe_distributed.h"
+
+using namespace std;
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+
+namespace {
+
+    // the messages: a command, the size of the payload, then the payload
+    enum Command {
+        COMMAND_SETUP = 1,   ///< the plan of the worker; replied with a status
+        COMMAND_RUN = 2,     ///< a level, and the wires received by the worker; replied with the wires it sends
+        COMMAND_QUIT = 3,
+        COMMAND_REPLY = 4
+    };
+
+    /** the largest payload accepted from a peer: a plan, or the wires of a level */
+    const int64_t MAX_PAYLOAD_SIZE = int64_t(1) << 30;
+
+    bool fail(const string &message) {
+        cerr << "distributed: " << message << endl;
+        return false;
+    }
+
+    /** opens a socket listening on, or connected to, an address */
+    int32_t open_socket(const string &address, bool listening) {
+        if (address.compare(0, 5, "unix:") == 0) {
+            const string path = address.substr(5);
+            sockaddr_un addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+                fail("invalid socket path " + path);
+                return -1;
+            }
+            strcpy(addr.sun_path, path.c_str());
+            const int32_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0) return -1;
+            if (listening) unlink(path.c_str());
+            const int32_t status = listening ? bind(fd, (sockaddr *) &addr, sizeof(addr))
+                                             : connect(fd, (sockaddr *) &addr, sizeof(addr));
+            if (status != 0 || (listening && listen(fd, 16) != 0)) {
+                fail(address + ": " + strerror(errno));
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        const size_t colon = address.rfind(':');
+        if (colon == string::npos) {
+            fail("invalid address " + address + " (expected unix:path or host:port)");
+            return -1;
+        }
+        const string host = address.substr(0, colon);
+        const string port = address.substr(colon + 1);
+        addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (listening) hints.ai_flags = AI_PASSIVE;
+        const bool any_host = host.empty() || host == "*";
+        addrinfo *infos = 0;
+        const int32_t error = getaddrinfo(any_host ? 0 : host.c_str(), port.c_str(), &hints, &infos);
+        if (error != 0) {
+            fail(address + ": " + gai_strerror(error));
+            return -1;
+        }
+        int32_t fd = -1;
+        for (addrinfo *info = infos; info != 0 && fd < 0; info = info->ai_next) {
+            fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+            if (fd < 0) continue;
+            const int32_t one = 1;
+            int32_t status;
+            if (listening) {
+                setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+                status = bind(fd, info->ai_addr, info->ai_addrlen);
+                if (status == 0) status = listen(fd, 16);
+            } else {
+                status = connect(fd, info->ai_addr, info->ai_addrlen);
+                if (status == 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            if (status != 0) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        if (fd < 0) fail(address + ": " + strerror(errno));
+        freeaddrinfo(infos);
+        return fd;
+    }
+
+    bool write_all(int32_t fd, const void *data, size_t size) {
+        const char *p = (const char *) data;
+        while (size > 0) {
+            const ssize_t written = send(fd, p, size, MSG_NOSIGNAL);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return false;
+            p += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    bool read_all(int32_t fd, void *data, size_t size) {
+        char *p = (char *) data;
+        while (size > 0) {
+            const ssize_t nb_read = recv(fd, p, size, 0);
+            if (nb_read < 0 && errno == EINTR) continue;
+            if (nb_read <= 0) return false;
+            p += nb_read;
+            size -= nb_read;
+        }
+        return true;
+    }
+
+    bool send_message(int32_t fd, int32_t command, const string &payload) {
+        const int64_t size = payload.size();
+        return write_all(fd, &command, sizeof(command)) && write_all(fd, &size, sizeof(size))
+               && write_all(fd, payload.data(), size);
+    }
+
+    bool receive_message(int32_t fd, int32_t &command, string &payload) {
+        int64_t size;
+        if (!read_all(fd, &command, sizeof(command)) || !read_all(fd, &size, sizeof(size))) return false;
+        if (size < 0 || size > MAX_PAYLOAD_SIZE) return fail("invalid message size " + to_string(size));
+        payload.resize(size);
+        return read_all(fd, &payload[0], size);
+    }
+
+    void put(ostream &out, int32_t value) {
+        out.write((const char *) &value, sizeof(value));
+    }
+
+    int32_t get(istream &in) {
+        int32_t value = -1;
+        in.read((char *) &value, sizeof(value));
+        return value;
+    }
+
+    /** writes the count, then the wires and their ciphertexts */
+    void put_wires(ostream &out, const vector<int32_t> &ids, const LweSample *wires,
+                   const TFheGateBootstrappingParameterSet *params) {
+        put(out, ids.size());
+        for (int32_t id: ids) {
+            put(out, id);
+            export_gate_bootstrapping_ciphertext_toStream(out, wires + id, params);
+        }
+    }
+
+    /** reads the wires written by put_wires, and returns their number (-1 on error) */
+    int32_t get_wires(istream &in, int32_t nb_wires, LweSample *wires, const TFheGateBootstrappingParameterSet *params) {
+        const int32_t count = get(in);
+        if (count < 0 || count > nb_wires) return -1;
+        for (int32_t i = 0; i < count && in; i++) {
+            const int32_t id = get(in);
+            if (id < 0 || id >= nb_wires) return -1;
+            import_gate_bootstrapping_ciphertext_fromStream(in, wires + id, params);
+        }
+        return in ? count : -1;
+    }
+
+    void put_plan(ostream &out, const TfheWorkerPlan &plan) {
+        const TfheNetlist &netlist = plan.netlist;
+        put(out, netlist.nb_wires);
+        put(out, netlist.gates.size());
+        for (const TfheNetlistGate &g: netlist.gates) {
+            put(out, g.type);
+            put(out, g.out);
+            for (int32_t i = 0; i < 3; i++) put(out, g.in[i]);
+            put(out, g.value);
+        }
+        put(out, netlist.levels.size());
+        for (int32_t l = 0; l < int32_t(netlist.levels.size()); l++) {
+            put(out, netlist.levels[l].begin);
+            put(out, netlist.levels[l].free_begin);
+            put(out, netlist.levels[l].end);
+            put(out, plan.send[l].size());
+            for (int32_t wire: plan.send[l]) put(out, wire);
+        }
+    }
+
+    bool get_plan(istream &in, TfheWorkerPlan &plan) {
+        TfheNetlist &netlist = plan.netlist;
+        netlist.nb_wires = get(in);
+        const int32_t nb_gates = get(in);
+        if (!in || netlist.nb_wires < 0 || nb_gates < 0) return false;
+        for (int32_t i = 0; i < nb_gates && in; i++) {
+            TfheNetlistGate g;
+            g.type = TfheGateType(get(in));
+            g.out = get(in);
+            for (int32_t j = 0; j < 3; j++) g.in[j] = get(in);
+            g.value = get(in);
+            if (g.type < 0 || g.type >= TFHE_GATE_NB_TYPES || g.out < 0 || g.out >= netlist.nb_wires) return false;
+            // the inputs are wires, or -1 for the unused ones
+            for (int32_t j = 0; j < 3; j++) {
+                const int32_t min_wire = (j < tfhe_gate_nb_inputs(g.type)) ? 0 : -1;
+                if (g.in[j] < min_wire || g.in[j] >= netlist.nb_wires) return false;
+            }
+            netlist.gates.push_back(g);
+        }
+        const int32_t nb_levels = get(in);
+        if (nb_levels < 0) return false;
+        for (int32_t l = 0; l < nb_levels && in; l++) {
+            TfheNetlistLevel level;
+            level.begin = get(in);
+            level.free_begin = get(in);
+            level.end = get(in);
+            if (level.begin < 0 || level.begin > level.free_begin || level.free_begin > level.end
+                || level.end > nb_gates)
+                return false;
+            netlist.levels.push_back(level);
+            const int32_t nb_send = get(in);
+            if (nb_send < 0 || nb_send > netlist.nb_wires) return false;
+            plan.send.push_back(vector<int32_t>(nb_send));
+            for (int32_t &wire: plan.send.back()) {
+                wire = get(in);
+                if (wire < 0 || wire >= netlist.nb_wires) return false;
+            }
+        }
+        return bool(in);
+    }
+
+    /** serves one coordinator: returns true if the session ended with a quit command */
+    bool serve_session(int32_t fd, const TFheGateBootstrappingCloudKeySet *bk, int32_t nb_threads) {
+        const TFheGateBootstrappingParameterSet *params = bk->params;
+        TfheWorkerPlan plan;
+        LweSample *wires = 0;
+        vector<TfheGateWorkspace *> workspaces;
+        bool quit = false;
+        int32_t command;
+        string payload;
+        while (!quit && receive_message(fd, command, payload)) {
+            istringstream in(payload);
+            ostringstream out;
+            if (command == COMMAND_SETUP && wires == 0) {
+                const int32_t n = get(in);
+                if (n != params->in_out_params->n) {
+                    fail("the coordinator uses other parameters than the cloud key");
+                    put(out, 0);
+                    send_message(fd, COMMAND_REPLY, out.str());
+                    break;
+                }
+                if (!get_plan(in, plan)) {
+                    fail("invalid plan");
+                    break;
+                }
+                wires = new_LweSample_array(plan.netlist.nb_wires, params->in_out_params);
+                int32_t max_width = 1;
+                for (const TfheNetlistLevel &level: plan.netlist.levels)
+                    max_width = max(max_width, level.free_begin - level.begin);
+                for (int32_t t = 0; t < min(nb_threads, max_width); t++)
+                    workspaces.push_back(new TfheGateWorkspace(params));
+                put(out, 1);
+            } else if (command == COMMAND_RUN && wires != 0) {
+                const int32_t level = get(in);
+                if (level < 0 || level >= int32_t(plan.netlist.levels.size())
+                    || get_wires(in, plan.netlist.nb_wires, wires, params) < 0) {
+                    fail("invalid run command");
+                    break;
+                }
+                tfhe_netlist_eval_level(&plan.netlist, level, wires, bk, workspaces);
+                put_wires(out, plan.send[level], wires, params);
+            } else if (command == COMMAND_QUIT) {
+                quit = true;
+                continue;
+            } else {
+                fail("unexpected command " + to_string(command));
+                break;
+            }
+            if (!send_message(fd, COMMAND_REPLY, out.str())) break;
+        }
+        for (TfheGateWorkspace *ws: workspaces) delete ws;
+        if (wires) delete_LweSample_array(plan.netlist.nb_wires, wires);
+        return quit;
+    }
+
+    /**
+     * assigns the gates to the workers. Each bootstrapped gate goes to the worker which computes most
+     * of its inputs, among the workers which have less than their share of the level. A free gate goes
+     * to the worker which computes its input. Then the wires which cross the partition are routed
+     * through the coordinator: sent back by their worker after their level, and forwarded before
+     * the level which reads them.
+     */
+    void partition(TfheDistributedNetlist *distributed) {
+        const TfheNetlist *netlist = distributed->netlist;
+        const int32_t nb_workers = distributed->plans.size();
+        const int32_t nb_levels = netlist->levels.size();
+        const int32_t nb_wires = netlist->nb_wires;
+
+        vector<int32_t> owner(nb_wires, -1);   // -1: the coordinator (inputs and registers)
+        vector<int32_t> wire_level(nb_wires, -1);
+        vector<int32_t> nb_owned_gates(nb_workers, 0);
+        // the gates of each worker, per level
+        vector<vector<vector<int32_t> > > bootstrapped(nb_workers, vector<vector<int32_t> >(nb_levels));
+        vector<vector<vector<int32_t> > > free_gates(nb_workers, vector<vector<int32_t> >(nb_levels));
+        for (int32_t l = 0; l < nb_levels; l++) {
+            const TfheNetlistLevel &level = netlist->levels[l];
+            const int32_t share = (level.free_begin - level.begin + nb_workers - 1) / nb_workers;
+            vector<int32_t> load(nb_workers, 0);
+            for (int32_t g = level.begin; g < level.end; g++) {
+                const TfheNetlistGate &gate = netlist->gates[g];
+                int32_t best = -1;
+                if (g < level.free_begin) {
+                    int32_t best_score = -1;
+                    for (int32_t w = 0; w < nb_workers; w++) {
+                        if (load[w] >= share) continue;
+                        int32_t score = 0;
+                        for (int32_t i = 0; i < 3; i++) if (gate.in[i] >= 0 && owner[gate.in[i]] == w) score++;
+                        if (score > best_score || (score == best_score && load[w] < load[best])) {
+                            best = w;
+                            best_score = score;
+                        }
+                    }
+                    load[best]++;
+                    bootstrapped[best][l].push_back(g);
+                } else {
+                    if (gate.in[0] >= 0) best = owner[gate.in[0]];
+                    if (best < 0) {
+                        best = 0;
+                        for (int32_t w = 1; w < nb_workers; w++) if (nb_owned_gates[w] < nb_owned_gates[best]) best = w;
+                    }
+                    free_gates[best][l].push_back(g);
+                }
+                nb_owned_gates[best]++;
+                owner[gate.out] = best;
+                wire_level[gate.out] = l;
+            }
+        }
+
+        vector<bool> at_coordinator(nb_wires);
+        for (int32_t wire = 0; wire < nb_wires; wire++) at_coordinator[wire] = (owner[wire] < 0);
+        auto send_to_coordinator = [&](int32_t wire) {
+            if (at_coordinator[wire]) return;
+            distributed->plans[owner[wire]].send[wire_level[wire]].push_back(wire);
+            at_coordinator[wire] = true;
+        };
+        for (int32_t w = 0; w < nb_workers; w++) {
+            TfheWorkerPlan &plan = distributed->plans[w];
+            plan.netlist.nb_wires = nb_wires;
+            plan.send.assign(nb_levels, vector<int32_t>());
+            distributed->receive[w].assign(nb_levels, vector<int32_t>());
+        }
+        for (int32_t l = 0; l < nb_levels; l++) {
+            for (int32_t w = 0; w < nb_workers; w++) {
+                TfheNetlist &part = distributed->plans[w].netlist;
+                vector<bool> received(nb_wires, false);
+                TfheNetlistLevel level;
+                level.begin = part.gates.size();
+                level.free_begin = level.begin + bootstrapped[w][l].size();
+                level.end = level.free_begin + free_gates[w][l].size();
+                part.levels.push_back(level);
+                for (const vector<int32_t> *gates: {&bootstrapped[w][l], &free_gates[w][l]}) {
+                    for (int32_t g: *gates) {
+                        const TfheNetlistGate &gate = netlist->gates[g];
+                        part.gates.push_back(gate);
+                        for (int32_t i = 0; i < 3; i++) {
+                            const int32_t wire = gate.in[i];
+                            if (wire < 0 || owner[wire] == w || received[wire]) continue;
+                            send_to_coordinator(wire);
+                            distributed->receive[w][l].push_back(wire);
+                            received[wire] = true;
+                        }
+                    }
+                }
+            }
+        }
+        for (int32_t wire: netlist->outputs) send_to_coordinator(wire);
+        for (const TfheNetlistRegister &reg: netlist->registers) send_to_coordinator(reg.d);
+    }
+
+}
+
+
+TfheDistributedNetlist::TfheDistributedNetlist(const TfheNetlist *netlist, int32_t nb_workers,
+                                               const TFheGateBootstrappingParameterSet *params) :
+        netlist(netlist), params(params), sockets(nb_workers, -1), plans(nb_workers), receive(nb_workers),
+        nb_transfers(0) {
+    wires = new_LweSample_array(netlist->nb_wires, params->in_out_params);
+    partition(this);
+}
+
+TfheDistributedNetlist::~TfheDistributedNetlist() {
+    for (int32_t fd: sockets) {
+        if (fd < 0) continue;
+        send_message(fd, COMMAND_QUIT, string());
+        close(fd);
+    }
+    delete_LweSample_array(netlist->nb_wires, wires);
+}
+
+
+EXPORT int32_t tfhe_worker_listen(const char *address) {
+    return open_socket(address, true);
+}
+
+EXPORT int32_t tfhe_worker_serve(int32_t listen_socket, const TFheGateBootstrappingCloudKeySet *bk,
+                                 int32_t nb_threads, int32_t nb_sessions) {
+    if (nb_threads <= 0) nb_threads = tfhe_get_nb_threads();
+    int32_t nb_normal = 0;
+    for (int32_t session = 0; nb_sessions <= 0 || session < nb_sessions; session++) {
+        const int32_t fd = accept(listen_socket, 0, 0);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            fail(string("accept: ") + strerror(errno));
+            break;
+        }
+        const int32_t one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));   // fails harmlessly on unix sockets
+        if (serve_session(fd, bk, nb_threads)) nb_normal++;
+        close(fd);
+    }
+    return nb_normal;
+}
+
+EXPORT TfheDistributedNetlist *new_TfheDistributedNetlist(const TfheNetlist *netlist, const char *const *workers,
+                                                          int32_t nb_workers,
+                                                          const TFheGateBootstrappingParameterSet *params) {
+    if (nb_workers <= 0) {
+        fail("no workers");
+        return 0;
+    }
+    TfheDistributedNetlist *distributed = new TfheDistributedNetlist(netlist, nb_workers, params);
+    for (int32_t w = 0; w < nb_workers; w++) {
+        distributed->sockets[w] = open_socket(workers[w], false);
+        ostringstream out;
+        put(out, params->in_out_params->n);
+        put_plan(out, distributed->plans[w]);
+        int32_t command;
+        string payload;
+        if (distributed->sockets[w] < 0 || !send_message(distributed->sockets[w], COMMAND_SETUP, out.str())
+            || !receive_message(distributed->sockets[w], command, payload)) {
+            fail(string("cannot set up the worker ") + workers[w]);
+            delete distributed;
+            return 0;
+        }
+        istringstream in(payload);
+        if (command != COMMAND_REPLY || get(in) != 1) {
+            fail(string("the worker ") + workers[w] + " rejected the netlist");
+            delete distributed;
+            return 0;
+        }
+    }
+    return distributed;
+}
+
+EXPORT void delete_TfheDistributedNetlist(TfheDistributedNetlist *distributed) {
+    delete distributed;
+}
+
+EXPORT int32_t tfhe_distributed_eval(TfheDistributedNetlist *distributed, LweSample *outputs,
+                                     const LweSample *inputs, LweSample *state) {
+    const TfheNetlist *netlist = distributed->netlist;
+    const TFheGateBootstrappingParameterSet *params = distributed->params;
+    const LweParams *lwe_params = params->in_out_params;
+    const int32_t nb_workers = distributed->sockets.size();
+    LweSample *wires = distributed->wires;
+
+    for (int32_t i = 0; i < int32_t(netlist->inputs.size()); i++) lweCopy(wires + netlist->inputs[i], inputs + i, lwe_params);
+    for (int32_t i = 0; i < int32_t(netlist->registers.size()); i++)
+        lweCopy(wires + netlist->registers[i].q, state + i, lwe_params);
+    for (int32_t l = 0; l < int32_t(netlist->levels.size()); l++) {
+        // the workers run concurrently: all the requests are sent before the replies are read
+        vector<int32_t> running;
+        for (int32_t w = 0; w < nb_workers; w++) {
+            const TfheNetlistLevel &level = distributed->plans[w].netlist.levels[l];
+            const vector<int32_t> &receive = distributed->receive[w][l];
+            if (level.begin == level.end && receive.empty()) continue;
+            ostringstream out;
+            put(out, l);
+            put_wires(out, receive, wires, params);
+            if (!send_message(distributed->sockets[w], COMMAND_RUN, out.str())) return fail("lost a worker");
+            distributed->nb_transfers += receive.size();
+            running.push_back(w);
+        }
+        for (int32_t w: running) {
+            int32_t command;
+            string payload;
+            if (!receive_message(distributed->sockets[w], command, payload) || command != COMMAND_REPLY)
+                return fail("lost a worker");
+            istringstream in(payload);
+            const int32_t count = get_wires(in, netlist->nb_wires, wires, params);
+            if (count < 0) return fail("invalid reply");
+            distributed->nb_transfers += count;
+        }
+    }
+    for (int32_t i = 0; i < int32_t(netlist->outputs.size()); i++) lweCopy(outputs + i, wires + netlist->outputs[i], lwe_params);
+    for (int32_t i = 0; i < int32_t(netlist->registers.size()); i++)
+        lweCopy(state + i, wires + netlist->registers[i].d, lwe_params);
+    return 1;
+}
+
+EXPORT int64_t tfhe_distributed_nb_transfers(const TfheDistributedNetlist *distributed) {
+    return distributed->nb_transfers;
+}
@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <cassert>
 #include <iostream>
 #include "tfhe.h"
 #include "tfhe_garbage_collector.h"
@@ -70,6 +71,7 @@ EXPORT void delete_gate_bootstrapping_secret_keyset(TFheGateBootstrappingSecretK
     TGswKey *tgsw_key = (TGswKey *) keyset->tgsw_key;
     LweBootstrappingKey *bk = (LweBootstrappingKey *) keyset->cloud.bk;
     LweBootstrappingKeyFFT *bkFFT = (LweBootstrappingKeyFFT *) keyset->cloud.bkFFT;
+    tfhe_numa_release_replicas(&keyset->cloud);
     if (bkFFT) delete_LweBootstrappingKeyFFT(bkFFT);
     if (bk) delete_LweBootstrappingKey(bk);
     delete_TGswKey(tgsw_key);
@@ -81,6 +83,7 @@ EXPORT void delete_gate_bootstrapping_secret_keyset(TFheGateBootstrappingSecretK
 EXPORT void delete_gate_bootstrapping_cloud_keyset(TFheGateBootstrappingCloudKeySet *keyset) {
     LweBootstrappingKey *bk = (LweBootstrappingKey *) keyset->bk;
     LweBootstrappingKeyFFT *bkFFT = (LweBootstrappingKeyFFT *) keyset->bkFFT;
+    tfhe_numa_release_replicas(keyset);
     if (bkFFT) delete_LweBootstrappingKeyFFT(bkFFT);
     if (bk) delete_LweBootstrappingKey(bk);
     delete keyset;
@@ -120,3 +123,72 @@ EXPORT int32_t bootsSymDecrypt(const LweSample *sample, const TFheGateBootstrapp
     Torus32 mu = lwePhase(sample, key->lwe_key);
     return (mu > 0 ? 1 : 0); //we have to do that because of the C binding
 }
+
+// number of ciphertexts processed by each task of the array functions
+static const int32_t BOOTS_ARRAY_CHUNK = 256;
+
+/** encrypts an array of booleans */
+EXPORT void bootsSymEncrypt_array(LweSample *result, const int32_t *messages, int32_t nbelems,
+                                  const TFheGateBootstrappingSecretKeySet *key) {
+    const int32_t nb_chunks = (nbelems + BOOTS_ARRAY_CHUNK - 1) / BOOTS_ARRAY_CHUNK;
+    // one random stream per chunk: the result only depends on the seed, not on the number of threads
+    TfheRandomStreams streams(nb_chunks);
+    tfhe_parallel_for(nb_chunks, [&](int32_t chunk) {
+        streams.use_stream(chunk);
+        const int32_t end = min(nbelems, (chunk + 1) * BOOTS_ARRAY_CHUNK);
+        for (int32_t i = chunk * BOOTS_ARRAY_CHUNK; i < end; i++) bootsSymEncrypt(result + i, messages[i], key);
+    });
+}
+
+/** decrypts an array of booleans */
+EXPORT void bootsSymDecrypt_array(int32_t *result, const LweSample *samples, int32_t nbelems,
+                                  const TFheGateBootstrappingSecretKeySet *key) {
+    const int32_t nb_chunks = (nbelems + BOOTS_ARRAY_CHUNK - 1) / BOOTS_ARRAY_CHUNK;
+    tfhe_parallel_for(nb_chunks, [&](int32_t chunk) {
+        const int32_t end = min(nbelems, (chunk + 1) * BOOTS_ARRAY_CHUNK);
+        for (int32_t i = chunk * BOOTS_ARRAY_CHUNK; i < end; i++) result[i] = bootsSymDecrypt(samples + i, key);
+    });
+}
+
+/** encrypts the nbits lowest bits of message, in little endian order */
+EXPORT void bootsSymEncryptInt(LweSample *result, uint64_t message, int32_t nbits,
+                               const TFheGateBootstrappingSecretKeySet *key) {
+    assert(nbits >= 0 && nbits <= 64);
+    int32_t bits[64];
+    for (int32_t i = 0; i < nbits; i++) bits[i] = (message >> i) & 1;
+    bootsSymEncrypt_array(result, bits, nbits, key);
+}
+
+/** decrypts a nbits integer encrypted in little endian order */
+EXPORT uint64_t bootsSymDecryptInt(const LweSample *samples, int32_t nbits, const TFheGateBootstrappingSecretKeySet *key) {
+    assert(nbits >= 0 && nbits <= 64);
+    int32_t bits[64];
+    bootsSymDecrypt_array(bits, samples, nbits, key);
+    uint64_t result = 0;
+    for (int32_t i = 0; i < nbits; i++) result |= uint64_t(bits[i]) << i;
+    return result;
+}
+
+EXPORT LweToTLweKeySwitchKey *new_gate_bootstrapping_packing_key(const TFheGateBootstrappingSecretKeySet *key,
+                                                                 int32_t ks_t, int32_t ks_basebit) {
+    const TLweParams *tlwe_params = key->params->tgsw_params->tlwe_params;
+    LweToTLweKeySwitchKey *ks = new_LweToTLweKeySwitchKey(key->params->in_out_params->n, ks_t, ks_basebit, tlwe_params);
+    tLweCreateKeySwitchKey(ks, key->lwe_key, &key->tgsw_key->tlwe_key);
+    return ks;
+}
+
+/** packs the ciphertexts: the coefficient i of the phase of the result is the phase of samples[i] */
+EXPORT void bootsPack(TLweSample *result, const LweSample *samples, int32_t nbelems, const LweToTLweKeySwitchKey *ks) {
+    assert(nbelems >= 0 && nbelems <= ks->out_params->N);
+    tLwePackingKeySwitch(result, ks, samples, nbelems, 0);
+}
+
+EXPORT void bootsSymDecryptPacked(int32_t *result, const TLweSample *packed, int32_t nbelems,
+                                  const TFheGateBootstrappingSecretKeySet *key) {
+    const TLweKey *tlwe_key = &key->tgsw_key->tlwe_key;
+    TorusPolynomial *messages = new_TorusPolynomial(tlwe_key->params->N);
+    // the booleans are +-1/8
+    tLweSymDecrypt(messages, packed, tlwe_key, 8);
+    for (int32_t i = 0; i < nbelems; i++) result[i] = (messages->coefsT[i] > 0 ? 1 : 0);
+    delete_TorusPolynomial(messages);
+}
@@ -0,0 +1,455 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include "tfhe.h"
+#include "tfhe_gate_executor.h"
+
+using namespace std;
+
+
+/*
+ * The bootstrapped gates (but the mux) are all of the form
+ *   result = bootstrap(constant + ca.a + cb.b + cc.c)
+ * with constant in {0,+-1/8,+-1/4} and ca,cb,cc in {0,+-1,+-2} (see boot-gates.cpp)
+ */
+struct TfheGateForm {
+    int32_t constant_num;  ///< constant = constant_num/8
+    int32_t ca;
+    int32_t cb;
+    int32_t cc;            ///< 0 for the binary gates
+};
+
+static const TfheGateForm *gate_form(TfheGateType type) {
+    static const TfheGateForm NAND = {1, -1, -1};
+    static const TfheGateForm OR = {1, 1, 1};
+    static const TfheGateForm AND = {-1, 1, 1};
+    static const TfheGateForm XOR = {2, 2, 2};
+    static const TfheGateForm XNOR = {-2, -2, -2};
+    static const TfheGateForm NOR = {-1, -1, -1};
+    static const TfheGateForm ANDNY = {-1, -1, 1};
+    static const TfheGateForm ANDYN = {-1, 1, -1};
+    static const TfheGateForm ORNY = {1, -1, 1};
+    static const TfheGateForm ORYN = {1, 1, -1};
+    static const TfheGateForm MAJ = {0, 1, 1, 1};
+    static const TfheGateForm XOR3 = {0, -2, -2, -2};
+    switch (type) {
+        case TFHE_GATE_NAND: return &NAND;
+        case TFHE_GATE_OR: return &OR;
+        case TFHE_GATE_AND: return &AND;
+        case TFHE_GATE_XOR: return &XOR;
+        case TFHE_GATE_XNOR: return &XNOR;
+        case TFHE_GATE_NOR: return &NOR;
+        case TFHE_GATE_ANDNY: return &ANDNY;
+        case TFHE_GATE_ANDYN: return &ANDYN;
+        case TFHE_GATE_ORNY: return &ORNY;
+        case TFHE_GATE_ORYN: return &ORYN;
+        case TFHE_GATE_MAJ: return &MAJ;
+        case TFHE_GATE_XOR3: return &XOR3;
+        default: return 0;
+    }
+}
+
+/** result = constant_num/8 + ca.a + cb.b + cc.c */
+static void gate_combination(LweSample *result, const TfheGateForm *form, const LweSample *a, const LweSample *b,
+                             const LweSample *c, const LweParams *params) {
+    lweNoiselessTrivial(result, modSwitchToTorus32(form->constant_num, 8), params);
+    lweAddMulTo(result, form->ca, a, params);
+    lweAddMulTo(result, form->cb, b, params);
+    if (form->cc != 0) lweAddMulTo(result, form->cc, c, params);
+}
+
+EXPORT int32_t tfhe_gate_nb_inputs(TfheGateType type) {
+    switch (type) {
+        case TFHE_GATE_CONSTANT: return 0;
+        case TFHE_GATE_COPY:
+        case TFHE_GATE_NOT: return 1;
+        case TFHE_GATE_MUX:
+        case TFHE_GATE_MAJ:
+        case TFHE_GATE_XOR3: return 3;
+        default: return 2;
+    }
+}
+
+EXPORT int32_t tfhe_gate_nb_bootstraps(TfheGateType type) {
+    switch (type) {
+        case TFHE_GATE_CONSTANT:
+        case TFHE_GATE_COPY:
+        case TFHE_GATE_NOT: return 0;
+        case TFHE_GATE_MUX: return 2;
+        default: return 1;
+    }
+}
+
+EXPORT int32_t tfhe_gate_eval_plain(TfheGateType type, int32_t a, int32_t b, int32_t c, int32_t value) {
+    a = (a != 0);
+    b = (b != 0);
+    c = (c != 0);
+    switch (type) {
+        case TFHE_GATE_CONSTANT: return value != 0;
+        case TFHE_GATE_COPY: return a;
+        case TFHE_GATE_NOT: return 1 - a;
+        case TFHE_GATE_NAND: return 1 - (a & b);
+        case TFHE_GATE_OR: return a | b;
+        case TFHE_GATE_AND: return a & b;
+        case TFHE_GATE_XOR: return a ^ b;
+        case TFHE_GATE_XNOR: return 1 - (a ^ b);
+        case TFHE_GATE_NOR: return 1 - (a | b);
+        case TFHE_GATE_ANDNY: return (1 - a) & b;
+        case TFHE_GATE_ANDYN: return a & (1 - b);
+        case TFHE_GATE_ORNY: return (1 - a) | b;
+        case TFHE_GATE_ORYN: return a | (1 - b);
+        case TFHE_GATE_MUX: return a ? b : c;
+        case TFHE_GATE_MAJ: return (a + b + c) >= 2;
+        case TFHE_GATE_XOR3: return a ^ b ^ c;
+        default: abort();
+    }
+}
+
+
+TfheGateWorkspace::TfheGateWorkspace(const TFheGateBootstrappingParameterSet *params) {
+    const LweParams *extracted_params = &params->tgsw_params->tlwe_params->extracted_lweparams;
+    temp = new_LweSample(params->in_out_params);
+    u1 = new_LweSample(extracted_params);
+    u2 = new_LweSample(extracted_params);
+    sum = new_LweSample(extracted_params);
+    bootstrap = new_TfheBootstrapWorkspace(params->tgsw_params, params->in_out_params->n);
+}
+
+TfheGateWorkspace::~TfheGateWorkspace() {
+    delete_TfheBootstrapWorkspace(bootstrap);
+    delete_LweSample(sum);
+    delete_LweSample(u2);
+    delete_LweSample(u1);
+    delete_LweSample(temp);
+}
+
+void tfhe_execute_gate_woKS(LweSample *result, TfheGateType type, const LweSample *a, const LweSample *b,
+                            const LweSample *c, const TFheGateBootstrappingCloudKeySet *bk, TfheGateWorkspace &ws) {
+    static const Torus32 MU = modSwitchToTorus32(1, 8);
+    const LweParams *in_out_params = bk->params->in_out_params;
+    const LweParams *extracted_params = &bk->params->tgsw_params->tlwe_params->extracted_lweparams;
+
+    if (type == TFHE_GATE_MUX) {
+        //a?b:c = AND(a,b) + AND(not(a),c), with a single keyswitch
+        static const TfheGateForm AND_A = {-1, 1, 1};
+        static const TfheGateForm AND_NOT_A = {-1, -1, 1};
+        gate_combination(ws.temp, &AND_A, a, b, 0, in_out_params);
+        tfhe_bootstrap_woKS_FFT(ws.u1, bk->bkFFT, MU, ws.temp, *ws.bootstrap);
+        gate_combination(ws.temp, &AND_NOT_A, a, c, 0, in_out_params);
+        tfhe_bootstrap_woKS_FFT(ws.u2, bk->bkFFT, MU, ws.temp, *ws.bootstrap);
+        lweNoiselessTrivial(result, MU, extracted_params);
+        lweAddTo(result, ws.u1, extracted_params);
+        lweAddTo(result, ws.u2, extracted_params);
+        return;
+    }
+    const TfheGateForm *form = gate_form(type);
+    if (form == 0) abort();
+    gate_combination(ws.temp, form, a, b, c, in_out_params);
+    tfhe_bootstrap_woKS_FFT(result, bk->bkFFT, MU, ws.temp, *ws.bootstrap);
+}
+
+void tfhe_execute_gate(LweSample *result, TfheGateType type, const LweSample *a, const LweSample *b,
+                       const LweSample *c, int32_t value, const TFheGateBootstrappingCloudKeySet *bk,
+                       TfheGateWorkspace &ws) {
+    static const Torus32 MU = modSwitchToTorus32(1, 8);
+    const LweParams *in_out_params = bk->params->in_out_params;
+
+    switch (type) {
+        case TFHE_GATE_CONSTANT:
+            lweNoiselessTrivial(result, value ? MU : -MU, in_out_params);
+            return;
+        case TFHE_GATE_COPY:
+            lweCopy(result, a, in_out_params);
+            return;
+        case TFHE_GATE_NOT:
+            lweNegate(result, a, in_out_params);
+            return;
+        default:
+            tfhe_execute_gate_woKS(ws.sum, type, a, b, c, bk, ws);
+            lweKeySwitch(result, bk->bkFFT->ks, ws.sum);
+            return;
+    }
+}
+
+EXPORT void bootsGATE(LweSample *result, TfheGateType type, const LweSample *a, const LweSample *b, const LweSample *c,
+                      int32_t value, const TFheGateBootstrappingCloudKeySet *bk) {
+    TfheGateWorkspace ws(bk->params);
+    tfhe_execute_gate(result, type, a, b, c, value, bk, ws);
+}
+
+/** the state of one lane of bootsGATE_pipelined */
+struct TfhePipelineLane {
+    static const int32_t NB_BUFFERS = 4;
+
+    TfheGateWorkspace ws;
+    LweSample *buffers;                            ///< the extracted samples waiting for their keyswitch
+    TfheSpscQueue<pair<int32_t, int32_t> > ready;  ///< (gate, buffer) to keyswitch, gate -1 at the end
+    TfheSpscQueue<int32_t> free_buffers;
+
+    TfhePipelineLane(const TFheGateBootstrappingParameterSet *params) :
+            ws(params), ready(NB_BUFFERS + 1), free_buffers(NB_BUFFERS) {
+        buffers = new_LweSample_array(NB_BUFFERS, &params->tgsw_params->tlwe_params->extracted_lweparams);
+        for (int32_t i = 0; i < NB_BUFFERS; i++) free_buffers.push(i);
+    }
+
+    ~TfhePipelineLane() {
+        delete_LweSample_array(NB_BUFFERS, buffers);
+    }
+};
+
+EXPORT void bootsGATE_pipelined(LweSample *results, const TfheGateType *types, const LweSample *a,
+                                const LweSample *b, const LweSample *c, const int32_t *values, int32_t nb_gates,
+                                const TFheGateBootstrappingCloudKeySet *bk, int32_t nb_lanes) {
+    if (nb_lanes <= 0) nb_lanes = max(1, tfhe_get_nb_threads() / 2);
+    vector<TfhePipelineLane *> lanes;
+    for (int32_t l = 0; l < nb_lanes; l++) lanes.push_back(new TfhePipelineLane(bk->params));
+
+    // first stage: the lanes share the gates dynamically
+    atomic<int32_t> next_gate(0);
+    auto blind_rotate = [&](int32_t l) {
+        TfhePipelineLane *lane = lanes[l];
+        TfheNumaBinding binding(l, nb_lanes);
+        const TFheGateBootstrappingCloudKeySet *key = tfhe_numa_local_cloud_key(bk);
+        for (int32_t g = next_gate++; g < nb_gates; g = next_gate++) {
+            const LweSample *ag = a ? a + g : 0;
+            const LweSample *bg = b ? b + g : 0;
+            const LweSample *cg = c ? c + g : 0;
+            if (tfhe_gate_nb_bootstraps(types[g]) == 0) {
+                tfhe_execute_gate(results + g, types[g], ag, bg, cg, values ? values[g] : 0, key, lane->ws);
+                continue;
+            }
+            const int32_t buffer = lane->free_buffers.pop();
+            tfhe_execute_gate_woKS(lane->buffers + buffer, types[g], ag, bg, cg, key, lane->ws);
+            lane->ready.push(make_pair(g, buffer));
+        }
+        lane->ready.push(make_pair(-1, -1));
+    };
+    // second stage
+    auto keyswitch = [&](int32_t l) {
+        TfhePipelineLane *lane = lanes[l];
+        TfheNumaBinding binding(l, nb_lanes);
+        const TFheGateBootstrappingCloudKeySet *key = tfhe_numa_local_cloud_key(bk);
+        for (pair<int32_t, int32_t> item = lane->ready.pop(); item.first >= 0; item = lane->ready.pop()) {
+            lweKeySwitch(results + item.first, key->bkFFT->ks, lane->buffers + item.second);
+            lane->free_buffers.push(item.second);
+        }
+    };
+
+    // dedicated threads, since both stages of a lane must run concurrently
+    vector<thread> threads;
+    for (int32_t l = 0; l < nb_lanes; l++) threads.push_back(thread(keyswitch, l));
+    for (int32_t l = 1; l < nb_lanes; l++) threads.push_back(thread(blind_rotate, l));
+    blind_rotate(0);
+    for (thread &th: threads) th.join();
+    for (TfhePipelineLane *lane: lanes) delete lane;
+}
+
+
+double tfhe_steady_time() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TfheGateExecutor::TfheGateExecutor(const TFheGateBootstrappingCloudKeySet *bk) :
+        bk(bk), policy(TFHE_SCHEDULE_CRITICAL_PATH), record_times(false) {}
+
+TfheGateExecutor::~TfheGateExecutor() {
+    for (TfheGateWorkspace *ws: workspaces) delete ws;
+}
+
+void TfheGateExecutor::add_dependency(int32_t from, int32_t to) {
+    if (from < 0 || from == to) return;
+    vector<int32_t> &succ = gates[from].successors;
+    if (!succ.empty() && succ.back() == to) return;
+    succ.push_back(to);
+    gates[to].nb_predecessors++;
+}
+
+int32_t TfheGateExecutor::add_gate(TfheGateType type, LweSample *result, const LweSample *a, const LweSample *b,
+                                   const LweSample *c, int32_t value) {
+    const int32_t id = gates.size();
+    const int32_t nb_inputs = tfhe_gate_nb_inputs(type);
+    TfheGateNode node;
+    node.type = type;
+    node.result = result;
+    node.in[0] = (nb_inputs > 0) ? a : 0;
+    node.in[1] = (nb_inputs > 1) ? b : 0;
+    node.in[2] = (nb_inputs > 2) ? c : 0;
+    node.value = value;
+    node.nb_predecessors = 0;
+    node.priority = 0;
+    gates.push_back(node);
+
+    // read after write
+    for (int32_t i = 0; i < nb_inputs; i++) {
+        SampleState &state = samples.insert(make_pair(gates[id].in[i], SampleState{-1, {}})).first->second;
+        add_dependency(state.last_writer, id);
+        state.readers.push_back(id);
+    }
+    // write after write, and write after read
+    SampleState &state = samples.insert(make_pair((const LweSample *) result, SampleState{-1, {}})).first->second;
+    add_dependency(state.last_writer, id);
+    for (int32_t reader: state.readers) add_dependency(reader, id);
+    state.last_writer = id;
+    state.readers.clear();
+    return id;
+}
+
+void TfheGateExecutor::clear() {
+    gates.clear();
+    samples.clear();
+}
+
+int32_t TfheGateExecutor::update_priorities() {
+    // the successors of a gate were recorded after it
+    int32_t critical_path = 0;
+    for (int32_t g = int32_t(gates.size()) - 1; g >= 0; g--) {
+        TfheGateNode &node = gates[g];
+        int32_t longest = 0;
+        for (int32_t s: node.successors) longest = max(longest, gates[s].priority);
+        node.priority = tfhe_gate_nb_bootstraps(node.type) + longest;
+        critical_path = max(critical_path, node.priority);
+    }
+    return critical_path;
+}
+
+// the order of the critical path policy: the longest path first, then the oldest gate
+bool TfheGateExecutor::before(int32_t g1, int32_t g2) const {
+    if (gates[g1].priority != gates[g2].priority) return gates[g1].priority > gates[g2].priority;
+    return g1 < g2;
+}
+
+// called with the lock of the queue held
+void TfheGateExecutor::push_ready(ReadyQueue &queue, int32_t g) {
+    queue.gates.push_back(g);
+    if (policy == TFHE_SCHEDULE_CRITICAL_PATH) {
+        push_heap(queue.gates.begin(), queue.gates.end(), [this](int32_t g1, int32_t g2) { return before(g2, g1); });
+    }
+}
+
+// called with the lock of the queue held, on a non-empty queue (steal: the queue of another thread)
+int32_t TfheGateExecutor::pop_ready(ReadyQueue &queue, bool steal) {
+    if (policy == TFHE_SCHEDULE_CRITICAL_PATH) {
+        pop_heap(queue.gates.begin(), queue.gates.end(), [this](int32_t g1, int32_t g2) { return before(g2, g1); });
+        const int32_t g = queue.gates.back();
+        queue.gates.pop_back();
+        return g;
+    }
+    if (policy == TFHE_SCHEDULE_LIFO && !steal) {
+        const int32_t g = queue.gates.back();
+        queue.gates.pop_back();
+        return g;
+    }
+    const int32_t g = queue.gates.front();
+    queue.gates.pop_front();
+    return g;
+}
+
+void TfheGateExecutor::worker(int32_t id, int32_t nb_workers, vector<ReadyQueue> &queues,
+                              vector<atomic<int32_t> > &pending, atomic<int32_t> &nb_done) {
+    const int32_t nb_gates = gates.size();
+    TfheGateWorkspace &ws = *workspaces[id];
+    // the threads of the team are bound to their node once, so the key is the replica of that node
+    const TFheGateBootstrappingCloudKeySet *key = tfhe_numa_local_cloud_key(bk);
+    ReadyQueue &own = queues[id];
+
+    while (nb_done.load() < nb_gates) {
+        int32_t g = -1;
+        // first, the next gate of our queue
+        {
+            lock_guard<mutex> lock(own.lock);
+            if (!own.gates.empty()) g = pop_ready(own, false);
+        }
+        // else, steal the next gate of another queue
+        for (int32_t k = 1; g < 0 && k < nb_workers; k++) {
+            ReadyQueue &victim = queues[(id + k) % nb_workers];
+            lock_guard<mutex> lock(victim.lock);
+            if (!victim.gates.empty()) g = pop_ready(victim, true);
+        }
+        if (g < 0) {
+            this_thread::yield();
+            continue;
+        }
+
+        const TfheGateNode &node = gates[g];
+        if (record_times) start_times[g] = tfhe_steady_time();
+        tfhe_execute_gate(node.result, node.type, node.in[0], node.in[1], node.in[2], node.value, key, ws);
+        if (record_times) end_times[g] = tfhe_steady_time();
+        for (int32_t s: node.successors) {
+            if (--pending[s] == 0) {
+                lock_guard<mutex> lock(own.lock);
+                push_ready(own, s);
+            }
+        }
+        nb_done++;
+    }
+}
+
+void TfheGateExecutor::run(int32_t nb_threads) {
+    const int32_t nb_gates = gates.size();
+    if (nb_threads <= 0) nb_threads = tfhe_get_nb_threads();
+    if (nb_threads > nb_gates) nb_threads = nb_gates;
+    if (nb_threads < 1) return;
+
+    while (int32_t(workspaces.size()) < nb_threads) workspaces.push_back(new TfheGateWorkspace(bk->params));
+    update_priorities();
+    if (record_times) {
+        start_times.assign(nb_gates, 0);
+        end_times.assign(nb_gates, 0);
+    }
+
+    // the first gates are dealt to the threads in the order of the policy
+    vector<ReadyQueue> queues(nb_threads);
+    vector<atomic<int32_t> > pending(nb_gates);
+    atomic<int32_t> nb_done(0);
+    vector<int32_t> sources;
+    for (int32_t g = 0; g < nb_gates; g++) {
+        pending[g] = gates[g].nb_predecessors;
+        if (gates[g].nb_predecessors == 0) sources.push_back(g);
+    }
+    if (policy == TFHE_SCHEDULE_CRITICAL_PATH)
+        stable_sort(sources.begin(), sources.end(), [this](int32_t g1, int32_t g2) { return before(g1, g2); });
+    for (int32_t i = 0; i < int32_t(sources.size()); i++) push_ready(queues[i % nb_threads], sources[i]);
+
+    tfhe_parallel_for(nb_threads, [&](int32_t id) {
+        worker(id, nb_threads, queues, pending, nb_done);
+    }, nb_threads);
+}
+
+
+EXPORT TfheGateExecutor *new_TfheGateExecutor(const TFheGateBootstrappingCloudKeySet *bk) {
+    return new TfheGateExecutor(bk);
+}
+
+EXPORT void delete_TfheGateExecutor(TfheGateExecutor *executor) {
+    delete executor;
+}
+
+EXPORT int32_t tfhe_executor_add_gate(TfheGateExecutor *executor, TfheGateType type, LweSample *result,
+                                      const LweSample *a, const LweSample *b, const LweSample *c) {
+    return executor->add_gate(type, result, a, b, c);
+}
+
+EXPORT int32_t tfhe_executor_add_constant(TfheGateExecutor *executor, LweSample *result, int32_t value) {
+    return executor->add_gate(TFHE_GATE_CONSTANT, result, 0, 0, 0, value);
+}
+
+EXPORT int32_t tfhe_executor_nb_gates(const TfheGateExecutor *executor) {
+    return executor->gates.size();
+}
+
+EXPORT void tfhe_executor_run(TfheGateExecutor *executor, int32_t nb_threads) {
+    executor->run(nb_threads);
+}
+
+EXPORT void tfhe_executor_clear(TfheGateExecutor *executor) {
+    executor->clear();
+}
+
+EXPORT void tfhe_executor_set_policy(TfheGateExecutor *executor, TfheSchedulingPolicy policy) {
+    executor->policy = policy;
+}
+
+EXPORT int32_t tfhe_executor_critical_path(TfheGateExecutor *executor) {
+    return executor->update_priorities();
+}
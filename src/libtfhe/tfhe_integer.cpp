@@ -0,0 +1,386 @@
+#include <algorithm>
+#include <vector>
+#include "tfhe.h"
+#include "tfhe_integer.h"
+
+using namespace std;
+
+
+namespace {
+    /** number of temporary samples allocated at once */
+    const int32_t TEMP_BLOCK_SIZE = 1024;
+
+    /** a recorded bit, or NULL for a bit which is known to be 0 */
+    typedef const LweSample *Bit;
+
+    Bit gate(TfheIntegerCircuit &circuit, TfheGateType type, Bit a, Bit b = 0, Bit c = 0) {
+        LweSample *result = circuit.new_temp();
+        circuit.executor.add_gate(type, result, a, b, c);
+        return result;
+    }
+
+    Bit gate_and(TfheIntegerCircuit &circuit, Bit a, Bit b) {
+        if (a == 0 || b == 0) return 0;
+        return gate(circuit, TFHE_GATE_AND, a, b);
+    }
+
+    Bit gate_xor(TfheIntegerCircuit &circuit, Bit a, Bit b) {
+        if (a == 0) return b;
+        if (b == 0) return a;
+        return gate(circuit, TFHE_GATE_XOR, a, b);
+    }
+
+    Bit gate_xor3(TfheIntegerCircuit &circuit, Bit a, Bit b, Bit c) {
+        if (a == 0) return gate_xor(circuit, b, c);
+        if (b == 0) return gate_xor(circuit, a, c);
+        if (c == 0) return gate_xor(circuit, a, b);
+        return gate(circuit, TFHE_GATE_XOR3, a, b, c);
+    }
+
+    Bit gate_maj(TfheIntegerCircuit &circuit, Bit a, Bit b, Bit c) {
+        if (a == 0) return gate_and(circuit, b, c);
+        if (b == 0) return gate_and(circuit, a, c);
+        if (c == 0) return gate_and(circuit, a, b);
+        return gate(circuit, TFHE_GATE_MAJ, a, b, c);
+    }
+
+    /** s?a:b (s is not 0) */
+    Bit gate_mux(TfheIntegerCircuit &circuit, Bit s, Bit a, Bit b) {
+        if (a == b) return a;
+        if (a == 0) return gate(circuit, TFHE_GATE_ANDNY, s, b);
+        if (b == 0) return gate(circuit, TFHE_GATE_AND, s, a);
+        return gate(circuit, TFHE_GATE_MUX, s, a, b);
+    }
+
+    vector<Bit> bits_of(const LweSample *a, int32_t n) {
+        vector<Bit> result(n);
+        for (int32_t i = 0; i < n; i++) result[i] = a + i;
+        return result;
+    }
+
+    /** copies the bits to the result, once all the gates which read the inputs are recorded */
+    void write_bits(TfheIntegerCircuit &circuit, LweSample *result, const vector<Bit> &bits) {
+        for (size_t i = 0; i < bits.size(); i++) {
+            if (bits[i] == 0) circuit.executor.add_gate(TFHE_GATE_CONSTANT, result + i, 0, 0, 0, 0);
+            else circuit.executor.add_gate(TFHE_GATE_COPY, result + i, bits[i], 0, 0);
+        }
+    }
+
+    /*
+     * a - b is computed as a + not(b) + 1: the negations are folded in the gates of the first bit,
+     * and in the generate (ANDYN) and propagate (XNOR) signals of the prefix adder
+     */
+
+    /** a chain of full adders: sum = xor3(a,b,carry), carry = maj(a,b,carry) */
+    vector<Bit> ripple_add(TfheIntegerCircuit &circuit, Bit *carry_out, const vector<Bit> &a, const vector<Bit> &b,
+                           bool subtract) {
+        const int32_t n = a.size();
+        vector<Bit> sum(n);
+        Bit carry = 0;
+        for (int32_t i = 0; i < n; i++) {
+            const bool need_carry = i < n - 1 || carry_out != 0;
+            if (subtract && i == 0) {
+                sum[0] = gate(circuit, TFHE_GATE_XOR, a[0], b[0]);
+                if (need_carry) carry = gate(circuit, TFHE_GATE_ORYN, a[0], b[0]);
+                continue;
+            }
+            const Bit bi = subtract ? gate(circuit, TFHE_GATE_NOT, b[i]) : b[i];
+            sum[i] = gate_xor3(circuit, a[i], bi, carry);
+            if (need_carry) carry = gate_maj(circuit, a[i], bi, carry);
+        }
+        if (carry_out != 0) *carry_out = carry;
+        return sum;
+    }
+
+    /**
+     * Sklansky parallel prefix adder: the group generate and transmit (G <= T) signals are combined by
+     * blocks of 2, 4, 8... bits, so the carries are known after log2(n) levels. Since Ghi implies Thi,
+     * G = Ghi or (Thi and Glo) and T = Ghi or (Thi and Tlo) are single majority gates.
+     */
+    vector<Bit> prefix_add(TfheIntegerCircuit &circuit, Bit *carry_out, const vector<Bit> &a, const vector<Bit> &b,
+                           bool subtract) {
+        const int32_t n = a.size();
+        vector<Bit> p(n), g(n), t(n);
+        for (int32_t i = 0; i < n; i++) {
+            if (subtract) {
+                // sum[0] does not add the propagate signal of the first bit to a carry
+                if (i > 0) p[i] = gate(circuit, TFHE_GATE_XNOR, a[i], b[i]);
+                t[i] = gate(circuit, TFHE_GATE_ORYN, a[i], b[i]);
+                // the carry in of the subtraction is generated by the first bit
+                g[i] = (i == 0) ? t[0] : gate(circuit, TFHE_GATE_ANDYN, a[i], b[i]);
+            } else {
+                p[i] = gate_xor(circuit, a[i], b[i]);
+                g[i] = gate_and(circuit, a[i], b[i]);
+                t[i] = (a[i] == 0 || b[i] == 0) ? p[i] : gate(circuit, TFHE_GATE_OR, a[i], b[i]);
+            }
+        }
+
+        // after the level of a span, G[i] and T[i] are the signals of the bits i & ~(2span-1) to i
+        vector<Bit> G(g), T(t);
+        for (int32_t span = 1; span < n; span *= 2) {
+            for (int32_t i = span; i < n; i++) {
+                if ((i & span) == 0) continue;
+                if (i == n - 1 && carry_out == 0) continue;
+                const int32_t j = (i & ~(2 * span - 1)) + span - 1;  // the last bit of the lower half
+                const Bit Gi = gate_maj(circuit, G[i], T[i], G[j]);
+                // the groups which start at bit 0 do not need their transmit signal
+                if (i >= 2 * span) T[i] = gate_maj(circuit, G[i], T[i], T[j]);
+                G[i] = Gi;
+            }
+        }
+
+        vector<Bit> sum(n);
+        sum[0] = subtract ? gate(circuit, TFHE_GATE_XOR, a[0], b[0]) : p[0];
+        for (int32_t i = 1; i < n; i++) sum[i] = gate_xor(circuit, p[i], G[i - 1]);
+        if (carry_out != 0) *carry_out = G[n - 1];
+        return sum;
+    }
+
+    vector<Bit> add_bits(TfheIntegerCircuit &circuit, Bit *carry_out, const vector<Bit> &a, const vector<Bit> &b,
+                         bool subtract, TfheAdderType type) {
+        if (type == TFHE_ADDER_PREFIX) return prefix_add(circuit, carry_out, a, b, subtract);
+        return ripple_add(circuit, carry_out, a, b, subtract);
+    }
+
+    /** and (or or) of the bits from..to-1, by a balanced tree */
+    Bit gate_tree(TfheIntegerCircuit &circuit, TfheGateType type, const vector<Bit> &bits, int32_t from, int32_t to) {
+        if (to - from == 1) return bits[from];
+        const int32_t middle = (from + to) / 2;
+        return gate(circuit, type, gate_tree(circuit, type, bits, from, middle),
+                        gate_tree(circuit, type, bits, middle, to));
+    }
+
+    /**
+     * (a < b, a <= b) on the bits from..to-1, by a balanced tree: the comparison of the high half
+     * decides, unless the high halves are equal. Since lt implies le, lt = lthi or (eqhi and ltlo)
+     * and le = lthi or (eqhi and lelo) are single majority gates with lehi. The msb is the sign bit
+     * if is_signed.
+     */
+    pair<Bit, Bit> compare(TfheIntegerCircuit &circuit, const LweSample *a, const LweSample *b, int32_t from,
+                           int32_t to, int32_t n, bool is_signed, bool need_lt, bool need_le) {
+        if (to - from == 1) {
+            // a negative a is lower than a positive b
+            const bool sign = is_signed && from == n - 1;
+            const Bit lt = need_lt ? gate(circuit, sign ? TFHE_GATE_ANDYN : TFHE_GATE_ANDNY, a + from, b + from) : 0;
+            const Bit le = need_le ? gate(circuit, sign ? TFHE_GATE_ORYN : TFHE_GATE_ORNY, a + from, b + from) : 0;
+            return make_pair(lt, le);
+        }
+        const int32_t middle = (from + to) / 2;
+        const pair<Bit, Bit> low = compare(circuit, a, b, from, middle, n, is_signed, need_lt, need_le);
+        const pair<Bit, Bit> high = compare(circuit, a, b, middle, to, n, is_signed, true, true);
+        const Bit lt = need_lt ? gate_maj(circuit, high.first, high.second, low.first) : 0;
+        const Bit le = need_le ? gate_maj(circuit, high.first, high.second, low.second) : 0;
+        return make_pair(lt, le);
+    }
+
+    /**
+     * a barrel shifter: the stage k shifts by 2^k if shift[k]. The bits of the shift which shift out all
+     * the bits are ored together by a tree beside the stages, for a last stage.
+     */
+    vector<Bit> shift_bits(TfheIntegerCircuit &circuit, const LweSample *a, int32_t n, const LweSample *shift,
+                           int32_t nb_shift_bits, bool left, bool is_signed) {
+        vector<Bit> x = bits_of(a, n);
+        vector<Bit> overflow;
+        for (int32_t k = 0; k < nb_shift_bits; k++) {
+            if (k >= 31 || (1 << k) >= n) {
+                overflow.push_back(shift + k);
+                continue;
+            }
+            const int32_t d = 1 << k;
+            const Bit fill = is_signed ? x[n - 1] : 0;
+            vector<Bit> y(n);
+            for (int32_t i = 0; i < n; i++) {
+                const int32_t from = left ? i - d : i + d;
+                y[i] = gate_mux(circuit, shift + k, (from >= 0 && from < n) ? x[from] : fill, x[i]);
+            }
+            x.swap(y);
+        }
+        if (!overflow.empty()) {
+            const Bit s = gate_tree(circuit, TFHE_GATE_OR, overflow, 0, overflow.size());
+            const Bit fill = is_signed ? x[n - 1] : 0;
+            for (int32_t i = 0; i < n; i++) x[i] = gate_mux(circuit, s, fill, x[i]);
+        }
+        return x;
+    }
+
+    /** the heights of the stages of a Dadda tree: 2, 3, 4, 6, 9, 13... */
+    vector<int32_t> dadda_heights(int32_t max_height) {
+        vector<int32_t> heights(1, 2);
+        while (heights.back() < max_height) heights.push_back(heights.back() * 3 / 2);
+        heights.pop_back();
+        return heights;
+    }
+
+    /**
+     * reduces the columns of the partial products to 2 rows: at each stage, full adders (3 bits to 2)
+     * and half adders (2 bits to 2) reduce the height of the columns to the next Dadda height, with as
+     * few adders as possible. The outputs of a stage are only used by the next stage, so each stage
+     * has a depth of one bootstrap.
+     */
+    void dadda_reduce(TfheIntegerCircuit &circuit, vector<vector<Bit> > &columns) {
+        size_t max_height = 0;
+        for (const vector<Bit> &column: columns) max_height = max(max_height, column.size());
+        const vector<int32_t> heights = dadda_heights(max_height);
+        for (int32_t s = int32_t(heights.size()) - 1; s >= 0; s--) {
+            const int32_t d = heights[s];
+            vector<vector<Bit> > next(columns.size() + 1);
+            for (size_t c = 0; c < columns.size(); c++) {
+                const vector<Bit> &column = columns[c];
+                size_t used = 0;
+                // the height of the column in the next stage: its unused bits, its sums and the carries
+                while (int32_t(column.size() - used + next[c].size()) > d) {
+                    const int32_t excess = column.size() - used + next[c].size() - d;
+                    if (excess >= 2 && column.size() - used >= 3) {
+                        next[c].push_back(gate_xor3(circuit, column[used], column[used + 1], column[used + 2]));
+                        next[c + 1].push_back(gate_maj(circuit, column[used], column[used + 1], column[used + 2]));
+                        used += 3;
+                    } else {
+                        next[c].push_back(gate_xor(circuit, column[used], column[used + 1]));
+                        next[c + 1].push_back(gate_and(circuit, column[used], column[used + 1]));
+                        used += 2;
+                    }
+                }
+                next[c].insert(next[c].end(), column.begin() + used, column.end());
+            }
+            // the carries out of the last column are dropped (the product fits in the columns)
+            next.pop_back();
+            columns.swap(next);
+        }
+    }
+}
+
+
+TfheIntegerCircuit::TfheIntegerCircuit(const TFheGateBootstrappingCloudKeySet *bk) :
+        executor(bk), params(bk->params->in_out_params), nb_used(TEMP_BLOCK_SIZE) {}
+
+TfheIntegerCircuit::~TfheIntegerCircuit() {
+    clear();
+}
+
+LweSample *TfheIntegerCircuit::new_temp() {
+    if (nb_used == TEMP_BLOCK_SIZE) {
+        blocks.push_back(new_LweSample_array(TEMP_BLOCK_SIZE, params));
+        nb_used = 0;
+    }
+    return blocks.back() + nb_used++;
+}
+
+void TfheIntegerCircuit::clear() {
+    executor.clear();
+    for (LweSample *block: blocks) delete_LweSample_array(TEMP_BLOCK_SIZE, block);
+    blocks.clear();
+    nb_used = TEMP_BLOCK_SIZE;
+}
+
+EXPORT TfheIntegerCircuit *new_TfheIntegerCircuit(const TFheGateBootstrappingCloudKeySet *bk) {
+    return new TfheIntegerCircuit(bk);
+}
+
+EXPORT void delete_TfheIntegerCircuit(TfheIntegerCircuit *circuit) {
+    delete circuit;
+}
+
+EXPORT TfheGateExecutor *tfhe_integer_executor(TfheIntegerCircuit *circuit) {
+    return &circuit->executor;
+}
+
+EXPORT void tfhe_integer_run(TfheIntegerCircuit *circuit, int32_t nb_threads) {
+    circuit->executor.run(nb_threads);
+}
+
+EXPORT void tfhe_integer_clear(TfheIntegerCircuit *circuit) {
+    circuit->clear();
+}
+
+EXPORT int32_t tfhe_integer_nb_bootstraps(const TfheIntegerCircuit *circuit) {
+    int32_t result = 0;
+    for (const TfheGateNode &node: circuit->executor.gates) result += tfhe_gate_nb_bootstraps(node.type);
+    return result;
+}
+
+EXPORT int32_t tfhe_integer_depth(TfheIntegerCircuit *circuit) {
+    return circuit->executor.update_priorities();
+}
+
+
+EXPORT void tfhe_integer_add(TfheIntegerCircuit *circuit, LweSample *result, LweSample *carry, const LweSample *a,
+                             const LweSample *b, int32_t n, TfheAdderType type) {
+    Bit carry_bit = 0;
+    const vector<Bit> sum = add_bits(*circuit, carry ? &carry_bit : 0, bits_of(a, n), bits_of(b, n), false, type);
+    write_bits(*circuit, result, sum);
+    if (carry != 0) write_bits(*circuit, carry, vector<Bit>(1, carry_bit));
+}
+
+EXPORT void tfhe_integer_sub(TfheIntegerCircuit *circuit, LweSample *result, LweSample *borrow, const LweSample *a,
+                             const LweSample *b, int32_t n, TfheAdderType type) {
+    Bit carry_bit = 0;
+    const vector<Bit> sum = add_bits(*circuit, borrow ? &carry_bit : 0, bits_of(a, n), bits_of(b, n), true, type);
+    write_bits(*circuit, result, sum);
+    // a + not(b) + 1 carries iff a >= b
+    if (borrow != 0) circuit->executor.add_gate(TFHE_GATE_NOT, borrow, carry_bit, 0, 0);
+}
+
+EXPORT void tfhe_integer_equal(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a,
+                               const LweSample *b, int32_t n) {
+    vector<Bit> equal(n);
+    for (int32_t i = 0; i < n; i++) equal[i] = gate(*circuit, TFHE_GATE_XNOR, a + i, b + i);
+    write_bits(*circuit, result, vector<Bit>(1, gate_tree(*circuit, TFHE_GATE_AND, equal, 0, n)));
+}
+
+EXPORT void tfhe_integer_less_than(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a,
+                                   const LweSample *b, int32_t n, int32_t is_signed) {
+    const Bit lt = compare(*circuit, a, b, 0, n, n, is_signed != 0, true, false).first;
+    write_bits(*circuit, result, vector<Bit>(1, lt));
+}
+
+EXPORT void tfhe_integer_less_equal(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a,
+                                    const LweSample *b, int32_t n, int32_t is_signed) {
+    const Bit le = compare(*circuit, a, b, 0, n, n, is_signed != 0, false, true).second;
+    write_bits(*circuit, result, vector<Bit>(1, le));
+}
+
+EXPORT void tfhe_integer_shift_left(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a, int32_t n,
+                                    const LweSample *shift, int32_t nb_shift_bits) {
+    write_bits(*circuit, result, shift_bits(*circuit, a, n, shift, nb_shift_bits, true, false));
+}
+
+EXPORT void tfhe_integer_shift_right(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a, int32_t n,
+                                     const LweSample *shift, int32_t nb_shift_bits, int32_t is_signed) {
+    write_bits(*circuit, result, shift_bits(*circuit, a, n, shift, nb_shift_bits, false, is_signed != 0));
+}
+
+EXPORT void tfhe_integer_mul(TfheIntegerCircuit *circuit, LweSample *result, const LweSample *a, const LweSample *b,
+                             int32_t n, TfheMultiplierType type) {
+    // the partial product a[j].b[i] has the weight i+j
+    vector<vector<Bit> > rows(n, vector<Bit>(n));
+    for (int32_t i = 0; i < n; i++) {
+        for (int32_t j = 0; j < n; j++) rows[i][j] = gate_and(*circuit, a + j, b + i);
+    }
+
+    vector<Bit> product(2 * n, 0);
+    if (type == TFHE_MULTIPLIER_DADDA) {
+        vector<vector<Bit> > columns(2 * n);
+        for (int32_t i = 0; i < n; i++) {
+            for (int32_t j = 0; j < n; j++) columns[i + j].push_back(rows[i][j]);
+        }
+        dadda_reduce(*circuit, columns);
+        vector<Bit> x(2 * n, 0), y(2 * n, 0);
+        for (int32_t c = 0; c < 2 * n; c++) {
+            if (columns[c].size() > 0) x[c] = columns[c][0];
+            if (columns[c].size() > 1) y[c] = columns[c][1];
+        }
+        product = prefix_add(*circuit, 0, x, y, false);
+    } else {
+        copy(rows[0].begin(), rows[0].end(), product.begin());
+        for (int32_t i = 1; i < n; i++) {
+            // product[i..i+n] = product[i..i+n-1] + row i
+            Bit carry = 0;
+            const vector<Bit> sum = ripple_add(*circuit, &carry, vector<Bit>(product.begin() + i,
+                                                                            product.begin() + i + n),
+                                               rows[i], false);
+            copy(sum.begin(), sum.end(), product.begin() + i);
+            product[i + n] = carry;
+        }
+    }
+    write_bits(*circuit, result, product);
+}
@@ -8,6 +8,7 @@
 #include "tfhe_garbage_collector.h"
 #include "lwe-functions.h"
 #include "lwekeyswitch.h"
+#include "tlwekeyswitch.h"
 #include "tlwe_functions.h"
 #include "tgsw_functions.h"
 #include "polynomials_arithmetic.h"
@@ -752,65 +753,52 @@ void read_lweKeySwitchParameters_section(const Istream &F, LweKeySwitchParameter
 }
 
 /**
- * This function prints the keyswitch coefficients
+ * This function prints the keyswitch coefficients (compact format: the
+ * trivial entries h=0 are not written)
  */
 void write_LweKeySwitchKey_content(const Ostream &F, const LweKeySwitchKey *ks) {
-    const LweParams *out_params = ks->out_params;
     const int32_t N = ks->n;
     const int32_t t = ks->t;
     const int32_t base = ks->base;
-    const int32_t n = out_params->n;
-    double current_variance = -1;
+    const int32_t n = ks->out_params->n;
 
-    //computes the maximum variance
-    for (int32_t i = 0; i < N; i++)
-        for (int32_t j = 0; j < t; j++)
-            for (int32_t k = 0; k < base; k++) {
-                const LweSample &sample = ks->ks[i][j][k];
-                if (sample.current_variance > current_variance)
-                    current_variance = sample.current_variance;
-            }
-    F.fwrite(&LWE_KEYSWITCH_KEY_TYPE_UID, sizeof(int32_t));
+    F.fwrite(&LWE_KEYSWITCH_KEY_COMPACT_TYPE_UID, sizeof(int32_t));
     //write the variance once
-    F.fwrite(&current_variance, sizeof(double));
-    //and dump the coefficients
+    F.fwrite(&ks->current_variance, sizeof(double));
+    //and dump the coefficients (a then b, without the padding)
     for (int32_t i = 0; i < N; i++)
         for (int32_t j = 0; j < t; j++)
-            for (int32_t k = 0; k < base; k++) {
-                const LweSample &sample = ks->ks[i][j][k];
-                //bin output the sample coefs
-                F.fwrite(sample.a, n * sizeof(Torus32));
-                F.fwrite(&sample.b, 1 * sizeof(Torus32));
-            }
+            for (int32_t h = 1; h < base; h++)
+                F.fwrite(ks->entry(i, j, h), (n + 1) * sizeof(Torus32));
 }
 
 /**
  * This function reads the keyswitch coefficients
+ * (both the compact and the legacy format are supported)
  */
 void read_lweKeySwitchKey_content(const Istream &F, LweKeySwitchKey *ks) {
-    const LweParams *out_params = ks->out_params;
     const int32_t N = ks->n;
     const int32_t t = ks->t;
     const int32_t base = ks->base;
-    const int32_t n = out_params->n;
-    double current_variance = -1;
+    const int32_t n = ks->out_params->n;
 
     int32_t type_uid = -1;
     F.fread(&type_uid, sizeof(int32_t));
-    if (type_uid != LWE_KEYSWITCH_KEY_TYPE_UID)
+    if (type_uid != LWE_KEYSWITCH_KEY_COMPACT_TYPE_UID && type_uid != LWE_KEYSWITCH_KEY_TYPE_UID)
         die_dramatically("Trying to read something that is not a LWE Keyswitch!");
+    const bool legacy = (type_uid == LWE_KEYSWITCH_KEY_TYPE_UID);
     //reads the variance only once in the end
-    F.fread(&current_variance, sizeof(double));
+    F.fread(&ks->current_variance, sizeof(double));
     //and read the coefficients
+    Torus32 *trivial = new Torus32[n + 1];
     for (int32_t i = 0; i < N; i++)
-        for (int32_t j = 0; j < t; j++)
-            for (int32_t k = 0; k < base; k++) {
-                LweSample &sample = ks->ks[i][j][k];
-                //bin output the sample coefs
-                F.fread(sample.a, n * sizeof(Torus32));
-                F.fread(&sample.b, 1 * sizeof(Torus32));
-                sample.current_variance = current_variance;
-            }
+        for (int32_t j = 0; j < t; j++) {
+            //the legacy format contains the trivial term h=0: skip it
+            if (legacy) F.fread(trivial, (n + 1) * sizeof(Torus32));
+            for (int32_t h = 1; h < base; h++)
+                F.fread(ks->entry(i, j, h), (n + 1) * sizeof(Torus32));
+        }
+    delete[] trivial;
 }
 
 /**
@@ -872,6 +860,113 @@ EXPORT LweKeySwitchKey *new_lweKeySwitchKey_fromStream(std::istream &F) {
 
 #endif
 
+/* ****************************
+ * Lwe to TLwe Keyswitch key
+ **************************** */
+
+/**
+ * This function prints the parameters section of a lwe to tlwe keyswitch key
+ */
+void write_LweToTLweKeySwitchParameters_section(const Ostream &F, const LweToTLweKeySwitchKey *ks) {
+    TextModeProperties *props = new_TextModeProperties_blank();
+    props->setTypeTitle("TLWEKSPARAMS");
+    props->setProperty_int64_t("n", ks->n);
+    props->setProperty_int64_t("t", ks->t);
+    props->setProperty_int64_t("basebit", ks->basebit);
+    print_TextModeProperties_toOStream(F, props);
+    delete_TextModeProperties(props);
+}
+
+void read_lweToTLweKeySwitchParameters_section(const Istream &F, LweKeySwitchParameters *reps) {
+    TextModeProperties *props = new_TextModeProperties_fromIstream(F);
+    if (props->getTypeTitle() != string("TLWEKSPARAMS")) abort();
+    reps->n = props->getProperty_int64_t("n");
+    reps->t = props->getProperty_int64_t("t");
+    reps->basebit = props->getProperty_int64_t("basebit");
+    delete_TextModeProperties(props);
+}
+
+/**
+ * This function prints the (n+1).t entries of a lwe to tlwe keyswitch key
+ */
+void write_LweToTLweKeySwitchKey_content(const Ostream &F, const LweToTLweKeySwitchKey *ks) {
+    const int32_t N = ks->out_params->N;
+    const int32_t k = ks->out_params->k;
+
+    F.fwrite(&LWE_TO_TLWE_KEYSWITCH_KEY_TYPE_UID, sizeof(int32_t));
+    //write the variance once
+    F.fwrite(&ks->current_variance, sizeof(double));
+    for (int32_t i = 0; i <= ks->n; i++)
+        for (int32_t j = 0; j < ks->t; j++)
+            for (int32_t u = 0; u <= k; u++)
+                F.fwrite(ks->entry(i, j)->a[u].coefsT, N * sizeof(Torus32));
+}
+
+void read_lweToTLweKeySwitchKey_content(const Istream &F, LweToTLweKeySwitchKey *ks) {
+    const int32_t N = ks->out_params->N;
+    const int32_t k = ks->out_params->k;
+
+    int32_t type_uid = -1;
+    F.fread(&type_uid, sizeof(int32_t));
+    if (type_uid != LWE_TO_TLWE_KEYSWITCH_KEY_TYPE_UID)
+        die_dramatically("Trying to read something that is not a LWE to TLWE Keyswitch!");
+    F.fread(&ks->current_variance, sizeof(double));
+    for (int32_t i = 0; i <= ks->n; i++)
+        for (int32_t j = 0; j < ks->t; j++) {
+            TLweSample *entry = ks->entry(i, j);
+            for (int32_t u = 0; u <= k; u++)
+                F.fread(entry->a[u].coefsT, N * sizeof(Torus32));
+            entry->current_variance = ks->current_variance;
+        }
+}
+
+void write_lweToTLweKeySwitchKey(const Ostream &F, const LweToTLweKeySwitchKey *ks) {
+    write_tLweParams(F, ks->out_params);
+    write_LweToTLweKeySwitchParameters_section(F, ks);
+    write_LweToTLweKeySwitchKey_content(F, ks);
+}
+
+LweToTLweKeySwitchKey *read_new_lweToTLweKeySwitchKey(const Istream &F) {
+    TLweParams *out_params = read_new_tLweParams(F);
+    TfheGarbageCollector::register_param(out_params);
+    LweKeySwitchParameters ksparams;
+    read_lweToTLweKeySwitchParameters_section(F, &ksparams);
+    LweToTLweKeySwitchKey *reps = new_LweToTLweKeySwitchKey(ksparams.n, ksparams.t, ksparams.basebit, out_params);
+    read_lweToTLweKeySwitchKey_content(F, reps);
+    return reps;
+}
+
+
+/**
+ * This function exports a lwe to tlwe keyswitch key (in binary) to a file
+ */
+EXPORT void export_lweToTLweKeySwitchKey_toFile(FILE *F, const LweToTLweKeySwitchKey *ks) {
+    write_lweToTLweKeySwitchKey(to_Ostream(F), ks);
+}
+
+/**
+ * This constructor function reads and creates a LweToTLweKeySwitchKey from a File. The result
+ * must be deleted with delete_LweToTLweKeySwitchKey();
+ */
+EXPORT LweToTLweKeySwitchKey *new_lweToTLweKeySwitchKey_fromFile(FILE *F) {
+    return read_new_lweToTLweKeySwitchKey(to_Istream(F));
+}
+
+/**
+ * This function exports a lwe to tlwe keyswitch key (in binary) to a stream
+ */
+EXPORT void export_lweToTLweKeySwitchKey_toStream(std::ostream &F, const LweToTLweKeySwitchKey *ks) {
+    write_lweToTLweKeySwitchKey(to_Ostream(F), ks);
+}
+
+/**
+ * This constructor function reads and creates a LweToTLweKeySwitchKey from a stream. The result
+ * must be deleted with delete_LweToTLweKeySwitchKey();
+ */
+EXPORT LweToTLweKeySwitchKey *new_lweToTLweKeySwitchKey_fromStream(std::istream &F) {
+    return read_new_lweToTLweKeySwitchKey(to_Istream(F));
+}
+
 /* ****************************
  * Lwe Bootstrapping key
  **************************** */
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cmath>
+#include "tfhe.h"
+
+using namespace std;
+
+
+namespace {
+    const Torus32 MU = modSwitchToTorus32(1, 8);
+    const Torus32 QUARTER = modSwitchToTorus32(1, 4);
+
+    /** result = bootstrap(x - 1/4) with the message mu: +mu if the bit of x is 1, else -mu */
+    void bootstrap_leveled(LweSample *result, Torus32 mu, const LweSample *x,
+                           const TFheGateBootstrappingCloudKeySet *bk, TfheGateWorkspace &ws) {
+        const LweParams *in_out_params = bk->params->in_out_params;
+        lweCopy(ws.temp, x, in_out_params);
+        ws.temp->b -= QUARTER;
+        tfhe_bootstrap_woKS_FFT(ws.sum, bk->bkFFT, mu, ws.temp, *ws.bootstrap);
+        lweKeySwitch(result, bk->bkFFT->ks, ws.sum);
+        result->current_variance = bootsBootstrapVariance(bk->params);
+    }
+
+    /** same as bootsLeveledRefresh, using the given workspace */
+    void refresh_leveled(LweSample *result, const LweSample *x, const TFheGateBootstrappingCloudKeySet *bk,
+                         TfheGateWorkspace &ws) {
+        // +-1/4 -> 1/4 +- 1/4
+        bootstrap_leveled(result, QUARTER, x, bk, ws);
+        result->b += QUARTER;
+    }
+}
+
+
+EXPORT double bootsBootstrapVariance(const TFheGateBootstrappingParameterSet *params) {
+    const LweParams *in_out_params = params->in_out_params;
+    const TGswParams *bk_params = params->tgsw_params;
+    const TLweParams *accum_params = bk_params->tlwe_params;
+    const int32_t n = in_out_params->n;
+    const int32_t N = accum_params->N;
+    const int32_t k = accum_params->k;
+    const int32_t l = bk_params->l;
+    const double bk_variance = accum_params->alpha_min * accum_params->alpha_min;
+    const double ks_variance = in_out_params->alpha_min * in_out_params->alpha_min;
+
+    // each external product adds the noise of the (k+1)l rows times the digits (<= Bg/2), and the
+    // error of the decomposition times the kN coefficients of the key: the decomposition truncates to
+    // the multiples of 1/Bg^l, so its error is in [0, 1/Bg^l) and its mean adds up over the key
+    const double epsilon = pow(2., -bk_params->Bgbit * l);
+    const double blind_rotation = n * ((k + 1) * l * N * double(bk_params->halfBg) * bk_params->halfBg * bk_variance
+                                       + k * N * epsilon * k * N * epsilon / 48.);
+    // the keyswitch adds t rows per extracted coefficient, and its precision 1/2^(t.basebit+1)
+    const double ks_epsilon = pow(2., -params->ks_t * params->ks_basebit - 1);
+    const double keyswitch = k * N * (params->ks_t * ks_variance + ks_epsilon * ks_epsilon);
+    return blind_rotation + keyswitch;
+}
+
+EXPORT double bootsRoundingVariance(const TFheGateBootstrappingParameterSet *params) {
+    // the n+1 coefficients are rounded to 1/2N: uniform errors of variance (1/2N)^2/12
+    const double N = params->tgsw_params->tlwe_params->N;
+    return (params->in_out_params->n + 1) / (48. * N * N);
+}
+
+EXPORT double bootsLeveledMaxVariance(const TFheGateBootstrappingParameterSet *params) {
+    const double alpha_max = params->in_out_params->alpha_max;
+    return 4. * alpha_max * alpha_max - bootsRoundingVariance(params);
+}
+
+EXPORT void bootsLeveledSymEncrypt(LweSample *result, int32_t message, const TFheGateBootstrappingSecretKeySet *key) {
+    const double alpha = key->params->in_out_params->alpha_min;
+    lweSymEncrypt(result, message ? modSwitchToTorus32(1, 2) : 0, alpha, key->lwe_key);
+}
+
+EXPORT int32_t bootsLeveledSymDecrypt(const LweSample *sample, const TFheGateBootstrappingSecretKeySet *key) {
+    const Torus32 phase = lwePhase(sample, key->lwe_key);
+    // the bit is 1 iff the phase is closer to 1/2 than to 0
+    return (phase > QUARTER || phase < -QUARTER) ? 1 : 0;
+}
+
+EXPORT void bootsLeveledFromGate(LweSample *result, const LweSample *x, const TFheGateBootstrappingCloudKeySet *bk) {
+    const LweParams *in_out_params = bk->params->in_out_params;
+    const double variance = max(x->current_variance, bootsBootstrapVariance(bk->params));
+    // +-1/8 -> 1/4 +- 1/4, in place: result may be x
+    lweCopy(result, x, in_out_params);
+    lweAddTo(result, result, in_out_params);
+    result->b += QUARTER;
+    result->current_variance = 4. * variance;
+}
+
+EXPORT void bootsLeveledToGate(LweSample *result, const LweSample *x, const TFheGateBootstrappingCloudKeySet *bk) {
+    TfheGateWorkspace ws(bk->params);
+    bootstrap_leveled(result, MU, x, bk, ws);
+}
+
+EXPORT void bootsLeveledRefresh(LweSample *result, const LweSample *x, const TFheGateBootstrappingCloudKeySet *bk) {
+    TfheGateWorkspace ws(bk->params);
+    refresh_leveled(result, x, bk, ws);
+}
+
+EXPORT void bootsLeveledNOT(LweSample *result, const LweSample *x, const TFheGateBootstrappingCloudKeySet *bk) {
+    const LweParams *in_out_params = bk->params->in_out_params;
+    lweCopy(result, x, in_out_params);
+    result->b += modSwitchToTorus32(1, 2);
+}
+
+EXPORT int32_t bootsLeveledXOR(LweSample *result, const LweSample *a, const LweSample *b,
+                               const TFheGateBootstrappingCloudKeySet *bk) {
+    const LweParams *in_out_params = bk->params->in_out_params;
+    const double max_variance = bootsLeveledMaxVariance(bk->params);
+    LweSample *x = new_LweSample(in_out_params);
+    LweSample *y = new_LweSample(in_out_params);
+    // x is the noisiest input
+    if (a->current_variance < b->current_variance) swap(a, b);
+    lweCopy(x, a, in_out_params);
+    lweCopy(y, b, in_out_params);
+
+    int32_t nb_bootstraps = 0;
+    TfheGateWorkspace ws(bk->params);
+    if (x->current_variance + y->current_variance > max_variance) {
+        refresh_leveled(x, x, bk, ws);
+        nb_bootstraps++;
+    }
+    if (x->current_variance + y->current_variance > max_variance) {
+        refresh_leveled(y, y, bk, ws);
+        nb_bootstraps++;
+    }
+    lweCopy(result, x, in_out_params);
+    lweAddTo(result, y, in_out_params);
+
+    delete_LweSample(y);
+    delete_LweSample(x);
+    return nb_bootstraps;
+}
+
+EXPORT int32_t bootsLeveledParity(LweSample *result, const LweSample *samples, int32_t nb_samples,
+                                  const TFheGateBootstrappingCloudKeySet *bk) {
+    const LweParams *in_out_params = bk->params->in_out_params;
+    const double max_variance = bootsLeveledMaxVariance(bk->params);
+    LweSample *sum = new_LweSample(in_out_params);
+    LweSample *temp = new_LweSample(in_out_params);
+
+    int32_t nb_bootstraps = 0;
+    TfheGateWorkspace ws(bk->params);
+    lweCopy(sum, samples, in_out_params);
+    for (int32_t i = 1; i < nb_samples; i++) {
+        const LweSample *x = samples + i;
+        if (sum->current_variance + x->current_variance > max_variance) {
+            refresh_leveled(sum, sum, bk, ws);
+            nb_bootstraps++;
+        }
+        if (sum->current_variance + x->current_variance > max_variance) {
+            refresh_leveled(temp, x, bk, ws);
+            x = temp;
+            nb_bootstraps++;
+        }
+        lweAddTo(sum, x, in_out_params);
+    }
+    lweCopy(result, sum, in_out_params);
+
+    delete_LweSample(temp);
+    delete_LweSample(sum);
+    return nb_bootstraps;
+}
@@ -0,0 +1,1001 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include "tfhe.h"
+#include "tfhe_netlist.h"
+
+using namespace std;
+
+
+namespace {
+
+    /** the largest number of inputs of a .names cover */
+    const int32_t MAX_FUNCTION_INPUTS = 16;
+
+    /** value of the bit j of the input assignment m */
+    inline int32_t bit(int32_t m, int32_t j) { return (m >> j) & 1; }
+
+    /** the binary gate of a function of exactly 2 inputs (table[m] is its value for a = bit 0 of m, b = bit 1) */
+    TfheGateType binary_gate(const vector<uint8_t> &table) {
+        for (int32_t t = TFHE_GATE_NAND; t < TFHE_GATE_MUX; t++) {
+            bool match = true;
+            for (int32_t m = 0; m < 4 && match; m++)
+                match = table[m] == tfhe_gate_eval_plain(TfheGateType(t), bit(m, 0), bit(m, 1), 0, 0);
+            if (match) return TfheGateType(t);
+        }
+        abort(); // the 10 binary gates cover all the functions of exactly 2 inputs
+    }
+
+    /**
+     * A Yosys internal cell: its inputs, and its boolean function
+     * (the output port is Y)
+     */
+    struct CellType {
+        const char *name;
+        int32_t nb_inputs;
+        const char *inputs[4];
+        int32_t (*function)(int32_t a, int32_t b, int32_t c, int32_t d);
+    };
+
+    const CellType CELL_TYPES[] = {
+            {"$_BUF_",    1, {"A"},                [](int32_t a, int32_t, int32_t, int32_t) { return a; }},
+            {"$_NOT_",    1, {"A"},                [](int32_t a, int32_t, int32_t, int32_t) { return 1 - a; }},
+            {"$_AND_",    2, {"A", "B"},           [](int32_t a, int32_t b, int32_t, int32_t) { return a & b; }},
+            {"$_NAND_",   2, {"A", "B"},           [](int32_t a, int32_t b, int32_t, int32_t) { return 1 - (a & b); }},
+            {"$_OR_",     2, {"A", "B"},           [](int32_t a, int32_t b, int32_t, int32_t) { return a | b; }},
+            {"$_NOR_",    2, {"A", "B"},           [](int32_t a, int32_t b, int32_t, int32_t) { return 1 - (a | b); }},
+            {"$_XOR_",    2, {"A", "B"},           [](int32_t a, int32_t b, int32_t, int32_t) { return a ^ b; }},
+            {"$_XNOR_",   2, {"A", "B"},           [](int32_t a, int32_t b, int32_t, int32_t) { return 1 - (a ^ b); }},
+            {"$_ANDNOT_", 2, {"A", "B"},           [](int32_t a, int32_t b, int32_t, int32_t) { return a & (1 - b); }},
+            {"$_ORNOT_",  2, {"A", "B"},           [](int32_t a, int32_t b, int32_t, int32_t) { return a | (1 - b); }},
+            {"$_MUX_",    3, {"A", "B", "S"},      [](int32_t a, int32_t b, int32_t s, int32_t) { return s ? b : a; }},
+            {"$_NMUX_",   3, {"A", "B", "S"},      [](int32_t a, int32_t b, int32_t s, int32_t) { return s ? 1 - b : 1 - a; }},
+            {"$_AOI3_",   3, {"A", "B", "C"},      [](int32_t a, int32_t b, int32_t c, int32_t) { return 1 - ((a & b) | c); }},
+            {"$_OAI3_",   3, {"A", "B", "C"},      [](int32_t a, int32_t b, int32_t c, int32_t) { return 1 - ((a | b) & c); }},
+            {"$_AOI4_",   4, {"A", "B", "C", "D"}, [](int32_t a, int32_t b, int32_t c, int32_t d) { return 1 - ((a & b) | (c & d)); }},
+            {"$_OAI4_",   4, {"A", "B", "C", "D"}, [](int32_t a, int32_t b, int32_t c, int32_t d) { return 1 - ((a | b) & (c | d)); }},
+    };
+
+
+    /**
+     * Builds a netlist wire by wire, and checks that each wire has exactly one driver.
+     * The arbitrary boolean functions are decomposed into the gates of the executor.
+     */
+    class NetlistBuilder {
+    public:
+        string error;
+
+        NetlistBuilder() : netlist(new TfheNetlist()), constant_wires{-1, -1} {}
+
+        ~NetlistBuilder() { delete netlist; }
+
+        NetlistBuilder(const NetlistBuilder &) = delete;
+        void operator=(const NetlistBuilder &) = delete;
+
+        bool failed() const { return !error.empty(); }
+
+        bool fail(const string &message) {
+            if (error.empty()) error = message;
+            return false;
+        }
+
+        /** the wire of a name (created on first use) */
+        int32_t wire(const string &name) {
+            map<string, int32_t>::const_iterator it = wire_ids.find(name);
+            if (it != wire_ids.end()) return it->second;
+            const int32_t id = new_wire(name);
+            wire_ids[name] = id;
+            return id;
+        }
+
+        /** the wire of the constant 0 or 1 */
+        int32_t constant_wire(int32_t value) {
+            int32_t &w = constant_wires[value != 0];
+            if (w < 0) {
+                w = new_wire(value ? "$const1" : "$const0");
+                add_gate(TFHE_GATE_CONSTANT, w, -1, -1, -1, value != 0);
+            }
+            return w;
+        }
+
+        bool add_input(const string &name, int32_t w) {
+            netlist->input_names.push_back(name);
+            netlist->inputs.push_back(w);
+            return drive(w);
+        }
+
+        void add_output(const string &name, int32_t w) {
+            netlist->output_names.push_back(name);
+            netlist->outputs.push_back(w);
+        }
+
+        bool add_register(int32_t d, int32_t q, int32_t init) {
+            netlist->registers.push_back(TfheNetlistRegister{d, q, init});
+            return drive(q);
+        }
+
+        bool add_gate(TfheGateType type, int32_t out, int32_t a, int32_t b, int32_t c, int32_t value = 0) {
+            netlist->gates.push_back(TfheNetlistGate{type, out, {a, b, c}, value});
+            return drive(out);
+        }
+
+        /**
+         * out = f(ins), where table[m] is the value of f when ins[j] = bit j of m.
+         * Unused and repeated inputs are removed, then f is mapped on one gate if possible,
+         * or else decomposed as a mux on its last input.
+         */
+        bool add_function(int32_t out, vector<int32_t> ins, vector<uint8_t> table) {
+            // repeated inputs: keep the assignments where both copies agree
+            for (int32_t j = 1; j < int32_t(ins.size()); j++) {
+                for (int32_t i = 0; i < j; i++) {
+                    if (ins[i] != ins[j]) continue;
+                    vector<uint8_t> restricted;
+                    for (int32_t m = 0; m < int32_t(table.size()); m++)
+                        if (bit(m, i) == bit(m, j)) restricted.push_back(table[m]);
+                    remove_input(ins, table, j, restricted);
+                    j--;
+                    break;
+                }
+            }
+            // unused inputs
+            for (int32_t j = int32_t(ins.size()) - 1; j >= 0; j--) {
+                bool used = false;
+                for (int32_t m = 0; m < int32_t(table.size()) && !used; m++) used = table[m] != table[m ^ (1 << j)];
+                if (used) continue;
+                vector<uint8_t> restricted;
+                for (int32_t m = 0; m < int32_t(table.size()); m++) if (bit(m, j) == 0) restricted.push_back(table[m]);
+                remove_input(ins, table, j, restricted);
+            }
+
+            const int32_t k = ins.size();
+            if (k == 0) return add_gate(TFHE_GATE_CONSTANT, out, -1, -1, -1, table[0]);
+            if (k == 1) return add_gate(table[1] ? TFHE_GATE_COPY : TFHE_GATE_NOT, out, ins[0], -1, -1);
+            if (k == 2) return add_gate(binary_gate(table), out, ins[0], ins[1], -1);
+            if (k == 3) {
+                // s?x:y, for any order of the inputs
+                for (int32_t s = 0; s < 3; s++) {
+                    for (int32_t x = 0; x < 3; x++) {
+                        const int32_t y = 3 - s - x;
+                        if (x == s || y == s || x == y) continue;
+                        bool match = true;
+                        for (int32_t m = 0; m < 8 && match; m++)
+                            match = table[m] == (bit(m, s) ? bit(m, x) : bit(m, y));
+                        if (match) return add_gate(TFHE_GATE_MUX, out, ins[s], ins[x], ins[y]);
+                    }
+                }
+                // the symmetric gates, which take a single bootstrapping
+                for (TfheGateType t: {TFHE_GATE_MAJ, TFHE_GATE_XOR3}) {
+                    bool match = true;
+                    for (int32_t m = 0; m < 8 && match; m++)
+                        match = table[m] == tfhe_gate_eval_plain(t, bit(m, 0), bit(m, 1), bit(m, 2), 0);
+                    if (match) return add_gate(t, out, ins[0], ins[1], ins[2]);
+                }
+            }
+            // Shannon expansion on the last input
+            const int32_t half = 1 << (k - 1);
+            const int32_t w1 = new_wire("");
+            const int32_t w0 = new_wire("");
+            vector<int32_t> sub_ins(ins.begin(), ins.end() - 1);
+            add_function(w1, sub_ins, vector<uint8_t>(table.begin() + half, table.end()));
+            add_function(w0, sub_ins, vector<uint8_t>(table.begin(), table.begin() + half));
+            return add_gate(TFHE_GATE_MUX, out, ins[k - 1], w1, w0);
+        }
+
+        /**
+         * instantiates a Yosys internal cell
+         * @param ports the wire of each port
+         */
+        bool add_cell(const string &type, const map<string, int32_t> &ports) {
+            for (const CellType &cell: CELL_TYPES) {
+                if (type != cell.name) continue;
+                vector<int32_t> ins;
+                for (int32_t j = 0; j < cell.nb_inputs; j++) {
+                    map<string, int32_t>::const_iterator it = ports.find(cell.inputs[j]);
+                    if (it == ports.end()) return fail("cell " + type + " without port " + cell.inputs[j]);
+                    ins.push_back(it->second);
+                }
+                map<string, int32_t>::const_iterator y = ports.find("Y");
+                if (y == ports.end()) return fail("cell " + type + " without port Y");
+                vector<uint8_t> table(1 << cell.nb_inputs);
+                for (int32_t m = 0; m < int32_t(table.size()); m++)
+                    table[m] = cell.function(bit(m, 0), bit(m, 1), bit(m, 2), bit(m, 3));
+                return add_function(y->second, ins, table);
+            }
+            // flip-flops (a single clock domain is assumed, so the clock edge is ignored)
+            if (type == "$_DFF_P_" || type == "$_DFF_N_" || type.compare(0, 7, "$_DFFE_") == 0) {
+                map<string, int32_t>::const_iterator d = ports.find("D");
+                map<string, int32_t>::const_iterator q = ports.find("Q");
+                if (d == ports.end() || q == ports.end()) return fail("cell " + type + " without port D or Q");
+                if (type.compare(0, 7, "$_DFFE_") != 0) return add_register(d->second, q->second, 0);
+
+                // flip-flop with enable: the next value is E?D:Q
+                map<string, int32_t>::const_iterator e = ports.find("E");
+                // $_DFFE_ck_: c is the clock polarity, k the enable polarity
+                const bool polarities = type.size() == 10 && type[9] == '_'
+                                        && (type[7] == 'P' || type[7] == 'N') && (type[8] == 'P' || type[8] == 'N');
+                if (!polarities || e == ports.end()) return fail("unsupported cell " + type);
+                const int32_t enable_value = (type[8] == 'P') ? 1 : 0;
+                const int32_t next = new_wire("");
+                vector<uint8_t> table(8);
+                for (int32_t m = 0; m < 8; m++) table[m] = (bit(m, 0) == enable_value) ? bit(m, 1) : bit(m, 2);
+                add_function(next, {e->second, d->second, q->second}, table);
+                return add_register(next, q->second, 0);
+            }
+            return fail("unsupported cell " + type);
+        }
+
+        /** checks the drivers, levelizes, and returns the netlist (or NULL on error) */
+        TfheNetlist *finish() {
+            for (int32_t w: netlist->outputs) check_driven(w);
+            for (const TfheNetlistRegister &r: netlist->registers) check_driven(r.d);
+            for (const TfheNetlistGate &g: netlist->gates)
+                for (int32_t i = 0; i < 3; i++) if (g.in[i] >= 0) check_driven(g.in[i]);
+            if (!failed()) netlist->levelize(error);
+            if (failed()) {
+                cerr << "netlist: " << error << endl;
+                return 0;
+            }
+            TfheNetlist *result = netlist;
+            netlist = 0;
+            return result;
+        }
+
+    private:
+        TfheNetlist *netlist;
+        map<string, int32_t> wire_ids;
+        vector<string> wire_names;
+        vector<uint8_t> driven;
+        int32_t constant_wires[2];
+
+        int32_t new_wire(const string &name) {
+            wire_names.push_back(name);
+            driven.push_back(0);
+            return netlist->nb_wires++;
+        }
+
+        bool drive(int32_t w) {
+            if (driven[w]) return fail("wire " + wire_names[w] + " has several drivers");
+            driven[w] = 1;
+            return true;
+        }
+
+        void check_driven(int32_t w) {
+            if (!driven[w]) fail("wire " + wire_names[w] + " has no driver");
+        }
+
+        static void remove_input(vector<int32_t> &ins, vector<uint8_t> &table, int32_t j,
+                                 vector<uint8_t> &restricted) {
+            ins.erase(ins.begin() + j);
+            table.swap(restricted);
+        }
+    };
+
+
+    /* ********************************************************
+     * BLIF
+    ******************************************************** */
+
+    /** reads the next non-empty line, without the comments and with the continuations joined */
+    bool read_blif_line(istream &in, vector<string> &tokens) {
+        tokens.clear();
+        string line;
+        while (getline(in, line)) {
+            const size_t comment = line.find('#');
+            if (comment != string::npos) line.resize(comment);
+            bool continued = false;
+            while (!line.empty() && isspace((unsigned char) line.back())) line.pop_back();
+            if (!line.empty() && line.back() == '\\') {
+                line.pop_back();
+                continued = true;
+            }
+            istringstream words(line);
+            string word;
+            while (words >> word) tokens.push_back(word);
+            if (!continued && !tokens.empty()) return true;
+        }
+        return !tokens.empty();
+    }
+
+    /** .names: the signals, then the rows of the cover */
+    bool add_blif_names(NetlistBuilder &builder, const vector<string> &signals, const vector<vector<string> > &cover) {
+        const int32_t k = signals.size() - 1;
+        if (k > MAX_FUNCTION_INPUTS) return builder.fail(".names with too many inputs: " + signals.back());
+        vector<int32_t> ins;
+        for (int32_t j = 0; j < k; j++) ins.push_back(builder.wire(signals[j]));
+
+        // the rows list the assignments where the output is 1 (or 0 for an off-set cover)
+        vector<uint8_t> table(1 << k, 0);
+        int32_t row_value = -1;
+        for (const vector<string> &row: cover) {
+            const string pattern = (k == 0) ? "" : row[0];
+            const string &output = row.back();
+            if (int32_t(row.size()) != (k == 0 ? 1 : 2) || int32_t(pattern.size()) != k
+                || (output != "0" && output != "1"))
+                return builder.fail("invalid cover row for " + signals.back());
+            const int32_t value = output == "1";
+            if (row_value >= 0 && value != row_value) return builder.fail("mixed cover for " + signals.back());
+            row_value = value;
+            for (int32_t m = 0; m < int32_t(table.size()); m++) {
+                bool match = true;
+                for (int32_t j = 0; j < k && match; j++)
+                    match = pattern[j] == '-' || (pattern[j] - '0') == bit(m, j);
+                if (match) table[m] = 1;
+            }
+        }
+        if (row_value == 0) for (uint8_t &t: table) t = 1 - t;
+        return builder.add_function(builder.wire(signals.back()), ins, table);
+    }
+
+    TfheNetlist *read_blif(istream &in) {
+        NetlistBuilder builder;
+        vector<string> tokens;
+        vector<string> names;          // the pending .names
+        vector<vector<string> > cover;
+        vector<string> outputs;
+        bool in_model = false;
+
+        while (!builder.failed() && read_blif_line(in, tokens)) {
+            const string &command = tokens[0];
+            if (command[0] != '.') {
+                if (names.empty()) builder.fail("unexpected line: " + command);
+                cover.push_back(tokens);
+                continue;
+            }
+            if (!names.empty()) {
+                add_blif_names(builder, names, cover);
+                names.clear();
+                cover.clear();
+            }
+            if (command == ".model") {
+                if (in_model) break;
+                in_model = true;
+            } else if (command == ".end") {
+                break;
+            } else if (command == ".inputs") {
+                for (size_t i = 1; i < tokens.size(); i++) builder.add_input(tokens[i], builder.wire(tokens[i]));
+            } else if (command == ".outputs") {
+                outputs.insert(outputs.end(), tokens.begin() + 1, tokens.end());
+            } else if (command == ".names") {
+                if (tokens.size() < 2) builder.fail(".names without output");
+                names.assign(tokens.begin() + 1, tokens.end());
+            } else if (command == ".conn") {
+                if (tokens.size() != 3) builder.fail("invalid .conn");
+                else builder.add_gate(TFHE_GATE_COPY, builder.wire(tokens[2]), builder.wire(tokens[1]), -1, -1);
+            } else if (command == ".latch") {
+                // .latch input output [type control] [init], where init is 0, 1, 2 (don't care) or 3 (unknown)
+                if (tokens.size() < 3) builder.fail("invalid .latch");
+                else {
+                    const int32_t init = (tokens.size() == 4 || tokens.size() == 6) ? (tokens.back() == "1") : 0;
+                    builder.add_register(builder.wire(tokens[1]), builder.wire(tokens[2]), init);
+                }
+            } else if (command == ".subckt" || command == ".gate") {
+                if (tokens.size() < 2) builder.fail("invalid " + command);
+                map<string, int32_t> ports;
+                for (size_t i = 2; i < tokens.size(); i++) {
+                    const size_t eq = tokens[i].find('=');
+                    if (eq == string::npos) builder.fail("invalid connection " + tokens[i]);
+                    else ports[tokens[i].substr(0, eq)] = builder.wire(tokens[i].substr(eq + 1));
+                }
+                if (!builder.failed()) builder.add_cell(tokens[1], ports);
+            } else if (command == ".attr" || command == ".param" || command == ".cname" || command == ".clock") {
+                // annotations
+            } else {
+                builder.fail("unsupported command " + command);
+            }
+        }
+        if (!names.empty()) add_blif_names(builder, names, cover);
+        for (const string &name: outputs) builder.add_output(name, builder.wire(name));
+        return builder.finish();
+    }
+
+
+    /* ********************************************************
+     * Yosys JSON
+    ******************************************************** */
+
+    /** a JSON value (the members of an object keep the order of the file) */
+    struct JsonValue {
+        enum Kind { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+        Kind kind;
+        double number;
+        string str;
+        vector<JsonValue> items;
+        vector<pair<string, JsonValue> > members;
+
+        JsonValue() : kind(NUL), number(0) {}
+
+        const JsonValue *get(const string &key) const {
+            for (const pair<string, JsonValue> &m: members) if (m.first == key) return &m.second;
+            return 0;
+        }
+    };
+
+    class JsonParser {
+    public:
+        explicit JsonParser(const string &text) : text(text), pos(0) {}
+
+        bool parse(JsonValue &value) {
+            if (!parse_value(value, 0)) return false;
+            skip_spaces();
+            return pos == text.size();
+        }
+
+    private:
+        static const int32_t MAX_DEPTH = 64;
+        const string &text;
+        size_t pos;
+
+        void skip_spaces() {
+            while (pos < text.size() && isspace((unsigned char) text[pos])) pos++;
+        }
+
+        bool consume(char c) {
+            skip_spaces();
+            if (pos >= text.size() || text[pos] != c) return false;
+            pos++;
+            return true;
+        }
+
+        bool parse_string(string &out) {
+            if (!consume('"')) return false;
+            out.clear();
+            while (pos < text.size() && text[pos] != '"') {
+                char c = text[pos++];
+                if (c == '\\') {
+                    if (pos >= text.size()) return false;
+                    c = text[pos++];
+                    switch (c) {
+                        case 'b': c = '\b'; break;
+                        case 'f': c = '\f'; break;
+                        case 'n': c = '\n'; break;
+                        case 'r': c = '\r'; break;
+                        case 't': c = '\t'; break;
+                        case 'u': {
+                            if (pos + 4 > text.size()) return false;
+                            const uint32_t code = strtoul(text.substr(pos, 4).c_str(), 0, 16);
+                            pos += 4;
+                            // utf-8 encoding of the basic plane
+                            if (code < 0x80) out += char(code);
+                            else if (code < 0x800) {
+                                out += char(0xc0 | (code >> 6));
+                                out += char(0x80 | (code & 0x3f));
+                            } else {
+                                out += char(0xe0 | (code >> 12));
+                                out += char(0x80 | ((code >> 6) & 0x3f));
+                                out += char(0x80 | (code & 0x3f));
+                            }
+                            continue;
+                        }
+                        default: break; // '"', '\\' and '/'
+                    }
+                }
+                out += c;
+            }
+            return consume('"');
+        }
+
+        bool parse_value(JsonValue &value, int32_t depth) {
+            if (depth > MAX_DEPTH) return false;
+            skip_spaces();
+            if (pos >= text.size()) return false;
+            const char c = text[pos];
+            if (c == '{') {
+                pos++;
+                value.kind = JsonValue::OBJECT;
+                if (consume('}')) return true;
+                do {
+                    value.members.push_back(make_pair(string(), JsonValue()));
+                    if (!parse_string(value.members.back().first) || !consume(':')) return false;
+                    if (!parse_value(value.members.back().second, depth + 1)) return false;
+                } while (consume(','));
+                return consume('}');
+            }
+            if (c == '[') {
+                pos++;
+                value.kind = JsonValue::ARRAY;
+                if (consume(']')) return true;
+                do {
+                    value.items.push_back(JsonValue());
+                    if (!parse_value(value.items.back(), depth + 1)) return false;
+                } while (consume(','));
+                return consume(']');
+            }
+            if (c == '"') {
+                value.kind = JsonValue::STRING;
+                return parse_string(value.str);
+            }
+            if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 5, "false") == 0) {
+                value.kind = JsonValue::BOOLEAN;
+                value.number = (c == 't');
+                pos += (c == 't') ? 4 : 5;
+                return true;
+            }
+            if (text.compare(pos, 4, "null") == 0) {
+                pos += 4;
+                return true;
+            }
+            char *end;
+            value.kind = JsonValue::NUMBER;
+            value.number = strtod(text.c_str() + pos, &end);
+            if (end == text.c_str() + pos) return false;
+            pos = end - text.c_str();
+            return true;
+        }
+    };
+
+    /** the wire of a bit of a yosys netlist: a net number, or a constant "0", "1", "x" or "z" */
+    int32_t yosys_bit_wire(NetlistBuilder &builder, const JsonValue &bit) {
+        if (bit.kind == JsonValue::NUMBER) return builder.wire("$" + to_string(int64_t(bit.number)));
+        if (bit.kind == JsonValue::STRING) return builder.constant_wire(bit.str == "1");
+        builder.fail("invalid bit");
+        return builder.constant_wire(0);
+    }
+
+    bool is_top_module(const JsonValue &module) {
+        const JsonValue *attributes = module.get("attributes");
+        const JsonValue *top = attributes ? attributes->get("top") : 0;
+        if (top == 0) return false;
+        if (top->kind == JsonValue::STRING) return top->str.find('1') != string::npos;
+        return top->number != 0;
+    }
+
+    TfheNetlist *read_yosys_json(istream &in) {
+        NetlistBuilder builder;
+        const string text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        JsonValue root;
+        if (!JsonParser(text).parse(root)) {
+            builder.fail("invalid json");
+            return builder.finish();
+        }
+        const JsonValue *modules = root.get("modules");
+        if (modules == 0 || modules->members.empty()) {
+            builder.fail("no module");
+            return builder.finish();
+        }
+        const JsonValue *module = &modules->members[0].second;
+        for (const pair<string, JsonValue> &m: modules->members) if (is_top_module(m.second)) module = &m.second;
+
+        // ports
+        const JsonValue *ports = module->get("ports");
+        if (ports) {
+            for (const pair<string, JsonValue> &port: ports->members) {
+                const JsonValue *direction = port.second.get("direction");
+                const JsonValue *bits = port.second.get("bits");
+                const JsonValue *offset = port.second.get("offset");
+                if (direction == 0 || bits == 0) {
+                    builder.fail("invalid port " + port.first);
+                    break;
+                }
+                const int32_t width = bits->items.size();
+                for (int32_t i = 0; i < width; i++) {
+                    const string name = (width == 1) ? port.first :
+                                        port.first + "[" + to_string(i + (offset ? int32_t(offset->number) : 0)) + "]";
+                    if (direction->str == "input") {
+                        if (bits->items[i].kind != JsonValue::NUMBER) builder.fail("constant input " + name);
+                        else builder.add_input(name, yosys_bit_wire(builder, bits->items[i]));
+                    } else if (direction->str == "output") {
+                        builder.add_output(name, yosys_bit_wire(builder, bits->items[i]));
+                    } else {
+                        builder.fail("unsupported port direction " + direction->str);
+                    }
+                }
+            }
+        }
+
+        // cells
+        const JsonValue *cells = module->get("cells");
+        if (cells) {
+            for (const pair<string, JsonValue> &cell: cells->members) {
+                if (builder.failed()) break;
+                const JsonValue *type = cell.second.get("type");
+                const JsonValue *connections = cell.second.get("connections");
+                if (type == 0 || connections == 0) {
+                    builder.fail("invalid cell " + cell.first);
+                    break;
+                }
+                map<string, int32_t> port_wires;
+                for (const pair<string, JsonValue> &c: connections->members) {
+                    if (c.second.items.size() != 1) builder.fail("multi-bit port " + c.first + " in cell " + cell.first);
+                    else port_wires[c.first] = yosys_bit_wire(builder, c.second.items[0]);
+                }
+                if (!builder.failed()) builder.add_cell(type->str, port_wires);
+            }
+        }
+        return builder.finish();
+    }
+
+    TfheNetlist *read_file(FILE *F, TfheNetlist *(*reader)(istream &)) {
+        string text;
+        char buffer[4096];
+        size_t size;
+        while ((size = fread(buffer, 1, sizeof(buffer), F)) > 0) text.append(buffer, size);
+        istringstream in(text);
+        return reader(in);
+    }
+
+    /** calls execute(gate, thread) on the gates of a level */
+    void for_each_gate_of_level(const TfheNetlist *netlist, const TfheNetlistLevel &level, int32_t nb_threads,
+                                const function<void(const TfheNetlistGate &, int32_t)> &execute) {
+        // the bootstrapped gates of the level are independent
+        const int32_t nb_gates = level.free_begin - level.begin;
+        const int32_t nb_level_threads = min(nb_threads, nb_gates);
+        atomic<int32_t> next_gate(level.begin);
+        // the workers of the thread team are bound to their node when the team starts
+        tfhe_parallel_for(nb_level_threads, [&](int32_t thread) {
+            for (int32_t g = next_gate++; g < level.free_begin; g = next_gate++) execute(netlist->gates[g], thread);
+        }, nb_level_threads);
+        // then the free gates, in order
+        for (int32_t g = level.free_begin; g < level.end; g++) execute(netlist->gates[g], 0);
+    }
+
+    /** calls execute(gate, thread) on all the gates of the netlist, level by level */
+    void for_each_gate_by_level(const TfheNetlist *netlist, int32_t nb_threads,
+                                const function<void(const TfheNetlistGate &, int32_t)> &execute) {
+        for (const TfheNetlistLevel &level: netlist->levels) for_each_gate_of_level(netlist, level, nb_threads, execute);
+    }
+
+
+    /** a wire, possibly inverted, or a constant (wire -1, and the value in inverted) */
+    struct Literal {
+        int32_t wire;
+        int32_t inverted;
+    };
+
+    /**
+     * Rewrites the gates of a netlist in topological order, and tracks the value of each wire as a
+     * literal: the constants are folded, the free gates disappear (their inversions are absorbed by
+     * the gates which read them), and each gate is simplified on its distinct non-constant inputs.
+     * The inverters and constants are only materialized for the outputs, the registers, and the
+     * data inputs of a mux.
+     */
+    class NetlistOptimizer {
+    public:
+        explicit NetlistOptimizer(TfheNetlist *netlist) : netlist(netlist), constant_wires{-1, -1} {}
+
+        void run() {
+            literals.resize(netlist->nb_wires, Literal{-1, 0});
+            for (int32_t w: netlist->inputs) literals[w] = Literal{w, 0};
+            for (const TfheNetlistRegister &r: netlist->registers) literals[r.q] = Literal{r.q, 0};
+            for (const TfheNetlistGate &g: netlist->gates) literals[g.out] = simplify(g);
+            for (int32_t &w: netlist->outputs) w = materialize(literals[w]);
+            for (TfheNetlistRegister &r: netlist->registers) r.d = materialize(literals[r.d]);
+            remove_dead_gates();
+        }
+
+    private:
+        TfheNetlist *netlist;
+        vector<Literal> literals;           ///< the value of each wire of the original netlist
+        vector<TfheNetlistGate> gates;      ///< the new gates, in topological order
+        int32_t constant_wires[2];
+        map<int32_t, int32_t> inverted_wires;
+
+        int32_t new_wire() {
+            return netlist->nb_wires++;
+        }
+
+        void add_gate(TfheGateType type, int32_t out, int32_t a, int32_t b, int32_t c, int32_t value = 0) {
+            gates.push_back(TfheNetlistGate{type, out, {a, b, c}, value});
+        }
+
+        /** a wire which holds the value of a literal */
+        int32_t materialize(const Literal &literal) {
+            if (literal.wire < 0) {
+                int32_t &w = constant_wires[literal.inverted];
+                if (w < 0) add_gate(TFHE_GATE_CONSTANT, w = new_wire(), -1, -1, -1, literal.inverted);
+                return w;
+            }
+            if (!literal.inverted) return literal.wire;
+            map<int32_t, int32_t>::const_iterator it = inverted_wires.find(literal.wire);
+            if (it != inverted_wires.end()) return it->second;
+            const int32_t w = new_wire();
+            add_gate(TFHE_GATE_NOT, w, literal.wire, -1, -1);
+            inverted_wires[literal.wire] = w;
+            return w;
+        }
+
+        Literal simplify(const TfheNetlistGate &g) {
+            // the truth table of the gate on the distinct wires of its inputs
+            const int32_t nb_inputs = tfhe_gate_nb_inputs(g.type);
+            Literal in[3] = {{-1, 0}, {-1, 0}, {-1, 0}};
+            vector<int32_t> ins;
+            for (int32_t i = 0; i < nb_inputs; i++) {
+                in[i] = literals[g.in[i]];
+                if (in[i].wire >= 0 && find(ins.begin(), ins.end(), in[i].wire) == ins.end()) ins.push_back(in[i].wire);
+            }
+            vector<uint8_t> table(1 << ins.size());
+            for (int32_t m = 0; m < int32_t(table.size()); m++) {
+                int32_t v[3];
+                for (int32_t i = 0; i < 3; i++) {
+                    const int32_t j = find(ins.begin(), ins.end(), in[i].wire) - ins.begin();
+                    v[i] = (in[i].wire < 0) ? in[i].inverted : bit(m, j) ^ in[i].inverted;
+                }
+                table[m] = tfhe_gate_eval_plain(g.type, v[0], v[1], v[2], g.value);
+            }
+            // unused inputs
+            for (int32_t j = int32_t(ins.size()) - 1; j >= 0; j--) {
+                bool used = false;
+                for (int32_t m = 0; m < int32_t(table.size()) && !used; m++) used = table[m] != table[m ^ (1 << j)];
+                if (used) continue;
+                vector<uint8_t> restricted;
+                for (int32_t m = 0; m < int32_t(table.size()); m++) if (bit(m, j) == 0) restricted.push_back(table[m]);
+                ins.erase(ins.begin() + j);
+                table.swap(restricted);
+            }
+
+            switch (ins.size()) {
+                case 0: return Literal{-1, table[0]};
+                case 1: return Literal{ins[0], table[0]};
+                case 2:
+                    add_gate(binary_gate(table), g.out, ins[0], ins[1], -1);
+                    return Literal{g.out, 0};
+                default:
+                    break;
+            }
+            // a mux s?x^ix:y^iy, with the output inverted if io: an inversion of both data inputs
+            // moves to the output, else one of them is materialized
+            const int32_t inversions[4][2] = {{0, 0}, {1, 1}, {0, 1}, {1, 0}};
+            for (const int32_t *inv: inversions) {
+                for (int32_t s = 0; s < 3; s++) {
+                    for (int32_t x = 0; x < 3; x++) {
+                        const int32_t y = 3 - s - x;
+                        if (x == s || y == s || x == y) continue;
+                        for (int32_t io = 0; io < 2; io++) {
+                            bool match = true;
+                            for (int32_t m = 0; m < 8 && match; m++)
+                                match = table[m] == ((bit(m, s) ? bit(m, x) ^ inv[0] : bit(m, y) ^ inv[1]) ^ io);
+                            if (!match) continue;
+                            if (inv[0] == inv[1]) {
+                                add_gate(TFHE_GATE_MUX, g.out, ins[s], ins[x], ins[y]);
+                                return Literal{g.out, io ^ inv[0]};
+                            }
+                            const int32_t wx = materialize(Literal{ins[x], inv[0]});
+                            const int32_t wy = materialize(Literal{ins[y], inv[1]});
+                            add_gate(TFHE_GATE_MUX, g.out, ins[s], wx, wy);
+                            return Literal{g.out, io};
+                        }
+                    }
+                }
+            }
+            // a symmetric gate of the inputs xored with inv, with the output inverted if io: the xor3 moves
+            // all the inversions to the output, the majority moves an inversion of all its inputs
+            for (TfheGateType t: {TFHE_GATE_XOR3, TFHE_GATE_MAJ}) {
+                for (int32_t inv = 0; inv < 8; inv++) {
+                    for (int32_t io = 0; io < 2; io++) {
+                        bool match = true;
+                        for (int32_t m = 0; m < 8 && match; m++)
+                            match = table[m] == (tfhe_gate_eval_plain(t, bit(m ^ inv, 0), bit(m ^ inv, 1),
+                                                                      bit(m ^ inv, 2), 0) ^ io);
+                        if (!match) continue;
+                        if (inv == 0) {
+                            add_gate(t, g.out, ins[0], ins[1], ins[2]);
+                            return Literal{g.out, io};
+                        }
+                        int32_t w[3];
+                        for (int32_t i = 0; i < 3; i++) w[i] = materialize(Literal{ins[i], bit(inv, i)});
+                        add_gate(t, g.out, w[0], w[1], w[2]);
+                        return Literal{g.out, io};
+                    }
+                }
+            }
+            abort(); // the 3-input gates are the mux, the majority and the xor3
+        }
+
+        /** keeps the gates which compute an output or a register */
+        void remove_dead_gates() {
+            vector<uint8_t> live(netlist->nb_wires, 0);
+            for (int32_t w: netlist->outputs) live[w] = 1;
+            for (const TfheNetlistRegister &r: netlist->registers) live[r.d] = 1;
+            vector<TfheNetlistGate> kept;
+            for (int32_t g = int32_t(gates.size()) - 1; g >= 0; g--) {
+                if (!live[gates[g].out]) continue;
+                for (int32_t i = 0; i < 3; i++) if (gates[g].in[i] >= 0) live[gates[g].in[i]] = 1;
+                kept.push_back(gates[g]);
+            }
+            netlist->gates.assign(kept.rbegin(), kept.rend());
+        }
+    };
+
+}
+
+
+TfheNetlist::TfheNetlist() : nb_wires(0) {}
+
+bool TfheNetlist::levelize(string &error) {
+    const int32_t nb_gates = gates.size();
+
+    // topological order (Kahn)
+    vector<vector<int32_t> > readers(nb_wires);
+    vector<int32_t> driver(nb_wires, -1);
+    for (int32_t g = 0; g < nb_gates; g++) {
+        driver[gates[g].out] = g;
+        for (int32_t i = 0; i < 3; i++) if (gates[g].in[i] >= 0) readers[gates[g].in[i]].push_back(g);
+    }
+    vector<int32_t> nb_pending(nb_gates, 0);
+    vector<int32_t> order;
+    for (int32_t g = 0; g < nb_gates; g++) {
+        for (int32_t i = 0; i < 3; i++) if (gates[g].in[i] >= 0 && driver[gates[g].in[i]] >= 0) nb_pending[g]++;
+        if (nb_pending[g] == 0) order.push_back(g);
+    }
+    for (size_t pos = 0; pos < order.size(); pos++)
+        for (int32_t r: readers[gates[order[pos]].out]) if (--nb_pending[r] == 0) order.push_back(r);
+    if (int32_t(order.size()) != nb_gates) {
+        error = "combinational loop";
+        return false;
+    }
+
+    // level of a gate: the number of bootstraps on the longest path from the inputs
+    vector<int32_t> wire_level(nb_wires, 0);
+    vector<int32_t> gate_level(nb_gates);
+    int32_t max_level = 0;
+    for (int32_t g: order) {
+        int32_t level = 0;
+        for (int32_t i = 0; i < 3; i++) if (gates[g].in[i] >= 0) level = max(level, wire_level[gates[g].in[i]]);
+        if (tfhe_gate_nb_bootstraps(gates[g].type) > 0) level++;
+        gate_level[g] = wire_level[gates[g].out] = level;
+        max_level = max(max_level, level);
+    }
+
+    // priority of a gate: the number of bootstraps on the longest path from the gate to the outputs
+    vector<int32_t> priority(nb_gates, 0);
+    for (int32_t pos = nb_gates - 1; pos >= 0; pos--) {
+        const int32_t g = order[pos];
+        for (int32_t r: readers[gates[g].out]) priority[g] = max(priority[g], priority[r]);
+        priority[g] += tfhe_gate_nb_bootstraps(gates[g].type);
+    }
+
+    // sort by level, then bootstrapped gates first: the costliest (mux) and the most critical ones start first,
+    // so that the threads finish the level together. Then the free gates in topological order
+    vector<int32_t> rank(nb_gates);
+    for (int32_t pos = 0; pos < nb_gates; pos++) rank[order[pos]] = pos;
+    vector<int32_t> sorted(order);
+    auto is_free = [&](int32_t g) { return tfhe_gate_nb_bootstraps(gates[g].type) == 0; };
+    stable_sort(sorted.begin(), sorted.end(), [&](int32_t x, int32_t y) {
+        if (gate_level[x] != gate_level[y]) return gate_level[x] < gate_level[y];
+        if (is_free(x) != is_free(y)) return is_free(y);
+        if (!is_free(x)) {
+            const int32_t cost_x = tfhe_gate_nb_bootstraps(gates[x].type);
+            const int32_t cost_y = tfhe_gate_nb_bootstraps(gates[y].type);
+            if (cost_x != cost_y) return cost_x > cost_y;
+            if (priority[x] != priority[y]) return priority[x] > priority[y];
+        }
+        return rank[x] < rank[y];
+    });
+    vector<TfheNetlistGate> sorted_gates;
+    for (int32_t g: sorted) sorted_gates.push_back(gates[g]);
+    gates.swap(sorted_gates);
+
+    levels.assign(nb_gates ? max_level + 1 : 0, TfheNetlistLevel{0, 0, 0});
+    int32_t pos = 0;
+    for (int32_t l = 0; l < int32_t(levels.size()); l++) {
+        levels[l].begin = pos;
+        while (pos < nb_gates && gate_level[sorted[pos]] == l && !is_free(sorted[pos])) pos++;
+        levels[l].free_begin = pos;
+        while (pos < nb_gates && gate_level[sorted[pos]] == l) pos++;
+        levels[l].end = pos;
+    }
+    return true;
+}
+
+
+EXPORT TfheNetlist *new_TfheNetlist_fromBlifStream(istream &in) {
+    return read_blif(in);
+}
+
+EXPORT TfheNetlist *new_TfheNetlist_fromYosysJsonStream(istream &in) {
+    return read_yosys_json(in);
+}
+
+EXPORT TfheNetlist *new_TfheNetlist_fromBlifFile(FILE *F) {
+    return read_file(F, read_blif);
+}
+
+EXPORT TfheNetlist *new_TfheNetlist_fromYosysJsonFile(FILE *F) {
+    return read_file(F, read_yosys_json);
+}
+
+EXPORT TfheNetlist *new_TfheNetlist_fromFileName(const char *filename) {
+    ifstream in(filename);
+    if (!in) {
+        cerr << "netlist: cannot open " << filename << endl;
+        return 0;
+    }
+    const size_t length = strlen(filename);
+    if (length >= 5 && strcmp(filename + length - 5, ".json") == 0) return read_yosys_json(in);
+    return read_blif(in);
+}
+
+EXPORT void delete_TfheNetlist(TfheNetlist *netlist) {
+    delete netlist;
+}
+
+EXPORT int32_t tfhe_netlist_nb_inputs(const TfheNetlist *netlist) { return netlist->inputs.size(); }
+
+EXPORT int32_t tfhe_netlist_nb_outputs(const TfheNetlist *netlist) { return netlist->outputs.size(); }
+
+EXPORT int32_t tfhe_netlist_nb_registers(const TfheNetlist *netlist) { return netlist->registers.size(); }
+
+EXPORT int32_t tfhe_netlist_nb_gates(const TfheNetlist *netlist) { return netlist->gates.size(); }
+
+EXPORT int32_t tfhe_netlist_optimize(TfheNetlist *netlist) {
+    const int32_t nb_bootstraps = tfhe_netlist_nb_bootstraps(netlist);
+    NetlistOptimizer(netlist).run();
+    string error;
+    netlist->levelize(error);
+    return nb_bootstraps - tfhe_netlist_nb_bootstraps(netlist);
+}
+
+EXPORT int32_t tfhe_netlist_nb_bootstraps(const TfheNetlist *netlist) {
+    int32_t result = 0;
+    for (const TfheNetlistGate &g: netlist->gates) result += tfhe_gate_nb_bootstraps(g.type);
+    return result;
+}
+
+EXPORT int32_t tfhe_netlist_nb_levels(const TfheNetlist *netlist) {
+    return netlist->levels.empty() ? 0 : netlist->levels.size() - 1;
+}
+
+EXPORT const char *tfhe_netlist_input_name(const TfheNetlist *netlist, int32_t i) {
+    return netlist->input_names[i].c_str();
+}
+
+EXPORT const char *tfhe_netlist_output_name(const TfheNetlist *netlist, int32_t i) {
+    return netlist->output_names[i].c_str();
+}
+
+EXPORT int32_t tfhe_netlist_register_init(const TfheNetlist *netlist, int32_t i) {
+    return netlist->registers[i].init;
+}
+
+void tfhe_netlist_eval_level(const TfheNetlist *netlist, int32_t level, LweSample *wires,
+                             const TFheGateBootstrappingCloudKeySet *bk, const vector<TfheGateWorkspace *> &workspaces) {
+    for_each_gate_of_level(netlist, netlist->levels[level], workspaces.size(),
+                           [&](const TfheNetlistGate &g, int32_t thread) {
+        tfhe_execute_gate(wires + g.out, g.type,
+                          g.in[0] >= 0 ? wires + g.in[0] : 0, g.in[1] >= 0 ? wires + g.in[1] : 0,
+                          g.in[2] >= 0 ? wires + g.in[2] : 0, g.value, tfhe_numa_local_cloud_key(bk),
+                          *workspaces[thread]);
+    });
+}
+
+EXPORT void tfhe_netlist_eval(const TfheNetlist *netlist, LweSample *outputs, const LweSample *inputs,
+                              LweSample *state, const TFheGateBootstrappingCloudKeySet *bk, int32_t nb_threads) {
+    const LweParams *params = bk->params->in_out_params;
+    if (nb_threads <= 0) nb_threads = tfhe_get_nb_threads();
+    int32_t max_width = 1;
+    for (const TfheNetlistLevel &level: netlist->levels) max_width = max(max_width, level.free_begin - level.begin);
+    nb_threads = min(nb_threads, max_width);
+
+    LweSample *wires = new_LweSample_array(netlist->nb_wires, params);
+    vector<TfheGateWorkspace *> workspaces;
+    for (int32_t t = 0; t < nb_threads; t++) workspaces.push_back(new TfheGateWorkspace(bk->params));
+
+    for (int32_t i = 0; i < int32_t(netlist->inputs.size()); i++) lweCopy(wires + netlist->inputs[i], inputs + i, params);
+    for (int32_t i = 0; i < int32_t(netlist->registers.size()); i++)
+        lweCopy(wires + netlist->registers[i].q, state + i, params);
+    for (int32_t l = 0; l < int32_t(netlist->levels.size()); l++) tfhe_netlist_eval_level(netlist, l, wires, bk, workspaces);
+    for (int32_t i = 0; i < int32_t(netlist->outputs.size()); i++) lweCopy(outputs + i, wires + netlist->outputs[i], params);
+    for (int32_t i = 0; i < int32_t(netlist->registers.size()); i++)
+        lweCopy(state + i, wires + netlist->registers[i].d, params);
+
+    for (TfheGateWorkspace *ws: workspaces) delete ws;
+    delete_LweSample_array(netlist->nb_wires, wires);
+}
+
+EXPORT void tfhe_netlist_eval_plain(const TfheNetlist *netlist, int32_t *outputs, const int32_t *inputs,
+                                    int32_t *state) {
+    vector<int32_t> wires(netlist->nb_wires, 0);
+    for (int32_t i = 0; i < int32_t(netlist->inputs.size()); i++) wires[netlist->inputs[i]] = inputs[i] != 0;
+    for (int32_t i = 0; i < int32_t(netlist->registers.size()); i++) wires[netlist->registers[i].q] = state[i] != 0;
+    for_each_gate_by_level(netlist, 1, [&](const TfheNetlistGate &g, int32_t) {
+        wires[g.out] = tfhe_gate_eval_plain(g.type, g.in[0] >= 0 ? wires[g.in[0]] : 0, g.in[1] >= 0 ? wires[g.in[1]] : 0,
+                                            g.in[2] >= 0 ? wires[g.in[2]] : 0, g.value);
+    });
+    for (int32_t i = 0; i < int32_t(netlist->outputs.size()); i++) outputs[i] = wires[netlist->outputs[i]];
+    for (int32_t i = 0; i < int32_t(netlist->registers.size()); i++) state[i] = wires[netlist->registers[i].d];
+}
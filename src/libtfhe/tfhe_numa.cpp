@@ -0,0 +1,239 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "tfhe.h"
+#include "tfhe_numa.h"
+
+using namespace std;
+
+
+namespace {
+
+    /** the cpus of each node */
+    struct NumaTopology {
+        vector<vector<int32_t> > node_cpus;
+        vector<int32_t> cpu_node;
+
+        NumaTopology();
+    };
+
+    /** parses a cpu list of sysfs, such as "0-3,8,10-11" */
+    vector<int32_t> parse_cpu_list(const string &list) {
+        vector<int32_t> cpus;
+        istringstream in(list);
+        string range;
+        while (getline(in, range, ',')) {
+            if (range.empty()) continue;
+            const size_t dash = range.find('-');
+            const int32_t first = atoi(range.c_str());
+            const int32_t last = (dash == string::npos) ? first : atoi(range.c_str() + dash + 1);
+            for (int32_t cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    NumaTopology::NumaTopology() {
+#ifdef __linux__
+        for (int32_t node = 0;; node++) {
+            ifstream in("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+            if (!in) break;
+            string list;
+            getline(in, list);
+            node_cpus.push_back(parse_cpu_list(list));
+        }
+#endif
+        // unknown topology: a single node (with an empty cpu list, so that nothing is bound)
+        if (node_cpus.empty()) node_cpus.resize(1);
+        for (int32_t node = 0; node < int32_t(node_cpus.size()); node++) {
+            for (int32_t cpu: node_cpus[node]) {
+                if (cpu >= int32_t(cpu_node.size())) cpu_node.resize(cpu + 1, 0);
+                cpu_node[cpu] = node;
+            }
+        }
+    }
+
+    const NumaTopology &topology() {
+        static const NumaTopology result;
+        return result;
+    }
+
+    atomic<int32_t> replication_enabled(0);
+
+    /** the replicas of each cloud key, indexed by node */
+    mutex replicas_lock;
+    map<const TFheGateBootstrappingCloudKeySet *, vector<TFheGateBootstrappingCloudKeySet *> > replicas;
+    atomic<uint64_t> replicas_generation(0);   ///< incremented when replicas are deleted
+
+    /** the last replica returned to the thread */
+    struct ThreadReplica {
+        const TFheGateBootstrappingCloudKeySet *bk;
+        int32_t node;
+        uint64_t generation;
+        const TFheGateBootstrappingCloudKeySet *replica;
+    };
+    thread_local ThreadReplica thread_replica = {0, -1, 0, 0};
+
+    /** a copy of the keys used by the gates: the fft bootstrapping key and the keyswitch key */
+    TFheGateBootstrappingCloudKeySet *new_replica(const TFheGateBootstrappingCloudKeySet *bk) {
+        const LweBootstrappingKeyFFT *source = bk->bkFFT;
+        const TGswParams *bk_params = source->bk_params;
+        const int32_t n = source->in_out_params->n;
+        const int32_t k = bk_params->tlwe_params->k;
+
+        TGswSampleFFT *bkFFT = new_TGswSampleFFT_array(n, bk_params);
+        for (int32_t i = 0; i < n; i++) {
+            for (int32_t p = 0; p < bk_params->kpl; p++) {
+                TLweSampleFFT *row = &bkFFT[i].all_samples[p];
+                const TLweSampleFFT *source_row = &source->bkFFT[i].all_samples[p];
+                for (int32_t j = 0; j <= k; j++) {
+                    LagrangeHalfCPolynomialClear(&row->a[j]);
+                    LagrangeHalfCPolynomialAddTo(&row->a[j], &source_row->a[j]);
+                }
+                row->current_variance = source_row->current_variance;
+            }
+        }
+
+        const LweKeySwitchKey *source_ks = source->ks;
+        LweKeySwitchKey *ks = new_LweKeySwitchKey(source_ks->n, source_ks->t, source_ks->basebit, source_ks->out_params);
+        memcpy(ks->data, source_ks->data, ks->data_size() * sizeof(Torus32));
+        ks->current_variance = source_ks->current_variance;
+
+        LweBootstrappingKeyFFT *replica = new LweBootstrappingKeyFFT(source->in_out_params, bk_params,
+                                                                     source->accum_params, source->extract_params,
+                                                                     bkFFT, ks);
+        return new TFheGateBootstrappingCloudKeySet(bk->params, bk->bk, replica);
+    }
+
+    void delete_replica(TFheGateBootstrappingCloudKeySet *replica) {
+        LweBootstrappingKeyFFT *bkFFT = (LweBootstrappingKeyFFT *) replica->bkFFT;
+        delete_LweKeySwitchKey((LweKeySwitchKey *) bkFFT->ks);
+        delete_TGswSampleFFT_array(bkFFT->in_out_params->n, (TGswSampleFFT *) bkFFT->bkFFT);
+        delete bkFFT;
+        delete replica;
+    }
+
+#ifdef __linux__
+    bool set_thread_cpus(const vector<int32_t> &cpus) {
+        if (cpus.empty()) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int32_t cpu: cpus) if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+    }
+#endif
+
+}
+
+
+EXPORT int32_t tfhe_numa_nb_nodes() {
+    return topology().node_cpus.size();
+}
+
+EXPORT int32_t tfhe_numa_node_of_cpu(int32_t cpu) {
+    const vector<int32_t> &cpu_node = topology().cpu_node;
+    return (cpu >= 0 && cpu < int32_t(cpu_node.size())) ? cpu_node[cpu] : 0;
+}
+
+EXPORT int32_t tfhe_numa_current_node() {
+#ifdef __linux__
+    return tfhe_numa_node_of_cpu(sched_getcpu());
+#else
+    return 0;
+#endif
+}
+
+EXPORT int32_t tfhe_numa_node_of_worker(int32_t index, int32_t nb_workers) {
+    return (nb_workers > 0) ? int32_t(int64_t(index) * tfhe_numa_nb_nodes() / nb_workers) : 0;
+}
+
+EXPORT int32_t tfhe_numa_bind_thread(int32_t node) {
+#ifdef __linux__
+    return set_thread_cpus(topology().node_cpus[node % tfhe_numa_nb_nodes()]);
+#else
+    return 0;
+#endif
+}
+
+EXPORT void tfhe_set_numa_replication(int32_t enabled) {
+    replication_enabled = (enabled != 0);
+}
+
+EXPORT int32_t tfhe_get_numa_replication() {
+    return replication_enabled;
+}
+
+EXPORT const TFheGateBootstrappingCloudKeySet *tfhe_numa_cloud_key(const TFheGateBootstrappingCloudKeySet *bk,
+                                                                   int32_t node) {
+    if (!replication_enabled) return bk;
+    node %= tfhe_numa_nb_nodes();
+    lock_guard<mutex> guard(replicas_lock);
+    vector<TFheGateBootstrappingCloudKeySet *> &node_replicas = replicas[bk];
+    node_replicas.resize(tfhe_numa_nb_nodes(), 0);
+    if (node_replicas[node] == 0) {
+        // the pages are allocated on the node of the first thread which writes them
+        thread builder([&] {
+            tfhe_numa_bind_thread(node);
+            node_replicas[node] = new_replica(bk);
+        });
+        builder.join();
+    }
+    return node_replicas[node];
+}
+
+EXPORT const TFheGateBootstrappingCloudKeySet *tfhe_numa_local_cloud_key(const TFheGateBootstrappingCloudKeySet *bk) {
+    if (!replication_enabled) {
+        thread_replica.node = -1;
+        return bk;
+    }
+    const int32_t node = tfhe_numa_current_node();
+    const uint64_t generation = replicas_generation.load();
+    if (thread_replica.bk != bk || thread_replica.node != node || thread_replica.generation != generation) {
+        thread_replica.replica = tfhe_numa_cloud_key(bk, node);
+        thread_replica.bk = bk;
+        thread_replica.node = node;
+        thread_replica.generation = generation;
+    }
+    return thread_replica.replica;
+}
+
+EXPORT int32_t tfhe_numa_thread_replica() {
+    return thread_replica.node;
+}
+
+EXPORT void tfhe_numa_release_replicas(const TFheGateBootstrappingCloudKeySet *bk) {
+    lock_guard<mutex> guard(replicas_lock);
+    map<const TFheGateBootstrappingCloudKeySet *, vector<TFheGateBootstrappingCloudKeySet *> >::iterator it =
+            replicas.find(bk);
+    if (it == replicas.end()) return;
+    for (TFheGateBootstrappingCloudKeySet *replica: it->second) if (replica) delete_replica(replica);
+    replicas.erase(it);
+    replicas_generation++;
+}
+
+
+TfheNumaBinding::TfheNumaBinding(int32_t index, int32_t nb_workers) : bound(false) {
+#ifdef __linux__
+    if (!replication_enabled) return;
+    cpu_set_t set;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) return;
+    for (int32_t cpu = 0; cpu < CPU_SETSIZE; cpu++) if (CPU_ISSET(cpu, &set)) saved_cpus.push_back(cpu);
+    bound = tfhe_numa_bind_thread(tfhe_numa_node_of_worker(index, nb_workers));
+#endif
+}
+
+TfheNumaBinding::~TfheNumaBinding() {
+#ifdef __linux__
+    if (bound) set_thread_cpus(saved_cpus);
+#endif
+}
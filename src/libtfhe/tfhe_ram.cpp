@@ -0,0 +1,160 @@
+#include <algorithm>
+#include "tfhe.h"
+#include "tfhe_ram.h"
+
+using namespace std;
+
+
+namespace {
+    const Torus32 MU = modSwitchToTorus32(1, 8);
+
+    // calls task(i,ws) for all i in [0,nb_tasks[, on the threads of the ram, each with its workspace
+    void parallel_for_each(TfheRam *ram, int32_t nb_tasks, const function<void(int32_t, TfheRamWorkspace &)> &task) {
+        const int32_t nb_workers = min(nb_tasks, (int32_t) ram->workspaces.size());
+        tfhe_parallel_for(nb_workers, [&](int32_t w) {
+            for (int32_t i = w; i < nb_tasks; i += nb_workers) task(i, *ram->workspaces[w]);
+        }, nb_workers);
+    }
+
+    // acc += X^b.bit, where x is a gate bootstrapping ciphertext of bit
+    void add_bit(TLweSample *acc, int32_t b, const LweSample *x, const TfheCircuitBootstrappingKey *cbk,
+                 TfheRamWorkspace &ws) {
+        const int32_t k = cbk->tgsw_params->tlwe_params->k;
+        tfhe_bootstrap_woKS_FFT(ws.extracted, cbk->bk->bkFFT, MU, x);
+        // the last keyswitch key of the circuit bootstrapping is the identity
+        tLweFunctionalKeySwitch(ws.bit, cbk->ks + k, ws.extracted);
+        for (int32_t i = 0; i <= k; i++) {
+            torusPolynomialMulByXai(ws.temp, b, ws.bit->a + i);
+            torusPolynomialAddTo(acc->a + i, ws.temp);
+        }
+    }
+}
+
+TfheRamWorkspace::TfheRamWorkspace(const TfheCircuitBootstrappingKey *cbk) : cmux(cbk->tgsw_params) {
+    const TLweParams *tlwe_params = cbk->tgsw_params->tlwe_params;
+    cell = new_TLweSample(tlwe_params);
+    bit = new_TLweSample(tlwe_params);
+    temp = new_TorusPolynomial(tlwe_params->N);
+    extracted = new_LweSample(&tlwe_params->extracted_lweparams);
+    small = new_LweSample(cbk->bk->params->in_out_params);
+}
+
+TfheRamWorkspace::~TfheRamWorkspace() {
+    delete_LweSample(small);
+    delete_LweSample(extracted);
+    delete_TorusPolynomial(temp);
+    delete_TLweSample(bit);
+    delete_TLweSample(cell);
+}
+
+
+TfheRam::TfheRam(int32_t m, int32_t word_size, const TfheCircuitBootstrappingKey *cbk, int32_t nb_threads,
+                 int32_t refresh_period) :
+        cbk(cbk), m(m), word_size(word_size), nb_threads(nb_threads > 0 ? nb_threads : tfhe_get_nb_threads()),
+        refresh_period(refresh_period), nb_writes(0) {
+    const TGswParams *params = cbk->tgsw_params;
+    const TLweParams *tlwe_params = params->tlwe_params;
+    const int32_t N = tlwe_params->N;
+
+    if (word_size > N) die_dramatically("the words of a RAM must fit in a polynomial");
+    cells = new_TLweSample_array(1 << m, tlwe_params);
+    TorusPolynomial *zero = new_TorusPolynomial(N);
+    torusPolynomialClear(zero);
+    for (int32_t b = 0; b < word_size; b++) zero->coefsT[b] = -MU;
+    for (int32_t a = 0; a < (1 << m); a++) tLweNoiselessTrivial(cells + a, zero, tlwe_params);
+    delete_TorusPolynomial(zero);
+    tree = new_TfheCMuxTree(params, m, this->nb_threads);
+    for (int32_t i = 0; i < this->nb_threads; i++) workspaces.push_back(new TfheRamWorkspace(cbk));
+    word = new_TLweSample(tlwe_params);
+    extracted = new_LweSample_array(word_size, &tlwe_params->extracted_lweparams);
+    reversed = new Torus32[2 * N];
+    address = new_TGswSampleFFT_array(m, params);
+}
+
+TfheRam::~TfheRam() {
+    delete_TGswSampleFFT_array(m, address);
+    delete[] reversed;
+    delete_LweSample_array(word_size, extracted);
+    delete_TLweSample(word);
+    for (TfheRamWorkspace *ws: workspaces) delete ws;
+    delete_TfheCMuxTree(tree);
+    delete_TLweSample_array(1 << m, cells);
+}
+
+EXPORT TfheRam *new_TfheRam(int32_t m, int32_t word_size, const TfheCircuitBootstrappingKey *cbk,
+                            int32_t nb_threads, int32_t refresh_period) {
+    return new TfheRam(m, word_size, cbk, nb_threads, refresh_period);
+}
+
+EXPORT void delete_TfheRam(TfheRam *ram) {
+    delete ram;
+}
+
+
+EXPORT void tfhe_ram_read(LweSample *result, TfheRam *ram, const TGswSampleFFT *address) {
+    const TLweParams *tlwe_params = ram->cbk->tgsw_params->tlwe_params;
+    const LweKeySwitchKey *ks = ram->cbk->bk->bkFFT->ks;
+    TLweSample *selected = ram->workspaces[0]->cell;
+
+    tfhe_cmuxTree(selected, ram->tree, address, ram->cells);
+    tLweExtractLweSamples(ram->extracted, selected, 0, ram->word_size, &tlwe_params->extracted_lweparams, tlwe_params,
+                          ram->reversed);
+    // one task per bit of the word
+    tfhe_parallel_for(ram->word_size, [&](int32_t b) {
+        lweKeySwitch(result + b, ks, ram->extracted + b);
+    }, ram->nb_threads);
+}
+
+EXPORT void tfhe_ram_write(TfheRam *ram, const TGswSampleFFT *address, const TLweSample *word) {
+    const TLweParams *tlwe_params = ram->cbk->tgsw_params->tlwe_params;
+    const int32_t m = ram->m;
+
+    // cell a becomes (address == a) ? word : cell, one address bit after the other
+    parallel_for_each(ram, 1 << m, [&](int32_t a, TfheRamWorkspace &ws) {
+        TLweSample *cell = ram->cells + a;
+        tLweCopy(ws.cell, word, tlwe_params);
+        for (int32_t i = 0; i < m; i++) {
+            if ((a >> i) & 1) tLweCMuxFFT(ws.cell, address + i, cell, ws.cell, ws.cmux);
+            else tLweCMuxFFT(ws.cell, address + i, ws.cell, cell, ws.cmux);
+        }
+        tLweCopy(cell, ws.cell, tlwe_params);
+    });
+    if (ram->refresh_period > 0 && ++ram->nb_writes >= ram->refresh_period) tfhe_ram_refresh(ram);
+}
+
+EXPORT void tfhe_ram_read_bits(LweSample *result, TfheRam *ram, const LweSample *address) {
+    for (int32_t i = 0; i < ram->m; i++) tfhe_circuitBootstrap_FFT(ram->address + i, ram->cbk, address + i);
+    tfhe_ram_read(result, ram, ram->address);
+}
+
+EXPORT void tfhe_ram_write_bits(TfheRam *ram, const LweSample *address, const LweSample *word) {
+    const TLweParams *tlwe_params = ram->cbk->tgsw_params->tlwe_params;
+    const int32_t nb_workers = min(ram->word_size, (int32_t) ram->workspaces.size());
+
+    for (int32_t i = 0; i < ram->m; i++) tfhe_circuitBootstrap_FFT(ram->address + i, ram->cbk, address + i);
+    // each thread packs some bits of the word, then the partial words are summed
+    for (int32_t w = 0; w < nb_workers; w++) tLweClear(ram->workspaces[w]->cell, tlwe_params);
+    parallel_for_each(ram, ram->word_size, [&](int32_t b, TfheRamWorkspace &ws) {
+        add_bit(ws.cell, b, word + b, ram->cbk, ws);
+    });
+    tLweClear(ram->word, tlwe_params);
+    for (int32_t w = 0; w < nb_workers; w++) tLweAddTo(ram->word, ram->workspaces[w]->cell, tlwe_params);
+    tfhe_ram_write(ram, ram->address, ram->word);
+}
+
+EXPORT void tfhe_ram_refresh(TfheRam *ram) {
+    const TLweParams *tlwe_params = ram->cbk->tgsw_params->tlwe_params;
+    const LweKeySwitchKey *ks = ram->cbk->bk->bkFFT->ks;
+
+    parallel_for_each(ram, 1 << ram->m, [&](int32_t a, TfheRamWorkspace &ws) {
+        TLweSample *cell = ram->cells + a;
+        tLweClear(ws.cell, tlwe_params);
+        for (int32_t b = 0; b < ram->word_size; b++) {
+            tLweExtractLweSampleIndex(ws.extracted, cell, b, &tlwe_params->extracted_lweparams, tlwe_params);
+            lweKeySwitch(ws.small, ks, ws.extracted);
+            add_bit(ws.cell, b, ws.small, ram->cbk, ws);
+        }
+        tLweCopy(cell, ws.cell, tlwe_params);
+    });
+    ram->nb_writes = 0;
+}
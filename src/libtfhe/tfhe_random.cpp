@@ -0,0 +1,135 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "tfhe_random.h"
+
+using namespace std;
+
+namespace {
+    const uint32_t CHACHA_CONSTANTS[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+
+    inline uint32_t rotl32(uint32_t x, int32_t c) { return (x << c) | (x >> (32 - c)); }
+
+    // one quarter round on all the lanes (the inner loops vectorize)
+    inline void quarter_round(uint32_t (*x)[TfheRandomEngine::LANES], int32_t a, int32_t b, int32_t c, int32_t d) {
+        const int32_t L = TfheRandomEngine::LANES;
+        for (int32_t l = 0; l < L; l++) { x[a][l] += x[b][l]; x[d][l] = rotl32(x[d][l] ^ x[a][l], 16); }
+        for (int32_t l = 0; l < L; l++) { x[c][l] += x[d][l]; x[b][l] = rotl32(x[b][l] ^ x[c][l], 12); }
+        for (int32_t l = 0; l < L; l++) { x[a][l] += x[b][l]; x[d][l] = rotl32(x[d][l] ^ x[a][l], 8); }
+        for (int32_t l = 0; l < L; l++) { x[c][l] += x[d][l]; x[b][l] = rotl32(x[b][l] ^ x[c][l], 7); }
+    }
+}
+
+TfheRandomEngine::TfheRandomEngine() {
+    random_device device;
+    uint32_t new_key[KEY_WORDS];
+    for (int32_t i = 0; i < KEY_WORDS; i++) new_key[i] = device();
+    seed_key(new_key);
+}
+
+TfheRandomEngine::TfheRandomEngine(seed_seq &seeds) {
+    seed(seeds);
+}
+
+void TfheRandomEngine::seed(seed_seq &seeds) {
+    uint32_t new_key[KEY_WORDS];
+    seeds.generate(new_key, new_key + KEY_WORDS);
+    seed_key(new_key);
+}
+
+void TfheRandomEngine::seed_key(const uint32_t *new_key) {
+    memcpy(key, new_key, sizeof(key));
+    counter = 0;
+    buffer_pos = BUFFER_WORDS;
+    normal_pos = NORMAL_BUFFER;
+}
+
+void TfheRandomEngine::generate_blocks(uint32_t *out) {
+    uint32_t init[16][LANES];
+    uint32_t x[16][LANES];
+
+    for (int32_t l = 0; l < LANES; l++) {
+        const uint64_t block = counter + l;
+        for (int32_t i = 0; i < 4; i++) init[i][l] = CHACHA_CONSTANTS[i];
+        for (int32_t i = 0; i < KEY_WORDS; i++) init[4 + i][l] = key[i];
+        init[12][l] = uint32_t(block);
+        init[13][l] = uint32_t(block >> 32);
+        init[14][l] = 0;
+        init[15][l] = 0;
+    }
+    counter += LANES;
+    memcpy(x, init, sizeof(x));
+
+    for (int32_t round = 0; round < 10; round++) {
+        // column rounds
+        quarter_round(x, 0, 4, 8, 12);
+        quarter_round(x, 1, 5, 9, 13);
+        quarter_round(x, 2, 6, 10, 14);
+        quarter_round(x, 3, 7, 11, 15);
+        // diagonal rounds
+        quarter_round(x, 0, 5, 10, 15);
+        quarter_round(x, 1, 6, 11, 12);
+        quarter_round(x, 2, 7, 8, 13);
+        quarter_round(x, 3, 4, 9, 14);
+    }
+
+    for (int32_t l = 0; l < LANES; l++)
+        for (int32_t i = 0; i < 16; i++)
+            out[16 * l + i] = x[i][l] + init[i][l];
+}
+
+void TfheRandomEngine::discard(uint64_t nb_words) {
+    const uint64_t available = BUFFER_WORDS - buffer_pos;
+    if (nb_words <= available) {
+        buffer_pos += nb_words;
+        return;
+    }
+    nb_words -= available;
+    counter += (nb_words / BUFFER_WORDS) * LANES;
+    generate_blocks(buffer);
+    buffer_pos = nb_words % BUFFER_WORDS;
+}
+
+void TfheRandomEngine::fill(uint32_t *out, int32_t size) {
+    // first, use what remains in the buffer
+    const int32_t available = BUFFER_WORDS - buffer_pos;
+    const int32_t head = (size < available) ? size : available;
+    memcpy(out, buffer + buffer_pos, head * sizeof(uint32_t));
+    buffer_pos += head;
+    out += head;
+    size -= head;
+    // then, generate the full blocks directly in the output
+    while (size >= BUFFER_WORDS) {
+        generate_blocks(out);
+        out += BUFFER_WORDS;
+        size -= BUFFER_WORDS;
+    }
+    if (size > 0) {
+        generate_blocks(buffer);
+        memcpy(out, buffer, size * sizeof(uint32_t));
+        buffer_pos = size;
+    }
+}
+
+void TfheRandomEngine::fill_standard_normal(double *out, int32_t size) {
+    static const double two_pi = 6.283185307179586476925286766559;
+    static const double two_m53 = 1. / double(UINT64_C(1) << 53);
+    const int32_t CHUNK = 64; // number of pairs per batch
+    uint32_t words[4 * CHUNK];
+
+    for (int32_t pos = 0; pos < size; pos += 2 * CHUNK) {
+        const int32_t nb_pairs = std::min(CHUNK, (size - pos + 1) / 2);
+        fill(words, 4 * nb_pairs);
+        for (int32_t i = 0; i < nb_pairs; i++) {
+            // two uniform doubles, u1 in ]0,1] (so that the log is finite) and u2 in [0,1[
+            const uint64_t w1 = (uint64_t(words[4 * i]) << 32) | words[4 * i + 1];
+            const uint64_t w2 = (uint64_t(words[4 * i + 2]) << 32) | words[4 * i + 3];
+            const double u1 = double((w1 >> 11) + 1) * two_m53;
+            const double u2 = double(w2 >> 11) * two_m53;
+            const double r = sqrt(-2. * log(u1));
+            const double theta = two_pi * u2;
+            out[pos + 2 * i] = r * cos(theta);
+            if (pos + 2 * i + 1 < size) out[pos + 2 * i + 1] = r * sin(theta);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#include "tfhe.h"
+#include "tfhe_rom.h"
+
+using namespace std;
+
+
+namespace {
+    // the largest nu <= m such that 2^nu words of word_size bits fit in a polynomial
+    int32_t nb_low_bits(int32_t m, int32_t word_size, int32_t N) {
+        int32_t nu = 0;
+        while (nu < m && (word_size << (nu + 1)) <= N) nu++;
+        return nu;
+    }
+}
+
+TfheRom::TfheRom(const uint32_t *table, int32_t m, int32_t word_size, const TfheCircuitBootstrappingKey *cbk,
+                 int32_t nb_threads) :
+        cbk(cbk), m(m), word_size(word_size), nu(nb_low_bits(m, word_size, cbk->tgsw_params->tlwe_params->N)),
+        nb_threads(nb_threads > 0 ? nb_threads : tfhe_get_nb_threads()) {
+    const TGswParams *params = cbk->tgsw_params;
+    const TLweParams *tlwe_params = params->tlwe_params;
+    const int32_t N = tlwe_params->N;
+    const int32_t nb_polynomials = 1 << (m - nu);
+    static const Torus32 MU = modSwitchToTorus32(1, 8);
+
+    if (word_size > 32 || word_size > N) die_dramatically("the words of a ROM must fit in 32 bits and in a polynomial");
+    packed = new_TLweSample_array(nb_polynomials, tlwe_params);
+    TorusPolynomial *plaintext = new_TorusPolynomial(N);
+    for (int32_t p = 0; p < nb_polynomials; p++) {
+        torusPolynomialClear(plaintext);
+        for (int32_t w = 0; w < (1 << nu); w++) {
+            const uint32_t word = table[(p << nu) + w];
+            for (int32_t b = 0; b < word_size; b++) plaintext->coefsT[w * word_size + b] = ((word >> b) & 1) ? MU : -MU;
+        }
+        tLweNoiselessTrivial(packed + p, plaintext, tlwe_params);
+    }
+    delete_TorusPolynomial(plaintext);
+    tree = new_TfheCMuxTree(params, m - nu, this->nb_threads);
+    extprod = new_TGswFFTWorkspace(params);
+    acc = new_TLweSample(tlwe_params);
+    rotated = new_TLweSample(tlwe_params);
+    extracted = new_LweSample_array(word_size, &tlwe_params->extracted_lweparams);
+    reversed = new Torus32[2 * N];
+    address = new_TGswSampleFFT_array(m, params);
+}
+
+TfheRom::~TfheRom() {
+    delete_TGswSampleFFT_array(m, address);
+    delete[] reversed;
+    delete_LweSample_array(word_size, extracted);
+    delete_TLweSample(rotated);
+    delete_TLweSample(acc);
+    delete_TGswFFTWorkspace(extprod);
+    delete_TfheCMuxTree(tree);
+    delete_TLweSample_array(1 << (m - nu), packed);
+}
+
+EXPORT TfheRom *new_TfheRom(const uint32_t *table, int32_t m, int32_t word_size,
+                            const TfheCircuitBootstrappingKey *cbk, int32_t nb_threads) {
+    return new TfheRom(table, m, word_size, cbk, nb_threads);
+}
+
+EXPORT void delete_TfheRom(TfheRom *rom) {
+    delete rom;
+}
+
+
+EXPORT void tfhe_rom_read(LweSample *result, TfheRom *rom, const TGswSampleFFT *address) {
+    const TGswParams *params = rom->cbk->tgsw_params;
+    const TLweParams *tlwe_params = params->tlwe_params;
+    const int32_t _2N = 2 * tlwe_params->N;
+    const LweKeySwitchKey *ks = rom->cbk->bk->bkFFT->ks;
+
+    // the high bits select the polynomial
+    tfhe_cmuxTree(rom->acc, rom->tree, address + rom->nu, rom->packed);
+    // the low bits rotate the word to the constant coefficient: acc = address[i] ? X^-(2^i.word_size).acc : acc
+    for (int32_t i = 0; i < rom->nu; i++) {
+        tLweMulByXaiMinusOne(rom->rotated, _2N - (rom->word_size << i), rom->acc, tlwe_params);
+        tGswFFTExternMulToTLwe(rom->rotated, address + i, *rom->extprod);
+        tLweAddTo(rom->acc, rom->rotated, tlwe_params);
+    }
+    tLweExtractLweSamples(rom->extracted, rom->acc, 0, rom->word_size, &tlwe_params->extracted_lweparams, tlwe_params,
+                          rom->reversed);
+    // one task per bit of the word
+    tfhe_parallel_for(rom->word_size, [&](int32_t b) {
+        lweKeySwitch(result + b, ks, rom->extracted + b);
+    }, rom->nb_threads);
+}
+
+EXPORT void tfhe_rom_read_bits(LweSample *result, TfheRom *rom, const LweSample *address) {
+    for (int32_t i = 0; i < rom->m; i++) tfhe_circuitBootstrap_FFT(rom->address + i, rom->cbk, address + i);
+    tfhe_rom_read(result, rom, rom->address);
+}
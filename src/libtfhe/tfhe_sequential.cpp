@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <vector>
+#include "tfhe.h"
+#include "tfhe_sequential.h"
+
+using namespace std;
+
+
+TfheSequentialEngine::TfheSequentialEngine(const TfheNetlist *netlist, const TFheGateBootstrappingCloudKeySet *bk,
+                                           int32_t nb_threads, int32_t window) :
+        netlist(netlist), bk(bk), nb_threads(nb_threads), window(window > 0 ? window : 2),
+        creation_time(tfhe_steady_time()), executors(this->window + 1, 0), cycle_of_gate(this->window + 1),
+        register_of_wire(netlist->nb_wires, -1) {
+    const LweParams *params = bk->params->in_out_params;
+    const int32_t nb_registers = netlist->registers.size();
+    state = new_LweSample_array(nb_registers, params);
+    next_state = new_LweSample_array(nb_registers, params);
+    for (int32_t c = 0; c < this->window; c++) wires.push_back(new_LweSample_array(netlist->nb_wires, params));
+    outputs = new_LweSample_array(this->window * netlist->outputs.size(), params);
+    for (int32_t r = 0; r < nb_registers; r++) register_of_wire[netlist->registers[r].q] = r;
+    for (int32_t r = 0; r < nb_registers; r++) bootsCONSTANT(state + r, netlist->registers[r].init, bk);
+}
+
+TfheSequentialEngine::~TfheSequentialEngine() {
+    const int32_t nb_registers = netlist->registers.size();
+    for (TfheGateExecutor *executor: executors) delete executor;
+    delete_LweSample_array(window * netlist->outputs.size(), outputs);
+    for (LweSample *cycle_wires: wires) delete_LweSample_array(netlist->nb_wires, cycle_wires);
+    delete_LweSample_array(nb_registers, next_state);
+    delete_LweSample_array(nb_registers, state);
+}
+
+LweSample *TfheSequentialEngine::sample(int32_t cycle, int32_t wire) {
+    const int32_t r = register_of_wire[wire];
+    if (r < 0) return wires[cycle] + wire;
+    // the register holds the value of d at the previous cycle
+    if (cycle == 0) return state + r;
+    return sample(cycle - 1, netlist->registers[r].d);
+}
+
+TfheGateExecutor *TfheSequentialEngine::executor(int32_t nb_cycles) {
+    if (executors[nb_cycles] != 0) return executors[nb_cycles];
+    TfheGateExecutor *result = new TfheGateExecutor(bk);
+    vector<int32_t> &cycles = cycle_of_gate[nb_cycles];
+    const int32_t nb_outputs = netlist->outputs.size();
+    const int32_t nb_registers = netlist->registers.size();
+
+    // the dependencies between the cycles are deduced from the samples by the executor
+    for (int32_t c = 0; c < nb_cycles; c++) {
+        for (const TfheNetlistGate &g: netlist->gates) {
+            result->add_gate(g.type, wires[c] + g.out, g.in[0] >= 0 ? sample(c, g.in[0]) : 0,
+                             g.in[1] >= 0 ? sample(c, g.in[1]) : 0, g.in[2] >= 0 ? sample(c, g.in[2]) : 0, g.value);
+            cycles.push_back(c);
+        }
+        for (int32_t i = 0; i < nb_outputs; i++) {
+            result->add_gate(TFHE_GATE_COPY, outputs + c * nb_outputs + i, sample(c, netlist->outputs[i]), 0, 0);
+            cycles.push_back(c);
+        }
+    }
+    // in two steps, since the next value of a register may be the current value of another one
+    for (int32_t r = 0; r < nb_registers; r++) {
+        result->add_gate(TFHE_GATE_COPY, next_state + r, sample(nb_cycles - 1, netlist->registers[r].d), 0, 0);
+        cycles.push_back(nb_cycles - 1);
+    }
+    for (int32_t r = 0; r < nb_registers; r++) {
+        result->add_gate(TFHE_GATE_COPY, state + r, next_state + r, 0, 0);
+        cycles.push_back(nb_cycles - 1);
+    }
+    result->record_times = true;
+    executors[nb_cycles] = result;
+    return result;
+}
+
+void TfheSequentialEngine::run(LweSample *outputs, const LweSample *inputs, int32_t nb_cycles) {
+    const LweParams *params = bk->params->in_out_params;
+    const int32_t nb_inputs = netlist->inputs.size();
+    const int32_t nb_outputs = netlist->outputs.size();
+
+    for (int32_t first = 0; first < nb_cycles; first += window) {
+        const int32_t length = min(window, nb_cycles - first);
+        TfheGateExecutor *unrolled = executor(length);
+        for (int32_t c = 0; c < length; c++) {
+            for (int32_t i = 0; i < nb_inputs; i++)
+                lweCopy(wires[c] + netlist->inputs[i], inputs + (first + c) * nb_inputs + i, params);
+        }
+
+        const double start = tfhe_steady_time() - creation_time;
+        unrolled->run(nb_threads);
+        const size_t first_stats = stats.size();
+        for (int32_t c = 0; c < length; c++) stats.push_back(TfheCycleStats{start, start});
+        const vector<int32_t> &cycles = cycle_of_gate[length];
+        vector<bool> started(length, false);
+        for (int32_t g = 0; g < int32_t(cycles.size()); g++) {
+            TfheCycleStats &cycle = stats[first_stats + cycles[g]];
+            const double gate_start = unrolled->start_times[g] - creation_time;
+            const double gate_end = unrolled->end_times[g] - creation_time;
+            cycle.start = started[cycles[g]] ? min(cycle.start, gate_start) : gate_start;
+            cycle.end = started[cycles[g]] ? max(cycle.end, gate_end) : gate_end;
+            started[cycles[g]] = true;
+        }
+
+        for (int32_t i = 0; i < length * nb_outputs; i++)
+            lweCopy(outputs + first * nb_outputs + i, this->outputs + i, params);
+    }
+}
+
+
+EXPORT TfheSequentialEngine *new_TfheSequentialEngine(const TfheNetlist *netlist,
+                                                      const TFheGateBootstrappingCloudKeySet *bk,
+                                                      int32_t nb_threads, int32_t window) {
+    return new TfheSequentialEngine(netlist, bk, nb_threads, window);
+}
+
+EXPORT void delete_TfheSequentialEngine(TfheSequentialEngine *engine) {
+    delete engine;
+}
+
+EXPORT LweSample *tfhe_sequential_state(TfheSequentialEngine *engine) {
+    return engine->state;
+}
+
+EXPORT void tfhe_sequential_reset(TfheSequentialEngine *engine) {
+    const vector<TfheNetlistRegister> &registers = engine->netlist->registers;
+    for (int32_t r = 0; r < int32_t(registers.size()); r++) bootsCONSTANT(engine->state + r, registers[r].init, engine->bk);
+}
+
+EXPORT void tfhe_sequential_run(TfheSequentialEngine *engine, LweSample *outputs, const LweSample *inputs,
+                                int32_t nb_cycles) {
+    engine->run(outputs, inputs, nb_cycles);
+}
+
+EXPORT int32_t tfhe_sequential_nb_cycles(const TfheSequentialEngine *engine) {
+    return engine->stats.size();
+}
+
+EXPORT TfheCycleStats tfhe_sequential_cycle_stats(const TfheSequentialEngine *engine, int32_t cycle) {
+    return engine->stats[cycle];
+}
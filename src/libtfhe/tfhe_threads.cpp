@@ -0,0 +1,131 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "tfhe_numa.h"
+#include "tfhe_threads.h"
+
+using namespace std;
+
+static atomic<int32_t> tfhe_nb_threads(0);
+static atomic<int32_t> tfhe_nb_gate_threads(1);
+
+EXPORT void tfhe_set_nb_threads(int32_t nb_threads) {
+    tfhe_nb_threads = (nb_threads < 0) ? 0 : nb_threads;
+}
+
+EXPORT int32_t tfhe_get_nb_threads() {
+    const int32_t nb_threads = tfhe_nb_threads;
+    if (nb_threads > 0) return nb_threads;
+    const int32_t nb_cores = thread::hardware_concurrency();
+    return (nb_cores > 0) ? nb_cores : 1;
+}
+
+EXPORT void tfhe_set_nb_gate_threads(int32_t nb_threads) {
+    tfhe_nb_gate_threads = (nb_threads < 0) ? 0 : nb_threads;
+}
+
+EXPORT int32_t tfhe_get_nb_gate_threads() {
+    const int32_t nb_threads = tfhe_nb_gate_threads;
+    return (nb_threads > 0) ? nb_threads : tfhe_get_nb_threads();
+}
+
+
+// set in the threads which execute the tasks of a loop, to run the nested calls inline
+static thread_local bool tfhe_in_team_task = false;
+
+TfheThreadTeam::TfheThreadTeam() :
+        generation(0), next_task(0), nb_running(0),
+        task(0), nb_tasks(0), nb_active(0), stopping(false) {
+}
+
+TfheThreadTeam::~TfheThreadTeam() {
+    {
+        lock_guard<mutex> lock(wake_mutex);
+        stopping = true;
+        generation++;
+    }
+    wake_cv.notify_all();
+    for (thread &th: workers) th.join();
+}
+
+void TfheThreadTeam::grow(int32_t nb_workers) {
+    lock_guard<mutex> lock(wake_mutex);
+    while (int32_t(workers.size()) < nb_workers) {
+        const int32_t index = workers.size() + 1;
+        workers.emplace_back(&TfheThreadTeam::worker_loop, this, index, generation.load());
+    }
+}
+
+void TfheThreadTeam::worker_loop(int32_t index, uint64_t seen) {
+    tfhe_in_team_task = true;
+    bool bound = false;
+    while (true) {
+        // wait for the next run: spin for a while, then sleep
+        for (int32_t s = 0; s < SPIN_ITERATIONS && generation.load(memory_order_acquire) == seen; s++)
+            this_thread::yield();
+        if (generation.load(memory_order_acquire) == seen) {
+            unique_lock<mutex> lock(wake_mutex);
+            wake_cv.wait(lock, [&] { return generation.load() != seen; });
+        }
+        seen = generation.load(memory_order_acquire);
+        if (stopping) return;
+        // with the replication of the keys, the worker is bound to its node once, for its lifetime
+        if (!bound && tfhe_get_numa_replication()) {
+            tfhe_numa_bind_thread(tfhe_numa_node_of_worker(index, tfhe_get_nb_threads()));
+            bound = true;
+        }
+        if (index < nb_active) work();
+        if (--nb_running == 0) {
+            lock_guard<mutex> lock(wake_mutex);
+            done_cv.notify_one();
+        }
+    }
+}
+
+void TfheThreadTeam::work() {
+    for (int32_t i = next_task++; i < nb_tasks; i = next_task++) (*task)(i);
+}
+
+void TfheThreadTeam::run(int32_t nb_tasks, const function<void(int32_t)> &task, int32_t nb_threads) {
+    if (nb_threads <= 0) nb_threads = tfhe_get_nb_threads();
+    if (nb_threads > nb_tasks) nb_threads = nb_tasks;
+
+    // sequential case (or nested/concurrent call): run everything in the calling thread
+    unique_lock<mutex> run_lock(run_mutex, defer_lock);
+    if (nb_threads <= 1 || tfhe_in_team_task || !run_lock.try_lock()) {
+        for (int32_t i = 0; i < nb_tasks; i++) task(i);
+        return;
+    }
+
+    grow(nb_threads - 1);
+    this->task = &task;
+    this->nb_tasks = nb_tasks;
+    this->nb_active = nb_threads;
+    next_task = 0;
+    nb_running = workers.size();
+    {
+        lock_guard<mutex> lock(wake_mutex);
+        generation++;
+    }
+    wake_cv.notify_all();
+    tfhe_in_team_task = true;
+    work();
+    tfhe_in_team_task = false;
+
+    // wait until all the workers are done
+    for (int32_t s = 0; s < SPIN_ITERATIONS && nb_running.load(memory_order_acquire) != 0; s++)
+        this_thread::yield();
+    if (nb_running.load(memory_order_acquire) != 0) {
+        unique_lock<mutex> lock(wake_mutex);
+        done_cv.wait(lock, [&] { return nb_running.load() == 0; });
+    }
+}
+
+TfheThreadTeam &tfhe_thread_team() {
+    static TfheThreadTeam team;
+    return team;
+}
+
+void tfhe_parallel_for(int32_t nb_tasks, const function<void(int32_t)> &task, int32_t nb_threads) {
+    tfhe_thread_team().run(nb_tasks, task, nb_threads);
+}
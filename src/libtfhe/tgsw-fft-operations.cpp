@@ -85,32 +85,48 @@ EXPORT void tGswFFTClear(TGswSampleFFT *result, const TGswParams *params) {
         tLweFFTClear(result->all_samples + p, params->tlwe_params);
 }
 
-// External product (*): accum = gsw (*) accum 
-EXPORT void tGswFFTExternMulToTLwe(TLweSample *accum, const TGswSampleFFT *gsw, const TGswParams *params) {
+TGswFFTWorkspace *new_TGswFFTWorkspace(const TGswParams *params) {
+    const int32_t N = params->tlwe_params->N;
+    TGswFFTWorkspace *ws = new TGswFFTWorkspace;
+    ws->params = params;
+    ws->deca = new_IntPolynomial_array(params->kpl, N);
+    ws->decaFFT = new_LagrangeHalfCPolynomial_array(params->kpl, N);
+    ws->tmpa = new_TLweSampleFFT(params->tlwe_params);
+    return ws;
+}
+
+void delete_TGswFFTWorkspace(TGswFFTWorkspace *ws) {
+    delete_TLweSampleFFT(ws->tmpa);
+    delete_LagrangeHalfCPolynomial_array(ws->params->kpl, ws->decaFFT);
+    delete_IntPolynomial_array(ws->params->kpl, ws->deca);
+    delete ws;
+}
+
+// External product (*): accum = gsw (*) accum, with the polynomials of the workspace
+void tGswFFTExternMulToTLwe(TLweSample *accum, const TGswSampleFFT *gsw, TGswFFTWorkspace &ws) {
+    const TGswParams *params = ws.params;
     const TLweParams *tlwe_params = params->tlwe_params;
     const int32_t k = tlwe_params->k;
     const int32_t l = params->l;
     const int32_t kpl = params->kpl;
-    const int32_t N = tlwe_params->N;
-    //TODO attention, improve these new/delete...
-    IntPolynomial *deca = new_IntPolynomial_array(kpl, N); //decomposed accumulator
-    LagrangeHalfCPolynomial *decaFFT = new_LagrangeHalfCPolynomial_array(kpl, N); //fft version
-    TLweSampleFFT *tmpa = new_TLweSampleFFT(tlwe_params);
 
     for (int32_t i = 0; i <= k; i++)
-        tGswTorus32PolynomialDecompH(deca + i * l, accum->a + i, params);
+        tGswTorus32PolynomialDecompH(ws.deca + i * l, accum->a + i, params);
     for (int32_t p = 0; p < kpl; p++)
-        IntPolynomial_ifft(decaFFT + p, deca + p);
+        IntPolynomial_ifft(ws.decaFFT + p, ws.deca + p);
 
-    tLweFFTClear(tmpa, tlwe_params);
+    tLweFFTClear(ws.tmpa, tlwe_params);
     for (int32_t p = 0; p < kpl; p++) {
-        tLweFFTAddMulRTo(tmpa, decaFFT + p, gsw->all_samples + p, tlwe_params);
+        tLweFFTAddMulRTo(ws.tmpa, ws.decaFFT + p, gsw->all_samples + p, tlwe_params);
     }
-    tLweFromFFTConvert(accum, tmpa, tlwe_params);
+    tLweFromFFTConvert(accum, ws.tmpa, tlwe_params);
+}
 
-    delete_TLweSampleFFT(tmpa);
-    delete_LagrangeHalfCPolynomial_array(kpl, decaFFT);
-    delete_IntPolynomial_array(kpl, deca);
+// External product (*): accum = gsw (*) accum 
+EXPORT void tGswFFTExternMulToTLwe(TLweSample *accum, const TGswSampleFFT *gsw, const TGswParams *params) {
+    TGswFFTWorkspace *ws = new_TGswFFTWorkspace(params);
+    tGswFFTExternMulToTLwe(accum, gsw, *ws);
+    delete_TGswFFTWorkspace(ws);
 }
 
 // result = (X^ai -1)*bki  
@@ -15,11 +15,9 @@ using namespace std;
 EXPORT void tLweKeyGen(TLweKey *result) {
     const int32_t N = result->params->N;
     const int32_t k = result->params->k;
-    uniform_int_distribution<int32_t> distribution(0, 1);
 
     for (int32_t i = 0; i < k; ++i)
-        for (int32_t j = 0; j < N; ++j)
-            result->key[i].coefs[j] = distribution(generator);
+        uniformBinary_array(result->key[i].coefs, N);
 }
 
 /*create an homogeneous tlwe sample*/
@@ -27,8 +25,7 @@ EXPORT void tLweSymEncryptZero(TLweSample *result, double alpha, const TLweKey *
     const int32_t N = key->params->N;
     const int32_t k = key->params->k;
 
-    for (int32_t j = 0; j < N; ++j)
-        result->b->coefsT[j] = gaussian32(0, alpha);
+    gaussian32_array(result->b->coefsT, NULL, N, alpha);
 
     for (int32_t i = 0; i < k; ++i) {
         torusPolynomialUniform(&result->a[i]);
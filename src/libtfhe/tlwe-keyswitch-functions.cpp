@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include "lwekey.h"
+#include "lwesamples.h"
+#include "tlwe_functions.h"
+#include "tlwekeyswitch.h"
+#include "numeric_functions.h"
+#include "polynomials_arithmetic.h"
+#include "lagrangehalfc_arithmetic.h"
+#include "tfhe_threads.h"
+
+using namespace std;
+
+
+LweToTLweKeySwitchKey::LweToTLweKeySwitchKey(int32_t n, int32_t t, int32_t basebit, const TLweParams* out_params) :
+        n(n), t(t), basebit(basebit), base(1 << basebit), out_params(out_params), current_variance(0) {
+    ks = new_TLweSample_array((n + 1) * t, out_params);
+}
+
+LweToTLweKeySwitchKey::~LweToTLweKeySwitchKey() {
+    delete_TLweSample_array((n + 1) * t, ks);
+}
+
+
+/*
+ * The entry (i,j) encrypts P(X).s[i]/base^(j+1), with s[n]=-1 for the b of the input.
+ * Storing only the digit 1 keeps the key (n+1).t TLwe samples large: the keyswitch
+ * multiplies each entry by its digit instead of looking up the entry of the digit.
+ */
+EXPORT void tLweCreateFunctionalKeySwitchKey(LweToTLweKeySwitchKey* result, const LweKey* in_key, const IntPolynomial* P,
+                                             const TLweKey* out_key) {
+    const int32_t n = result->n;
+    const int32_t t = result->t;
+    const int32_t basebit = result->basebit;
+    const int32_t N = out_key->params->N;
+    const double alpha = out_key->params->alpha_min;
+
+    // one task per input coefficient, each with its own random stream
+    TfheRandomStreams streams(n + 1);
+    tfhe_parallel_for(n + 1, [&](int32_t i) {
+        streams.use_stream(i);
+        TorusPolynomial* message = new_TorusPolynomial(N);
+        const int32_t si = (i < n) ? in_key->key[i] : -1;
+        for (int32_t j = 0; j < t; ++j) {
+            const Torus32 x = si * (1 << (32 - (j + 1) * basebit));
+            for (int32_t c = 0; c < N; ++c) message->coefsT[c] = P->coefs[c] * x;
+            tLweSymEncrypt(result->entry(i, j), message, alpha, out_key);
+        }
+        delete_TorusPolynomial(message);
+    });
+    result->current_variance = alpha * alpha;
+}
+
+
+/*
+ * result = -sum(a[i].entry(i)) for 0<=i<=n, where a[n]=b: each a[i] is rounded to
+ * t digits of basebit bits, and the entry (i,j) is multiplied by the j-th digit
+ */
+EXPORT void tLweFunctionalKeySwitch(TLweSample* result, const LweToTLweKeySwitchKey* ks, const LweSample* sample) {
+    const int32_t n = ks->n;
+    const int32_t t = ks->t;
+    const int32_t basebit = ks->basebit;
+    const int32_t prec_offset = 1 << (32 - (1 + basebit * t)); //precision
+    const int32_t mask = ks->base - 1;
+
+    tLweClear(result, ks->out_params);
+    for (int32_t i = 0; i <= n; ++i) {
+        const uint32_t aibar = ((i < n) ? sample->a[i] : sample->b) + prec_offset;
+        for (int32_t j = 0; j < t; ++j) {
+            const int32_t aij = (aibar >> (32 - (j + 1) * basebit)) & mask;
+            if (aij != 0) tLweSubMulTo(result, aij, ks->entry(i, j), ks->out_params);
+        }
+    }
+}
+
+
+EXPORT void tLweCreateKeySwitchKey(LweToTLweKeySwitchKey* result, const LweKey* in_key, const TLweKey* out_key) {
+    const int32_t N = out_key->params->N;
+    IntPolynomial* one = new_IntPolynomial(N);
+    for (int32_t i = 0; i < N; ++i) one->coefs[i] = (i == 0);
+    tLweCreateFunctionalKeySwitchKey(result, in_key, one, out_key);
+    delete_IntPolynomial(one);
+}
+
+
+namespace {
+    // above this number of samples, the digits of an input coefficient are multiplied by the entries in the fft domain
+    const int32_t PACKING_FFT_THRESHOLD = 32;
+
+    // result -= d.X^q.sample, for 0<=q<N
+    void tLweSubMulXaiTo(TLweSample* result, int32_t d, int32_t q, const TLweSample* sample, const TLweParams* params) {
+        const int32_t N = params->N;
+        assert(q >= 0 && q < N);
+        for (int32_t u = 0; u <= params->k; ++u) {
+            Torus32* r = result->a[u].coefsT;
+            const Torus32* s = sample->a[u].coefsT;
+            for (int32_t c = 0; c < N - q; ++c) r[c + q] -= d * s[c];
+            for (int32_t c = N - q; c < N; ++c) r[c + q - N] += d * s[c];
+        }
+    }
+
+    // the digit polynomials: D[j] = sum(X^q.digit(q,i,j)) for 0<=q<nb_samples, with a[n]=b
+    void packing_digits(IntPolynomial* D, const LweToTLweKeySwitchKey* ks, const LweSample* samples,
+                        int32_t nb_samples, int32_t i) {
+        const int32_t n = ks->n;
+        const int32_t t = ks->t;
+        const int32_t basebit = ks->basebit;
+        const int32_t prec_offset = 1 << (32 - (1 + basebit * t)); //precision
+        const int32_t mask = ks->base - 1;
+        for (int32_t q = 0; q < nb_samples; ++q) {
+            const uint32_t aibar = ((i < n) ? samples[q].a[i] : samples[q].b) + prec_offset;
+            for (int32_t j = 0; j < t; ++j) D[j].coefs[q] = (aibar >> (32 - (j + 1) * basebit)) & mask;
+        }
+    }
+}
+
+/*
+ * result = -sum(D[i][j].entry(i,j)), where D[i][j] packs the digits (i,j) of the samples.
+ * Few samples are rotated and subtracted one by one; for many samples, each D[i][j] is multiplied
+ * by its entry with fft products, which costs (k+1)(t+1)+t ffts per input coefficient whatever the
+ * number of samples. The input coefficients are split between the threads, which sum their results.
+ */
+EXPORT void tLwePackingKeySwitch(TLweSample* result, const LweToTLweKeySwitchKey* ks, const LweSample* samples,
+                                 int32_t nb_samples, int32_t nb_threads) {
+    const TLweParams* params = ks->out_params;
+    const int32_t n = ks->n;
+    const int32_t t = ks->t;
+    const int32_t k = params->k;
+    const int32_t N = params->N;
+    // the sample q is packed at the offset X^q, in the N coefficients of the result
+    assert(nb_samples >= 0 && nb_samples <= N);
+    if (nb_threads <= 0) nb_threads = tfhe_get_nb_threads();
+    const int32_t nb_workers = min(nb_threads, n + 1);
+    const bool use_fft = nb_samples > PACKING_FFT_THRESHOLD;
+
+    TLweSample* partial = new_TLweSample_array(nb_workers, params);
+    tfhe_parallel_for(nb_workers, [&](int32_t w) {
+        TLweSample* acc = partial + w;
+        IntPolynomial* D = new_IntPolynomial_array(t, N);
+        LagrangeHalfCPolynomial* DFFT = new_LagrangeHalfCPolynomial_array(t, N);
+        LagrangeHalfCPolynomial* entryFFT = new_LagrangeHalfCPolynomial(N);
+        LagrangeHalfCPolynomial* accFFT = new_LagrangeHalfCPolynomial(N);
+        TorusPolynomial* temp = new_TorusPolynomial(N);
+        for (int32_t j = 0; j < t; ++j) intPolynomialClear(D + j);
+
+        tLweClear(acc, params);
+        for (int32_t i = w; i <= n; i += nb_workers) {
+            packing_digits(D, ks, samples, nb_samples, i);
+            if (use_fft) {
+                for (int32_t j = 0; j < t; ++j) IntPolynomial_ifft(DFFT + j, D + j);
+                for (int32_t u = 0; u <= k; ++u) {
+                    LagrangeHalfCPolynomialClear(accFFT);
+                    for (int32_t j = 0; j < t; ++j) {
+                        TorusPolynomial_ifft(entryFFT, ks->entry(i, j)->a + u);
+                        LagrangeHalfCPolynomialAddMul(accFFT, DFFT + j, entryFFT);
+                    }
+                    TorusPolynomial_fft(temp, accFFT);
+                    torusPolynomialSubTo(acc->a + u, temp);
+                }
+            } else {
+                for (int32_t q = 0; q < nb_samples; ++q)
+                    for (int32_t j = 0; j < t; ++j)
+                        if (D[j].coefs[q] != 0) tLweSubMulXaiTo(acc, D[j].coefs[q], q, ks->entry(i, j), params);
+            }
+        }
+
+        delete_TorusPolynomial(temp);
+        delete_LagrangeHalfCPolynomial(accFFT);
+        delete_LagrangeHalfCPolynomial(entryFFT);
+        delete_LagrangeHalfCPolynomial_array(t, DFFT);
+        delete_IntPolynomial_array(t, D);
+    }, nb_workers);
+
+    tLweCopy(result, partial, params);
+    for (int32_t w = 1; w < nb_workers; ++w) tLweAddTo(result, partial + w, params);
+    delete_TLweSample_array(nb_workers, partial);
+}
+
+
+/**
+ * LweToTLweKeySwitchKey constructor function
+ */
+EXPORT void init_LweToTLweKeySwitchKey(LweToTLweKeySwitchKey* obj, int32_t n, int32_t t, int32_t basebit, const TLweParams* out_params) {
+    new(obj) LweToTLweKeySwitchKey(n, t, basebit, out_params);
+}
+
+/**
+ * LweToTLweKeySwitchKey destructor
+ */
+EXPORT void destroy_LweToTLweKeySwitchKey(LweToTLweKeySwitchKey* obj) {
+    obj->~LweToTLweKeySwitchKey();
+}
+
+EXPORT LweToTLweKeySwitchKey* new_LweToTLweKeySwitchKey(int32_t n, int32_t t, int32_t basebit, const TLweParams* out_params) {
+    return new_LweToTLweKeySwitchKey_array(1, n, t, basebit, out_params);
+}
+
+EXPORT LweToTLweKeySwitchKey* new_LweToTLweKeySwitchKey_array(int32_t nbelts, int32_t n, int32_t t, int32_t basebit, const TLweParams* out_params) {
+    LweToTLweKeySwitchKey* obj = (LweToTLweKeySwitchKey*) malloc(nbelts * sizeof(LweToTLweKeySwitchKey));
+    for (int32_t i = 0; i < nbelts; i++) init_LweToTLweKeySwitchKey(obj + i, n, t, basebit, out_params);
+    return obj;
+}
+
+EXPORT void delete_LweToTLweKeySwitchKey(LweToTLweKeySwitchKey* obj) {
+    delete_LweToTLweKeySwitchKey_array(1, obj);
+}
+
+EXPORT void delete_LweToTLweKeySwitchKey_array(int32_t nbelts, LweToTLweKeySwitchKey* obj) {
+    for (int32_t i = 0; i < nbelts; i++) destroy_LweToTLweKeySwitchKey(obj + i);
+    free(obj);
+}
@@ -18,8 +18,7 @@ EXPORT void torusPolynomialUniform(TorusPolynomial *result) {
     const int32_t N = result->N;
     Torus32 *x = result->coefsT;
 
-    for (int32_t i = 0; i < N; ++i)
-        x[i] = uniformTorus32_distrib(generator);
+    uniformTorus32_array(x, N);
 }
 
 // TorusPolynomial = TorusPolynomial
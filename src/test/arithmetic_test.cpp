@@ -12,8 +12,13 @@ namespace {
 	    //virtual ~ArithmeticTest() {} // You can do clean-up work that doesn't throw exceptions here.
 	    //// If the constructor and destructor are not enough for setting up
 	    //// and cleaning up each test, you can define the following methods:
-	    //virtual void SetUp() {}
 	    //virtual void TearDown() {}
+
+	    // a fixed seed, so that the statistical tests below are reproducible
+	    virtual void SetUp() {
+		seed_seq seeds = {42};
+		generator.seed(seeds);
+	    }
     };
 
     //this function return the absolute value of the (centered) fractional part of d
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <vector>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    class AsyncTest : public ::testing::Test {
+    public:
+        const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+        const TFheGateBootstrappingCloudKeySet *bk = &key->cloud;
+        const TFheGateBootstrappingParameterSet *params = key->params;
+
+        static void count_callback(void *user_data) {
+            (*(atomic<int32_t> *) user_data)++;
+        }
+    };
+
+    //a chain of dependent gates (with in-place updates) can be submitted without waiting
+    TEST_F(AsyncTest, dependentGatesWithFutures) {
+        LweSample *x = new_gate_bootstrapping_ciphertext_array(4, params);
+        TfheAsyncEngine engine(bk, 3);
+        for (int32_t m = 0; m < 4; m++) {
+            const int32_t a = m & 1, b = (m >> 1) & 1;
+            bootsSymEncrypt(x, a, key);
+            bootsSymEncrypt(x + 1, b, key);
+            engine.submit(TFHE_GATE_XOR, x + 2, x, x + 1, 0);       // a^b
+            engine.submit(TFHE_GATE_AND, x + 3, x + 2, x, 0);       // (a^b)&a
+            engine.submit(TFHE_GATE_NOT, x, x + 3, 0, 0);           // x is overwritten after its readers
+            engine.submit(TFHE_GATE_OR, x + 3, x + 3, x + 1, 0);    // in place
+            future<void> last = engine.submit(TFHE_GATE_MUX, x + 1, x + 2, x, x + 3);
+            last.wait();
+            const int32_t x2 = a ^ b, x3 = x2 & a, x0 = 1 - x3, y3 = x3 | b;
+            ASSERT_EQ(x2 ? x0 : y3, bootsSymDecrypt(x + 1, key));
+            ASSERT_EQ(x0, bootsSymDecrypt(x, key));
+            ASSERT_EQ(y3, bootsSymDecrypt(x + 3, key));
+        }
+        engine.wait_all();
+        ASSERT_EQ(0, engine.nb_pending());
+        delete_gate_bootstrapping_ciphertext_array(4, x);
+    }
+
+    TEST_F(AsyncTest, completionQueueAndCallbacks) {
+        static const int32_t NB_GATES = 16;
+        LweSample *in = new_gate_bootstrapping_ciphertext_array(2, params);
+        LweSample *out = new_gate_bootstrapping_ciphertext_array(NB_GATES, params);
+        bootsSymEncrypt(in, 1, key);
+        bootsSymEncrypt(in + 1, 0, key);
+
+        TfheAsyncEngine *engine = new_TfheAsyncEngine(bk, 2);
+        TfheCompletionQueue *queue = new_TfheCompletionQueue();
+        uint64_t tag;
+        ASSERT_EQ(0, tfhe_completion_queue_poll(queue, &tag));
+        for (int32_t i = 0; i < NB_GATES; i++)
+            tfhe_async_submit_to_queue(engine, TFHE_GATE_NAND, out + i, in, in + (i % 2), 0, 0, queue, 100 + i);
+        set<uint64_t> tags;
+        for (int32_t i = 0; i < NB_GATES; i++) tags.insert(tfhe_completion_queue_wait(queue));
+        ASSERT_EQ(NB_GATES, int32_t(tags.size()));
+        ASSERT_EQ(100u, *tags.begin());
+        ASSERT_EQ(0, tfhe_completion_queue_poll(queue, &tag));
+        for (int32_t i = 0; i < NB_GATES; i++) ASSERT_EQ(i % 2, bootsSymDecrypt(out + i, key));
+
+        atomic<int32_t> nb_done(0);
+        for (int32_t i = 0; i < NB_GATES; i++)
+            tfhe_async_submit(engine, TFHE_GATE_AND, out + i, in, in + (i % 2), 0, 0, count_callback, &nb_done);
+        tfhe_async_submit(engine, TFHE_GATE_CONSTANT, out, 0, 0, 0, 1, 0, 0);
+        tfhe_async_wait_all(engine);
+        ASSERT_EQ(0, tfhe_async_nb_pending(engine));
+        ASSERT_EQ(NB_GATES, nb_done.load());
+        ASSERT_EQ(1, bootsSymDecrypt(out, key));
+        for (int32_t i = 1; i < NB_GATES; i++) ASSERT_EQ(1 - i % 2, bootsSymDecrypt(out + i, key));
+
+        delete_TfheCompletionQueue(queue);
+        delete_TfheAsyncEngine(engine);
+        delete_gate_bootstrapping_ciphertext_array(NB_GATES, out);
+        delete_gate_bootstrapping_ciphertext_array(2, in);
+    }
+
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "tfhe.h"
+
+using namespace std;
+
+namespace {
+
+    class BootsEncryptTest : public ::testing::Test {
+    public:
+        static const TFheGateBootstrappingParameterSet *params;
+        static const TFheGateBootstrappingSecretKeySet *key;
+
+        //secret keyset without bootstrapping key: only the lwe key is needed to encrypt and decrypt
+        //(and the tlwe key to pack)
+        static const TFheGateBootstrappingSecretKeySet *new_lwe_only_keyset(const TFheGateBootstrappingParameterSet *params) {
+            LweKey *lwe_key = new_LweKey(params->in_out_params);
+            lweKeyGen(lwe_key);
+            TGswKey *tgsw_key = new_TGswKey(params->tgsw_params);
+            tGswKeyGen(tgsw_key);
+            return new TFheGateBootstrappingSecretKeySet(params, 0, 0, lwe_key, tgsw_key);
+        }
+    };
+
+    const TFheGateBootstrappingParameterSet *BootsEncryptTest::params = new_default_gate_bootstrapping_parameters(110);
+    const TFheGateBootstrappingSecretKeySet *BootsEncryptTest::key = new_lwe_only_keyset(params);
+
+    TEST_F(BootsEncryptTest, arrayEncryptDecrypt) {
+        static const int32_t NB_BITS = 2000;
+        vector<int32_t> messages(NB_BITS), decrypted(NB_BITS);
+        for (int32_t i = 0; i < NB_BITS; i++) messages[i] = rand() % 2;
+
+        LweSample *ciphertexts = new_gate_bootstrapping_ciphertext_array(NB_BITS, params);
+        bootsSymEncrypt_array(ciphertexts, messages.data(), NB_BITS, key);
+        bootsSymDecrypt_array(decrypted.data(), ciphertexts, NB_BITS, key);
+        for (int32_t i = 0; i < NB_BITS; i++) {
+            ASSERT_EQ(messages[i], decrypted[i]);
+            ASSERT_EQ(messages[i], bootsSymDecrypt(ciphertexts + i, key));
+        }
+        delete_gate_bootstrapping_ciphertext_array(NB_BITS, ciphertexts);
+    }
+
+    //the encryption only depends on the seed, and not on the number of threads
+    TEST_F(BootsEncryptTest, arrayEncryptIsDeterministic) {
+        static const int32_t NB_BITS = 1000;
+        const int32_t n = params->in_out_params->n;
+        vector<int32_t> messages(NB_BITS, 1);
+        LweSample *c1 = new_gate_bootstrapping_ciphertext_array(NB_BITS, params);
+        LweSample *c4 = new_gate_bootstrapping_ciphertext_array(NB_BITS, params);
+        uint32_t seed = 42;
+
+        tfhe_set_nb_threads(1);
+        tfhe_random_generator_setSeed(&seed, 1);
+        bootsSymEncrypt_array(c1, messages.data(), NB_BITS, key);
+        tfhe_set_nb_threads(4);
+        tfhe_random_generator_setSeed(&seed, 1);
+        bootsSymEncrypt_array(c4, messages.data(), NB_BITS, key);
+        tfhe_set_nb_threads(0);
+
+        for (int32_t i = 0; i < NB_BITS; i++) {
+            ASSERT_EQ(c1[i].b, c4[i].b);
+            for (int32_t j = 0; j < n; j++) ASSERT_EQ(c1[i].a[j], c4[i].a[j]);
+        }
+        delete_gate_bootstrapping_ciphertext_array(NB_BITS, c4);
+        delete_gate_bootstrapping_ciphertext_array(NB_BITS, c1);
+    }
+
+    //N ciphertexts are packed in one TLwe sample, which decrypts to all of them
+    TEST_F(BootsEncryptTest, packedDecrypt) {
+        const int32_t N = params->tgsw_params->tlwe_params->N;
+        vector<int32_t> messages(N), decrypted(N);
+        for (int32_t i = 0; i < N; i++) messages[i] = rand() % 2;
+
+        LweToTLweKeySwitchKey *ks = new_gate_bootstrapping_packing_key(key, 6, 4);
+        LweSample *ciphertexts = new_gate_bootstrapping_ciphertext_array(N, params);
+        TLweSample *packed = new_TLweSample(params->tgsw_params->tlwe_params);
+        bootsSymEncrypt_array(ciphertexts, messages.data(), N, key);
+        for (int32_t nbelems: {1, 10, N}) {
+            bootsPack(packed, ciphertexts, nbelems, ks);
+            bootsSymDecryptPacked(decrypted.data(), packed, nbelems, key);
+            for (int32_t i = 0; i < nbelems; i++) ASSERT_EQ(messages[i], decrypted[i]);
+        }
+        delete_TLweSample(packed);
+        delete_gate_bootstrapping_ciphertext_array(N, ciphertexts);
+        delete_LweToTLweKeySwitchKey(ks);
+    }
+
+    TEST_F(BootsEncryptTest, intEncryptDecrypt) {
+        LweSample *ciphertexts = new_gate_bootstrapping_ciphertext_array(64, params);
+        const uint64_t values[] = {0, 1, 0x5a, UINT64_C(0xdeadbeefcafe1234), UINT64_MAX};
+        for (uint64_t value: values) {
+            bootsSymEncryptInt(ciphertexts, value, 64, key);
+            ASSERT_EQ(value, bootsSymDecryptInt(ciphertexts, 64, key));
+            for (int32_t i = 0; i < 64; i++) ASSERT_EQ(int32_t((value >> i) & 1), bootsSymDecrypt(ciphertexts + i, key));
+            bootsSymEncryptInt(ciphertexts, value, 12, key);
+            ASSERT_EQ(value & 0xfff, bootsSymDecryptInt(ciphertexts, 12, key));
+        }
+        delete_gate_bootstrapping_ciphertext_array(64, ciphertexts);
+    }
+
+    //the phase computed by the (possibly vectorized) lwePhase matches the naive dot product
+    TEST_F(BootsEncryptTest, lwePhaseMatchesNaiveDotProduct) {
+        for (int32_t n = 1; n < 100; n += 7) {
+            LweParams *lwe_params = new_LweParams(n, 0., 1.);
+            LweKey *lwe_key = new_LweKey(lwe_params);
+            lweKeyGen(lwe_key);
+            LweSample *sample = new_LweSample(lwe_params);
+            for (int32_t i = 0; i < n; i++) sample->a[i] = uniformTorus32_distrib(generator);
+            sample->b = uniformTorus32_distrib(generator);
+            Torus32 expected = sample->b;
+            for (int32_t i = 0; i < n; i++) expected -= sample->a[i] * lwe_key->key[i];
+            ASSERT_EQ(expected, lwePhase(sample, lwe_key));
+            delete_LweSample(sample);
+            delete_LweKey(lwe_key);
+            delete_LweParams(lwe_params);
+        }
+    }
+
+}
@@ -161,6 +161,34 @@ namespace {
             fake_delete_LweSample(res);
         }
 
+        /**
+         * the full adder: test the whole truth table of both outputs,
+         * the outputs overwriting two of the inputs
+         */
+        void full_adder_test() {
+            LweSample *in = fake_new_LweSample_array(3, LWE_PARAMS);
+            FakeLwe *fin[3] = {fake(in), fake(in + 1), fake(in + 2)};
+
+            for (int32_t i = 0; i < 8; i++) {
+                bool bin[3];
+                for (int32_t j = 0; j < 3; j++) {
+                    bin[j] = (i >> j) & 1;
+                    fin[j]->message = bin[j] ? ENC_TRUE : ENC_FALSE;
+                    fin[j]->current_variance = 0.01;
+                }
+
+                bootsFULLADDER(in, in + 1, in, in + 1, in + 2, CLOUD_KEY); //bootstrapped
+                bool bsum = bin[0] ^ bin[1] ^ bin[2]; //model
+                bool bcarry = (bin[0] + bin[1] + bin[2]) >= 2;
+
+                ASSERT_EQ(fin[0]->message, bsum ? ENC_TRUE : ENC_FALSE);
+                ASSERT_EQ(fin[1]->message, bcarry ? ENC_TRUE : ENC_FALSE);
+                ASSERT_LE(fin[0]->current_variance, 1. / 1024.);
+                ASSERT_LE(fin[1]->current_variance, 1. / 1024.);
+            }
+
+            fake_delete_LweSample_array(3, in);
+        }
 
     };
 
@@ -190,6 +218,14 @@ namespace {
 
     bool bool_mux(bool a, bool b, bool c) { return a ? b : c; }
 
+    bool bool_maj(bool a, bool b, bool c) { return (a + b + c) >= 2; }
+
+    bool bool_xor3(bool a, bool b, bool c) { return a ^ b ^ c; }
+
+    bool bool_and3(bool a, bool b, bool c) { return a && b && c; }
+
+    bool bool_or3(bool a, bool b, bool c) { return a || b || c; }
+
     TEST_F(BootsGateTest, NandTest) { binary_gate_test(bool_nand, bootsNAND); }
 
     TEST_F(BootsGateTest, AndTest) { binary_gate_test(bool_and, bootsAND); }
@@ -215,4 +251,14 @@ namespace {
     TEST_F(BootsGateTest, CopyTest) { unary_gate_test(bool_copy, bootsCOPY); }
 
     TEST_F(BootsGateTest, MuxTest) { ternary_gate_test(bool_mux, bootsMUX); }
+
+    TEST_F(BootsGateTest, MajTest) { ternary_gate_test(bool_maj, bootsMAJ); }
+
+    TEST_F(BootsGateTest, Xor3Test) { ternary_gate_test(bool_xor3, bootsXOR3); }
+
+    TEST_F(BootsGateTest, And3Test) { ternary_gate_test(bool_and3, bootsAND3); }
+
+    TEST_F(BootsGateTest, Or3Test) { ternary_gate_test(bool_or3, bootsOR3); }
+
+    TEST_F(BootsGateTest, FullAdderTest) { full_adder_test(); }
 }
@@ -473,17 +473,15 @@ namespace {
         LweBootstrappingKeyFFT *bkFFT = new_LweBootstrappingKeyFFT(bk);
 
         const int32_t n = in_params->n;
-        const int32_t t = bk->ks->t;
-        const int32_t base = bk->ks->base;
-        const int32_t N = bk_params->tlwe_params->extracted_lweparams.n;
 
         // KeySwitching 
-        for (int32_t i = 0; i < N; i++) {
-            for (int32_t j = 0; j < t; j++) {
-                for (int32_t p = 0; p < base; p++) {
-                    ASSERT_EQ(fake(&bkFFT->ks->ks[i][j][p])->message, fake(&bk->ks->ks[i][j][p])->message);
-                    ASSERT_EQ(fake(&bkFFT->ks->ks[i][j][p])->current_variance,
-                              fake(&bk->ks->ks[i][j][p])->current_variance);
+        ASSERT_EQ(bkFFT->ks->data_size(), bk->ks->data_size());
+        ASSERT_EQ(bkFFT->ks->current_variance, bk->ks->current_variance);
+        for (int32_t i = 0; i < bk->ks->n; i++) {
+            for (int32_t j = 0; j < bk->ks->t; j++) {
+                for (int32_t h = 1; h < bk->ks->base; h++) {
+                    for (int32_t p = 0; p <= n; p++)
+                        ASSERT_EQ(bkFFT->ks->entry(i, j, h)[p], bk->ks->entry(i, j, h)[p]);
                 }
             }
         }
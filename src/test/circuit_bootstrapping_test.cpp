@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    //the keyswitch of an LWE sample of mu gives a TLWE sample of P(X).mu
+    TEST(CircuitBootstrappingTest, functionalKeySwitch) {
+        const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+        const LweKey *in_key = key->lwe_key;
+        const TLweKey *out_key = &key->tgsw_key->tlwe_key;
+        const TLweParams *out_params = out_key->params;
+        const int32_t N = out_params->N;
+
+        // P = X^3 - X^5
+        IntPolynomial *P = new_IntPolynomial(N);
+        for (int32_t i = 0; i < N; i++) P->coefs[i] = (i == 3) - (i == 5);
+        LweToTLweKeySwitchKey *ks = new_LweToTLweKeySwitchKey(in_key->params->n, 6, 4, out_params);
+        tLweCreateFunctionalKeySwitchKey(ks, in_key, P, out_key);
+
+        LweSample *x = new_LweSample(in_key->params);
+        TLweSample *result = new_TLweSample(out_params);
+        TorusPolynomial *phase = new_TorusPolynomial(N);
+        for (int32_t trial = 0; trial < 10; trial++) {
+            const Torus32 mu = modSwitchToTorus32(rand() % 8, 8);
+            lweSymEncrypt(x, mu, in_key->params->alpha_min, in_key);
+            tLweFunctionalKeySwitch(result, ks, x);
+            tLwePhase(phase, result, out_key);
+            for (int32_t i = 0; i < N; i++) {
+                const Torus32 expected = (i == 3) ? mu : (i == 5) ? -mu : 0;
+                ASSERT_LT(torus_distance(phase->coefsT[i], expected), 1e-3);
+            }
+        }
+
+        delete_TorusPolynomial(phase);
+        delete_TLweSample(result);
+        delete_LweSample(x);
+        delete_LweToTLweKeySwitchKey(ks);
+        delete_IntPolynomial(P);
+    }
+
+    //the circuit bootstrapping of a bit selects between two TLWE samples with one external product
+    TEST(CircuitBootstrappingTest, cmuxWithCircuitBootstrappedSelector) {
+        const TFheGateBootstrappingSecretKeySet *key = small_circuit_bootstrapping_keyset();
+        const TfheCircuitBootstrappingKey *cbk = small_circuit_bootstrapping_key();
+        const TGswParams *params = cbk->tgsw_params;
+        const TLweParams *tlwe_params = params->tlwe_params;
+        const TLweKey *tlwe_key = &key->tgsw_key->tlwe_key;
+        const int32_t N = tlwe_params->N;
+
+        TorusPolynomial *messages = new_TorusPolynomial_array(2, N);
+        TLweSample *c = new_TLweSample_array(2, tlwe_params);
+        for (int32_t v = 0; v < 2; v++) {
+            for (int32_t i = 0; i < N; i++) messages[v].coefsT[i] = modSwitchToTorus32(rand() % 8, 8);
+            tLweSymEncrypt(c + v, messages + v, tlwe_params->alpha_min, tlwe_key);
+        }
+        LweSample *bit = new_gate_bootstrapping_ciphertext(key->params);
+        TGswSampleFFT *selector = new_TGswSampleFFT(params);
+        TLweSample *result = new_TLweSample(tlwe_params);
+        TorusPolynomial *phase = new_TorusPolynomial(N);
+        for (int32_t m = 0; m < 2; m++) {
+            bootsSymEncrypt(bit, m, key);
+            tfhe_circuitBootstrap_FFT(selector, cbk, bit);
+            // result = c0 + selector.(c1-c0)
+            tLweCopy(result, c + 1, tlwe_params);
+            tLweSubTo(result, c, tlwe_params);
+            tGswFFTExternMulToTLwe(result, selector, params);
+            tLweAddTo(result, c, tlwe_params);
+            tLwePhase(phase, result, tlwe_key);
+            for (int32_t i = 0; i < N; i++) ASSERT_LT(torus_distance(phase->coefsT[i], messages[m].coefsT[i]), 1. / 32);
+        }
+
+        delete_TorusPolynomial(phase);
+        delete_TLweSample(result);
+        delete_TGswSampleFFT(selector);
+        delete_gate_bootstrapping_ciphertext(bit);
+        delete_TLweSample_array(2, c);
+        delete_TorusPolynomial_array(2, messages);
+    }
+
+}
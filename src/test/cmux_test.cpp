@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    class CMuxTest : public ::testing::Test {
+    public:
+        const TFheGateBootstrappingSecretKeySet *key = small_circuit_bootstrapping_keyset();
+        const TfheCircuitBootstrappingKey *cbk = small_circuit_bootstrapping_key();
+        const TGswParams *params = cbk->tgsw_params;
+        const TLweParams *tlwe_params = params->tlwe_params;
+        const TLweKey *tlwe_key = &key->tgsw_key->tlwe_key;
+        const int32_t N = tlwe_params->N;
+
+        // encrypts nbelts random polynomials of 8 values
+        void encrypt_random(TLweSample *c, TorusPolynomial *messages, int32_t nbelts) {
+            for (int32_t v = 0; v < nbelts; v++) {
+                for (int32_t i = 0; i < N; i++) messages[v].coefsT[i] = modSwitchToTorus32(rand() % 8, 8);
+                tLweSymEncrypt(c + v, messages + v, tlwe_params->alpha_min, tlwe_key);
+            }
+        }
+
+        void assert_decrypts_to(const TLweSample *c, const TorusPolynomial *message, double tolerance) {
+            TorusPolynomial *phase = new_TorusPolynomial(N);
+            tLwePhase(phase, c, tlwe_key);
+            for (int32_t i = 0; i < N; i++) ASSERT_LT(torus_distance(phase->coefsT[i], message->coefsT[i]), tolerance);
+            delete_TorusPolynomial(phase);
+        }
+    };
+
+    //the CMux with a fresh TGsw selector, in the coefficient and the fft domains
+    TEST_F(CMuxTest, cmuxWithFreshSelector) {
+        TorusPolynomial *messages = new_TorusPolynomial_array(2, N);
+        TLweSample *c = new_TLweSample_array(2, tlwe_params);
+        encrypt_random(c, messages, 2);
+        // the key of the gate bootstrapping, with the decomposition of params
+        TGswKey *tgsw_key = new_TGswKey(params);
+        for (int32_t i = 0; i < tlwe_params->k; i++) intPolynomialCopy(tgsw_key->key + i, key->tgsw_key->key + i);
+        TGswSample *selector = new_TGswSample(params);
+        TGswSampleFFT *selectorFFT = new_TGswSampleFFT(params);
+        TLweSample *result = new_TLweSample(tlwe_params);
+        for (int32_t m = 0; m < 2; m++) {
+            tGswSymEncryptInt(selector, m, tlwe_params->alpha_min, tgsw_key);
+            tGswToFFTConvert(selectorFFT, selector, params);
+            tLweCMux(result, selector, c, c + 1, params);
+            assert_decrypts_to(result, messages + m, 1. / 64);
+            tLweCMuxFFT(result, selectorFFT, c, c + 1, params);
+            assert_decrypts_to(result, messages + m, 1. / 64);
+        }
+        // the result may be one of the inputs
+        tLweCMuxFFT(c + 1, selectorFFT, c, c + 1, params);
+        assert_decrypts_to(c + 1, messages + 1, 1. / 64);
+
+        delete_TLweSample(result);
+        delete_TGswSampleFFT(selectorFFT);
+        delete_TGswSample(selector);
+        delete_TGswKey(tgsw_key);
+        delete_TLweSample_array(2, c);
+        delete_TorusPolynomial_array(2, messages);
+    }
+
+    //a tree of depth 3 selects the input of the index given by 3 circuit bootstrapped bits
+    TEST_F(CMuxTest, cmuxTreeWithCircuitBootstrappedSelectors) {
+        const int32_t m = 3;
+        TorusPolynomial *messages = new_TorusPolynomial_array(1 << m, N);
+        TLweSample *data = new_TLweSample_array(1 << m, tlwe_params);
+        encrypt_random(data, messages, 1 << m);
+        LweSample *bits = new_gate_bootstrapping_ciphertext_array(m, key->params);
+        TGswSampleFFT *selectors = new_TGswSampleFFT_array(m, params);
+        TLweSample *result = new_TLweSample(tlwe_params);
+        TfheCMuxTree *tree = new_TfheCMuxTree(params, m, 2);
+        for (int32_t index: {0, 5, 6}) {
+            for (int32_t i = 0; i < m; i++) {
+                bootsSymEncrypt(bits + i, (index >> i) & 1, key);
+                tfhe_circuitBootstrap_FFT(selectors + i, cbk, bits + i);
+            }
+            tfhe_cmuxTree(result, tree, selectors, data);
+            assert_decrypts_to(result, messages + index, 1. / 16);
+        }
+
+        delete_TfheCMuxTree(tree);
+        delete_TLweSample(result);
+        delete_TGswSampleFFT_array(m, selectors);
+        delete_gate_bootstrapping_ciphertext_array(m, bits);
+        delete_TLweSample_array(1 << m, data);
+        delete_TorusPolynomial_array(1 << m, messages);
+    }
+
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    // 4-bit accumulator: acc += x at each cycle, carry = the carry out of the addition
+    string accumulator_blif() {
+        ostringstream blif;
+        blif << ".model accumulator\n.inputs x0 x1 x2 x3\n.outputs carry q0 q1 q2 q3\n";
+        for (int32_t i = 0; i < 4; i++) blif << ".latch d" << i << " q" << i << " " << (i == 0) << "\n";
+        blif << ".names c0\n";
+        for (int32_t i = 0; i < 4; i++) {
+            blif << ".names x" << i << " q" << i << " c" << i << " d" << i << "\n100 1\n010 1\n001 1\n111 1\n";
+            blif << ".names x" << i << " q" << i << " c" << i << " c" << i + 1 << "\n11- 1\n1-1 1\n-11 1\n";
+        }
+        blif << ".names c4 carry\n1 1\n.end\n";
+        return blif.str();
+    }
+
+    class DistributedTest : public ::testing::Test {
+    public:
+        const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+        const TFheGateBootstrappingCloudKeySet *bk = &key->cloud;
+        const TFheGateBootstrappingParameterSet *params = key->params;
+
+        //starts a worker process which serves one session
+        pid_t start_worker(int32_t listen_socket) {
+            const pid_t pid = fork();
+            if (pid == 0) _exit(tfhe_worker_serve(listen_socket, bk, 1, 1) == 1 ? 0 : 1);
+            close(listen_socket);
+            return pid;
+        }
+    };
+
+    //two worker processes, one on a unix socket and one on tcp, give the same result as the plaintext evaluation
+    TEST_F(DistributedTest, workersOnLoopbackSockets) {
+        istringstream in(accumulator_blif());
+        TfheNetlist *netlist = new_TfheNetlist_fromBlifStream(in);
+        ASSERT_TRUE(netlist != 0);
+        const int32_t nb_outputs = tfhe_netlist_nb_outputs(netlist);
+        ASSERT_EQ(4, tfhe_netlist_nb_registers(netlist));
+
+        const string unix_address = "unix:/tmp/tfhe-distributed-test-" + to_string(getpid());
+        const int32_t unix_socket = tfhe_worker_listen(unix_address.c_str());
+        ASSERT_GE(unix_socket, 0);
+        const int32_t tcp_socket = tfhe_worker_listen("127.0.0.1:0");
+        ASSERT_GE(tcp_socket, 0);
+        sockaddr_in tcp_addr;
+        socklen_t tcp_addr_size = sizeof(tcp_addr);
+        ASSERT_EQ(0, getsockname(tcp_socket, (sockaddr *) &tcp_addr, &tcp_addr_size));
+        const string tcp_address = "127.0.0.1:" + to_string(ntohs(tcp_addr.sin_port));
+        vector<pid_t> pids;
+        pids.push_back(start_worker(unix_socket));
+        pids.push_back(start_worker(tcp_socket));
+
+        const char *workers[] = {unix_address.c_str(), tcp_address.c_str()};
+        TfheDistributedNetlist *distributed = new_TfheDistributedNetlist(netlist, workers, 2, params);
+        ASSERT_TRUE(distributed != 0);
+
+        LweSample *inputs = new_gate_bootstrapping_ciphertext_array(4, params);
+        LweSample *outputs = new_gate_bootstrapping_ciphertext_array(nb_outputs, params);
+        LweSample *state = new_gate_bootstrapping_ciphertext_array(4, params);
+        int32_t plain_inputs[4], plain_outputs[5], plain_state[4];
+        for (int32_t i = 0; i < 4; i++) {
+            plain_state[i] = tfhe_netlist_register_init(netlist, i);
+            bootsSymEncrypt(state + i, plain_state[i], key);
+        }
+        for (int32_t cycle = 0; cycle < 3; cycle++) {
+            for (int32_t i = 0; i < 4; i++) {
+                plain_inputs[i] = rand() % 2;
+                bootsSymEncrypt(inputs + i, plain_inputs[i], key);
+            }
+            tfhe_netlist_eval_plain(netlist, plain_outputs, plain_inputs, plain_state);
+            ASSERT_EQ(1, tfhe_distributed_eval(distributed, outputs, inputs, state));
+            for (int32_t i = 0; i < nb_outputs; i++) ASSERT_EQ(plain_outputs[i], bootsSymDecrypt(outputs + i, key));
+            for (int32_t i = 0; i < 4; i++) ASSERT_EQ(plain_state[i], bootsSymDecrypt(state + i, key));
+        }
+        ASSERT_GT(tfhe_distributed_nb_transfers(distributed), 0);
+        delete_TfheDistributedNetlist(distributed);
+
+        for (pid_t pid: pids) {
+            int32_t status;
+            ASSERT_EQ(pid, waitpid(pid, &status, 0));
+            ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        }
+        unlink(unix_address.c_str() + 5);
+        delete_gate_bootstrapping_ciphertext_array(4, state);
+        delete_gate_bootstrapping_ciphertext_array(nb_outputs, outputs);
+        delete_gate_bootstrapping_ciphertext_array(4, inputs);
+        delete_TfheNetlist(netlist);
+    }
+
+    TEST_F(DistributedTest, unreachableWorker) {
+        istringstream in(accumulator_blif());
+        TfheNetlist *netlist = new_TfheNetlist_fromBlifStream(in);
+        const string address = "unix:/tmp/tfhe-distributed-none-" + to_string(getpid());
+        const char *workers[] = {address.c_str()};
+        ASSERT_TRUE(new_TfheDistributedNetlist(netlist, workers, 1, params) == 0);
+        const char *invalid[] = {"no-port"};
+        ASSERT_TRUE(new_TfheDistributedNetlist(netlist, invalid, 1, params) == 0);
+        delete_TfheNetlist(netlist);
+    }
+
+    //sends a message in the format of the workers: the command, the size of the payload, then the payload.
+    //An empty payload stands for a header which announces 2^40 bytes, and is not followed by them.
+    bool send_raw_message(int32_t fd, int32_t command, const vector<int32_t> &payload) {
+        if (payload.empty()) {
+            const int64_t size = int64_t(1) << 40;
+            return write(fd, &command, sizeof(command)) == sizeof(command)
+                   && write(fd, &size, sizeof(size)) == sizeof(size);
+        }
+        const int64_t size = payload.size() * sizeof(int32_t);
+        return write(fd, &command, sizeof(command)) == sizeof(command) && write(fd, &size, sizeof(size)) == sizeof(size)
+               && write(fd, payload.data(), size) == size;
+    }
+
+    //a worker closes the session on a plan or a run command which refers to wires out of its range,
+    //and on a message larger than the maximum payload
+    TEST_F(DistributedTest, malformedMessages) {
+        static const int32_t SETUP = 1, RUN = 2, REPLY = 4;
+        const int32_t n = params->in_out_params->n;
+        // 4 wires, one and gate 2 = and(0,1), in one level, and no wire to send back
+        const vector<int32_t> valid_plan = {n, 4, 1, TFHE_GATE_AND, 2, 0, 1, -1, 0, 1, 0, 1, 1, 0};
+        vector<int32_t> negative_input = valid_plan;
+        negative_input[5] = -5;
+        vector<int32_t> missing_input = valid_plan;
+        missing_input[6] = -1;
+        const vector<vector<int32_t> > messages[] = {
+                {negative_input},
+                {missing_input},
+                // more wires than the plan
+                {valid_plan, {0, 1000}},
+                {valid_plan, {0, -2}},
+                {{}},
+                {valid_plan, {}},
+        };
+        const string address = "unix:/tmp/tfhe-distributed-malformed-" + to_string(getpid());
+        for (const vector<vector<int32_t> > &session: messages) {
+            const int32_t listen_socket = tfhe_worker_listen(address.c_str());
+            ASSERT_GE(listen_socket, 0);
+            const pid_t pid = start_worker(listen_socket);
+            const int32_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            sockaddr_un addr;
+            memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            strncpy(addr.sun_path, address.c_str() + 5, sizeof(addr.sun_path) - 1);
+            ASSERT_EQ(0, connect(fd, (sockaddr *) &addr, sizeof(addr)));
+            for (size_t m = 0; m < session.size(); m++) {
+                ASSERT_TRUE(send_raw_message(fd, m == 0 ? SETUP : RUN, session[m]));
+                if (m + 1 < session.size()) {
+                    // the valid plan is accepted
+                    int32_t command, status;
+                    int64_t size;
+                    ASSERT_EQ(ssize_t(sizeof(command)), read(fd, &command, sizeof(command)));
+                    ASSERT_EQ(ssize_t(sizeof(size)), read(fd, &size, sizeof(size)));
+                    ASSERT_EQ(ssize_t(sizeof(status)), read(fd, &status, sizeof(status)));
+                    ASSERT_EQ(REPLY, command);
+                    ASSERT_EQ(1, status);
+                }
+            }
+            // no reply: the worker closed the session, which did not end normally
+            char byte;
+            ASSERT_EQ(0, read(fd, &byte, 1));
+            close(fd);
+            int32_t status;
+            ASSERT_EQ(pid, waitpid(pid, &status, 0));
+            ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+            unlink(address.c_str() + 5);
+        }
+    }
+
+}
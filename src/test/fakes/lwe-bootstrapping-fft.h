@@ -133,6 +133,14 @@ inline void fake_tfhe_createLweBootstrappingKeyFFT(LweBootstrappingKeyFFT* bkFFT
         const int32_t n, \
         const TGswParams* bk_params) { \
     fake_tfhe_blindRotate_FFT(accum,bkFFT,bara,n,bk_params); \
+    } \
+    inline void tfhe_blindRotate_FFT(TLweSample* accum, \
+        const TGswSampleFFT* bkFFT, \
+        const int32_t* bara, \
+        const int32_t n, \
+        const TGswParams* bk_params, \
+        TfheBootstrapWorkspace &) { \
+    fake_tfhe_blindRotate_FFT(accum,bkFFT,bara,n,bk_params); \
     }
 
 /**
@@ -177,6 +185,16 @@ inline void fake_tfhe_createLweBootstrappingKeyFFT(LweBootstrappingKeyFFT* bkFFT
         const int32_t n, \
         const TGswParams* bk_params) { \
     fake_tfhe_blindRotateAndExtract_FFT(result,v,bkFFT,barb,bara,n,bk_params); \
+    } \
+    inline void tfhe_blindRotateAndExtract_FFT(LweSample* result, \
+        const TorusPolynomial* v, \
+        const TGswSampleFFT* bkFFT, \
+        const int32_t barb, \
+        const int32_t* bara, \
+        const int32_t n, \
+        const TGswParams* bk_params, \
+        TfheBootstrapWorkspace &) { \
+    fake_tfhe_blindRotateAndExtract_FFT(result,v,bkFFT,barb,bara,n,bk_params); \
     }
 
 
@@ -56,80 +56,6 @@ namespace {
     }
 
 
-/**
- * fills the KeySwitching key array
- * @param result The (n x t x base) array of samples. 
- *        result[i][j][k] encodes k.s[i]/base^(j+1)
- * @param out_key The LWE key to encode all the output samples 
- * @param out_alpha The standard deviation of all output samples
- * @param in_key The (binary) input key
- * @param n The size of the input key
- * @param t The precision of the keyswitch (technically, 1/2.base^t)
- * @param basebit Log_2 of base
- */
-    inline void fake_lweCreateKeySwitchKey_fromArray(LweSample ***result,
-                                                     const LweKey *out_key, const double out_alpha,
-                                                     const int32_t *in_key, const int32_t n, const int32_t t, const int32_t basebit) {
-        const int32_t base = 1 << basebit;       // base=2 in [CGGI16]
-
-        for (int32_t i = 0; i < n; i++) {
-            for (int32_t j = 0; j < t; j++) {
-                for (int32_t k = 0; k < base; k++) {
-                    Torus32 x = (in_key[i] * k) * (1 << (32 - (j + 1) * basebit));
-                    fake_lweSymEncrypt(&result[i][j][k], x, out_alpha, out_key);
-                }
-            }
-        }
-    }
-
-#define USE_FAKE_lweCreateKeySwitchKey_fromArray \
-    inline void lweCreateKeySwitchKey_fromArray(LweSample*** result, \
-        const LweKey* out_key, const double out_alpha, \
-        const int32_t* in_key, const int32_t n, const int32_t t, const int32_t basebit){ \
-    fake_lweCreateKeySwitchKey_fromArray(result, \
-        out_key, out_alpha, \
-        in_key, n, t, basebit); \
-    }
-
-
-/**
- * translates the message of the result sample by -sum(a[i].s[i]) where s is the secret
- * embedded in ks.
- * @param result the LWE sample to translate by -sum(ai.si). 
- * @param ks The (n x t x base) key switching key 
- *        ks[i][j][k] encodes k.s[i]/base^(j+1)
- * @param params The common LWE parameters of ks and result
- * @param ai The input torus array
- * @param n The size of the input key
- * @param t The precision of the keyswitch (technically, 1/2.base^t)
- * @param basebit Log_2 of base
- */
-    inline void fake_lweKeySwitchTranslate_fromArray(LweSample *result,
-                                                     const LweSample ***ks, const LweParams *params,
-                                                     const Torus32 *ai,
-                                                     const int32_t n, const int32_t t, const int32_t basebit) {
-        const int32_t base = 1 << basebit;       // base=2 in [CGGI16]
-        const int32_t prec_offset = 1 << (32 - (1 + basebit * t)); //precision
-        const int32_t mask = base - 1;
-
-        for (int32_t i = 0; i < n; i++) {
-            const uint32_t aibar = ai[i] + prec_offset;
-            for (int32_t j = 0; j < t; j++) {
-                const uint32_t aij = (aibar >> (32 - (j + 1) * basebit)) & mask;
-                fake_lweSubTo(result, &ks[i][j][aij], params);
-            }
-        }
-    }
-
-#define USE_FAKE_lweKeySwitchTranslate_fromArray \
-    inline void lweKeySwitchTranslate_fromArray(LweSample* result, \
-        const LweSample*** ks, const LweParams* params, \
-        const Torus32* ai, \
-        const int32_t n, const int32_t t, const int32_t basebit){ \
-        fake_lweKeySwitchTranslate_fromArray(result, ks, params, ai, n, t, basebit); \
-    }
-
-
     inline void fake_lweCreateKeySwitchKey(LweKeySwitchKey *result, const LweKey *in_key, const LweKey *out_key) {
         const double variance = out_key->params->alpha_min * out_key->params->alpha_min;
         const int32_t n = result->n;
@@ -203,6 +203,9 @@ namespace {
 #define USE_FAKE_tGswFFTExternMulToTLwe \
     inline void tGswFFTExternMulToTLwe(TLweSample* accum, const TGswSampleFFT* gsw, const TGswParams* params) { \
     fake_tGswFFTExternMulToTLwe(accum, gsw, params); \
+    } \
+    inline void tGswFFTExternMulToTLwe(TLweSample* accum, const TGswSampleFFT* gsw, TGswFFTWorkspace& ws) { \
+    fake_tGswFFTExternMulToTLwe(accum, gsw, ws.params); \
     }
 
     // result = (X^ai -1)*bki  
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    class GateExecutorTest : public ::testing::Test {
+    public:
+        const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+        const TFheGateBootstrappingCloudKeySet *bk = &key->cloud;
+        const TFheGateBootstrappingParameterSet *params = key->params;
+    };
+
+    TEST_F(GateExecutorTest, allGateTypes) {
+        LweSample *in = new_gate_bootstrapping_ciphertext_array(3, params);
+        LweSample *out = new_gate_bootstrapping_ciphertext(params);
+        for (int32_t type = 0; type < TFHE_GATE_NB_TYPES; type++) {
+            for (int32_t m = 0; m < 8; m++) {
+                for (int32_t i = 0; i < 3; i++) bootsSymEncrypt(in + i, (m >> i) & 1, key);
+                bootsGATE(out, TfheGateType(type), in, in + 1, in + 2, m & 1, bk);
+                ASSERT_EQ(tfhe_gate_eval_plain(TfheGateType(type), m & 1, (m >> 1) & 1, (m >> 2) & 1, m & 1),
+                          bootsSymDecrypt(out, key)) << "gate " << type << " inputs " << m;
+            }
+        }
+        delete_gate_bootstrapping_ciphertext(out);
+        delete_gate_bootstrapping_ciphertext_array(3, in);
+    }
+
+    //the bootstrap with a workspace gives exactly the samples of tfhe_bootstrap_woKS_FFT, and may be repeated
+    TEST_F(GateExecutorTest, bootstrapWithWorkspace) {
+        const LweParams *extracted_params = &params->tgsw_params->tlwe_params->extracted_lweparams;
+        const Torus32 mu = modSwitchToTorus32(1, 8);
+        LweSample *in = new_gate_bootstrapping_ciphertext(params);
+        LweSample *expected = new_LweSample(extracted_params);
+        LweSample *result = new_LweSample(extracted_params);
+        TfheGateWorkspace ws(params);
+        for (int32_t m = 0; m < 4; m++) {
+            bootsSymEncrypt(in, m & 1, key);
+            tfhe_bootstrap_woKS_FFT(expected, bk->bkFFT, mu, in);
+            tfhe_bootstrap_woKS_FFT(result, bk->bkFFT, mu, in, *ws.bootstrap);
+            for (int32_t i = 0; i < extracted_params->n; i++) ASSERT_EQ(expected->a[i], result->a[i]);
+            ASSERT_EQ(expected->b, result->b);
+        }
+        delete_LweSample(result);
+        delete_LweSample(expected);
+        delete_gate_bootstrapping_ciphertext(in);
+    }
+
+    //a random batch of gates, which overwrites its samples, gives the same result as the sequential order
+    TEST_F(GateExecutorTest, randomDagMatchesSequentialOrder) {
+        static const int32_t NB_SAMPLES = 24;
+        static const int32_t NB_GATES = 120;
+        srand(42);
+        vector<int32_t> plain(NB_SAMPLES);
+        for (int32_t i = 0; i < NB_SAMPLES; i++) plain[i] = rand() % 2;
+        LweSample *samples = new_gate_bootstrapping_ciphertext_array(NB_SAMPLES, params);
+
+        TfheGateExecutor *executor = new_TfheGateExecutor(bk);
+        vector<int32_t> expected(plain);
+        for (int32_t g = 0; g < NB_GATES; g++) {
+            const TfheGateType type = TfheGateType(rand() % TFHE_GATE_NB_TYPES);
+            const int32_t r = rand() % NB_SAMPLES, a = rand() % NB_SAMPLES, b = rand() % NB_SAMPLES,
+                    c = rand() % NB_SAMPLES, value = rand() % 2;
+            if (type == TFHE_GATE_CONSTANT) tfhe_executor_add_constant(executor, samples + r, value);
+            else tfhe_executor_add_gate(executor, type, samples + r, samples + a, samples + b, samples + c);
+            expected[r] = tfhe_gate_eval_plain(type, expected[a], expected[b], expected[c], value);
+        }
+        ASSERT_EQ(NB_GATES, tfhe_executor_nb_gates(executor));
+
+        for (int32_t policy = TFHE_SCHEDULE_FIFO; policy <= TFHE_SCHEDULE_LIFO; policy++) {
+            tfhe_executor_set_policy(executor, TfheSchedulingPolicy(policy));
+            for (int32_t nb_threads = 1; nb_threads <= 4; nb_threads *= 4) {
+                for (int32_t i = 0; i < NB_SAMPLES; i++) bootsSymEncrypt(samples + i, plain[i], key);
+                tfhe_executor_run(executor, nb_threads);
+                for (int32_t i = 0; i < NB_SAMPLES; i++) ASSERT_EQ(expected[i], bootsSymDecrypt(samples + i, key));
+            }
+        }
+
+        tfhe_executor_clear(executor);
+        ASSERT_EQ(0, tfhe_executor_nb_gates(executor));
+        delete_TfheGateExecutor(executor);
+        delete_gate_bootstrapping_ciphertext_array(NB_SAMPLES, samples);
+    }
+
+    //the priority of a gate is the weighted length of the longest path from its start to the end
+    TEST_F(GateExecutorTest, criticalPathPriorities) {
+        LweSample *samples = new_gate_bootstrapping_ciphertext_array(6, params);
+        TfheGateExecutor *executor = new_TfheGateExecutor(bk);
+        ASSERT_EQ(0, tfhe_executor_critical_path(executor));
+        // a chain mux -> and -> not -> xor, and an independent nand
+        tfhe_executor_add_gate(executor, TFHE_GATE_MUX, samples + 3, samples, samples + 1, samples + 2);
+        tfhe_executor_add_gate(executor, TFHE_GATE_AND, samples + 4, samples + 3, samples, 0);
+        tfhe_executor_add_gate(executor, TFHE_GATE_NOT, samples + 4, samples + 4, 0, 0);
+        tfhe_executor_add_gate(executor, TFHE_GATE_XOR, samples + 5, samples + 4, samples + 1, 0);
+        tfhe_executor_add_gate(executor, TFHE_GATE_NAND, samples + 2, samples, samples + 1, 0);
+        ASSERT_EQ(4, tfhe_executor_critical_path(executor));
+        const int32_t expected[] = {4, 2, 1, 1, 1};
+        for (int32_t g = 0; g < 5; g++) ASSERT_EQ(expected[g], executor->gates[g].priority) << "gate " << g;
+        delete_TfheGateExecutor(executor);
+        delete_gate_bootstrapping_ciphertext_array(6, samples);
+    }
+
+    TEST_F(GateExecutorTest, pipelinedGates) {
+        static const int32_t NB_GATES = 40;
+        LweSample *in = new_gate_bootstrapping_ciphertext_array(3 * NB_GATES, params);
+        LweSample *out = new_gate_bootstrapping_ciphertext_array(NB_GATES, params);
+        vector<TfheGateType> types(NB_GATES);
+        vector<int32_t> plain(3 * NB_GATES), values(NB_GATES);
+        for (int32_t i = 0; i < 3 * NB_GATES; i++) {
+            plain[i] = rand() % 2;
+            bootsSymEncrypt(in + i, plain[i], key);
+        }
+        for (int32_t g = 0; g < NB_GATES; g++) {
+            types[g] = TfheGateType(g % TFHE_GATE_NB_TYPES);
+            values[g] = rand() % 2;
+        }
+        for (int32_t nb_lanes = 1; nb_lanes <= 3; nb_lanes += 2) {
+            bootsGATE_pipelined(out, types.data(), in, in + NB_GATES, in + 2 * NB_GATES, values.data(), NB_GATES,
+                                bk, nb_lanes);
+            for (int32_t g = 0; g < NB_GATES; g++) {
+                const int32_t expected = tfhe_gate_eval_plain(types[g], plain[g], plain[NB_GATES + g],
+                                                              plain[2 * NB_GATES + g], values[g]);
+                ASSERT_EQ(expected, bootsSymDecrypt(out + g, key)) << "gate " << g;
+            }
+        }
+        delete_gate_bootstrapping_ciphertext_array(NB_GATES, out);
+        delete_gate_bootstrapping_ciphertext_array(3 * NB_GATES, in);
+    }
+
+    //the replicas are copies of the keys, used by the evaluators when the replication is enabled
+    TEST_F(GateExecutorTest, numaReplicas) {
+        ASSERT_EQ(bk, tfhe_numa_cloud_key(bk, 0));
+        tfhe_set_numa_replication(1);
+        const TFheGateBootstrappingCloudKeySet *replica = tfhe_numa_cloud_key(bk, 0);
+        ASSERT_NE(bk, replica);
+        ASSERT_NE(bk->bkFFT, replica->bkFFT);
+        ASSERT_EQ(replica, tfhe_numa_cloud_key(bk, 0));
+        const LweKeySwitchKey *ks = bk->bkFFT->ks;
+        ASSERT_EQ(0, memcmp(ks->data, replica->bkFFT->ks->data, ks->data_size() * sizeof(Torus32)));
+
+        LweSample *in = new_gate_bootstrapping_ciphertext_array(2, params);
+        LweSample *out = new_gate_bootstrapping_ciphertext(params);
+        for (int32_t m = 0; m < 4; m++) {
+            bootsSymEncrypt(in, m & 1, key);
+            bootsSymEncrypt(in + 1, m >> 1, key);
+            bootsNAND(out, in, in + 1, replica);
+            ASSERT_EQ(!((m & 1) && (m >> 1)), bootsSymDecrypt(out, key));
+        }
+
+        const TFheGateBootstrappingCloudKeySet *local = tfhe_numa_local_cloud_key(bk);
+        ASSERT_EQ(tfhe_numa_current_node(), tfhe_numa_thread_replica());
+        ASSERT_EQ(tfhe_numa_cloud_key(bk, tfhe_numa_current_node()), local);
+
+        TfheGateExecutor *executor = new_TfheGateExecutor(bk);
+        tfhe_executor_add_gate(executor, TFHE_GATE_XOR, out, in, in + 1, 0);
+        tfhe_executor_add_gate(executor, TFHE_GATE_NOT, in, out, 0, 0);
+        tfhe_executor_run(executor, 2);
+        ASSERT_EQ(1, bootsSymDecrypt(in, key)); // in = (1,1) from the last iteration
+        delete_TfheGateExecutor(executor);
+
+        tfhe_numa_release_replicas(bk);
+        tfhe_set_numa_replication(0);
+        ASSERT_EQ(bk, tfhe_numa_local_cloud_key(bk));
+        ASSERT_EQ(-1, tfhe_numa_thread_replica());
+        delete_gate_bootstrapping_ciphertext(out);
+        delete_gate_bootstrapping_ciphertext_array(2, in);
+    }
+
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    class IntegerTest : public ::testing::Test {
+    public:
+        const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+        const TFheGateBootstrappingCloudKeySet *bk = &key->cloud;
+        const TFheGateBootstrappingParameterSet *params = key->params;
+
+        void encrypt(LweSample *result, int64_t x, int32_t n) {
+            for (int32_t i = 0; i < n; i++) bootsSymEncrypt(result + i, (x >> i) & 1, key);
+        }
+
+        int64_t decrypt(const LweSample *x, int32_t n) {
+            int64_t result = 0;
+            for (int32_t i = 0; i < n; i++) result |= int64_t(bootsSymDecrypt(x + i, key)) << i;
+            return result;
+        }
+
+        /** the two's complement value of n bits */
+        static int64_t to_signed(int64_t x, int32_t n) {
+            return (x >= (int64_t(1) << (n - 1))) ? x - (int64_t(1) << n) : x;
+        }
+    };
+
+    TEST_F(IntegerTest, addAndSub) {
+        static const int32_t n = 6;
+        static const int32_t mask = (1 << n) - 1;
+        LweSample *a = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *b = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *results = new_gate_bootstrapping_ciphertext_array(4 * n, params);
+        LweSample *carries = new_gate_bootstrapping_ciphertext_array(4, params);
+
+        TfheIntegerCircuit *circuit = new_TfheIntegerCircuit(bk);
+        for (int32_t type = TFHE_ADDER_RIPPLE; type <= TFHE_ADDER_PREFIX; type++) {
+            tfhe_integer_add(circuit, results + 2 * type * n, carries + 2 * type, a, b, n, TfheAdderType(type));
+            tfhe_integer_sub(circuit, results + (2 * type + 1) * n, carries + 2 * type + 1, a, b, n,
+                             TfheAdderType(type));
+        }
+        const int32_t values[][2] = {{0, 0}, {mask, 1}, {37, 37}, {12, 50}, {63, 62}};
+        for (const int32_t *v: values) {
+            encrypt(a, v[0], n);
+            encrypt(b, v[1], n);
+            tfhe_integer_run(circuit, 2);
+            for (int32_t type = 0; type < 2; type++) {
+                ASSERT_EQ((v[0] + v[1]) & mask, decrypt(results + 2 * type * n, n));
+                ASSERT_EQ(v[0] + v[1] > mask, bootsSymDecrypt(carries + 2 * type, key));
+                ASSERT_EQ((v[0] - v[1]) & mask, decrypt(results + (2 * type + 1) * n, n));
+                ASSERT_EQ(v[0] < v[1], bootsSymDecrypt(carries + 2 * type + 1, key));
+            }
+        }
+        delete_TfheIntegerCircuit(circuit);
+
+        // the results may overwrite the inputs
+        circuit = new_TfheIntegerCircuit(bk);
+        tfhe_integer_add(circuit, a, 0, a, b, n, TFHE_ADDER_PREFIX);
+        encrypt(a, 45, n);
+        encrypt(b, 30, n);
+        tfhe_integer_run(circuit, 2);
+        ASSERT_EQ((45 + 30) & mask, decrypt(a, n));
+        delete_TfheIntegerCircuit(circuit);
+
+        delete_gate_bootstrapping_ciphertext_array(4, carries);
+        delete_gate_bootstrapping_ciphertext_array(4 * n, results);
+        delete_gate_bootstrapping_ciphertext_array(n, b);
+        delete_gate_bootstrapping_ciphertext_array(n, a);
+    }
+
+    TEST_F(IntegerTest, comparisons) {
+        static const int32_t n = 5;
+        LweSample *a = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *b = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *results = new_gate_bootstrapping_ciphertext_array(5, params);
+
+        TfheIntegerCircuit *circuit = new_TfheIntegerCircuit(bk);
+        tfhe_integer_equal(circuit, results, a, b, n);
+        tfhe_integer_less_than(circuit, results + 1, a, b, n, 0);
+        tfhe_integer_less_than(circuit, results + 2, a, b, n, 1);
+        tfhe_integer_less_equal(circuit, results + 3, a, b, n, 0);
+        tfhe_integer_less_equal(circuit, results + 4, a, b, n, 1);
+        const int32_t values[][2] = {{0, 0}, {21, 21}, {3, 28}, {28, 3}, {17, 16}, {15, 16}, {31, 0}};
+        for (const int32_t *v: values) {
+            encrypt(a, v[0], n);
+            encrypt(b, v[1], n);
+            tfhe_integer_run(circuit, 2);
+            const int64_t sa = to_signed(v[0], n), sb = to_signed(v[1], n);
+            ASSERT_EQ(v[0] == v[1], bootsSymDecrypt(results, key));
+            ASSERT_EQ(v[0] < v[1], bootsSymDecrypt(results + 1, key));
+            ASSERT_EQ(sa < sb, bootsSymDecrypt(results + 2, key));
+            ASSERT_EQ(v[0] <= v[1], bootsSymDecrypt(results + 3, key));
+            ASSERT_EQ(sa <= sb, bootsSymDecrypt(results + 4, key));
+        }
+        delete_TfheIntegerCircuit(circuit);
+
+        delete_gate_bootstrapping_ciphertext_array(5, results);
+        delete_gate_bootstrapping_ciphertext_array(n, b);
+        delete_gate_bootstrapping_ciphertext_array(n, a);
+    }
+
+    TEST_F(IntegerTest, shifts) {
+        static const int32_t n = 6;
+        static const int32_t nb_shift_bits = 3;
+        LweSample *a = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *shift = new_gate_bootstrapping_ciphertext_array(nb_shift_bits, params);
+        LweSample *results = new_gate_bootstrapping_ciphertext_array(3 * n, params);
+
+        TfheIntegerCircuit *circuit = new_TfheIntegerCircuit(bk);
+        tfhe_integer_shift_left(circuit, results, a, n, shift, nb_shift_bits);
+        tfhe_integer_shift_right(circuit, results + n, a, n, shift, nb_shift_bits, 0);
+        tfhe_integer_shift_right(circuit, results + 2 * n, a, n, shift, nb_shift_bits, 1);
+        const int32_t values[][2] = {{45, 0}, {45, 1}, {45, 3}, {22, 2}, {22, 5}, {45, 7}};
+        for (const int32_t *v: values) {
+            encrypt(a, v[0], n);
+            encrypt(shift, v[1], nb_shift_bits);
+            tfhe_integer_run(circuit, 2);
+            ASSERT_EQ((int64_t(v[0]) << v[1]) & ((1 << n) - 1), decrypt(results, n));
+            ASSERT_EQ(v[0] >> v[1], decrypt(results + n, n));
+            ASSERT_EQ(to_signed(v[0], n) >> v[1], to_signed(decrypt(results + 2 * n, n), n));
+        }
+        delete_TfheIntegerCircuit(circuit);
+
+        delete_gate_bootstrapping_ciphertext_array(3 * n, results);
+        delete_gate_bootstrapping_ciphertext_array(nb_shift_bits, shift);
+        delete_gate_bootstrapping_ciphertext_array(n, a);
+    }
+
+    TEST_F(IntegerTest, multipliers) {
+        static const int32_t n = 4;
+        LweSample *a = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *b = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *results = new_gate_bootstrapping_ciphertext_array(4 * n, params);
+
+        TfheIntegerCircuit *circuit = new_TfheIntegerCircuit(bk);
+        tfhe_integer_mul(circuit, results, a, b, n, TFHE_MULTIPLIER_ARRAY);
+        tfhe_integer_mul(circuit, results + 2 * n, a, b, n, TFHE_MULTIPLIER_DADDA);
+        const int32_t values[][2] = {{0, 9}, {15, 15}, {13, 11}, {6, 1}};
+        for (const int32_t *v: values) {
+            encrypt(a, v[0], n);
+            encrypt(b, v[1], n);
+            tfhe_integer_run(circuit, 4);
+            ASSERT_EQ(v[0] * v[1], decrypt(results, 2 * n));
+            ASSERT_EQ(v[0] * v[1], decrypt(results + 2 * n, 2 * n));
+        }
+        delete_TfheIntegerCircuit(circuit);
+
+        delete_gate_bootstrapping_ciphertext_array(4 * n, results);
+        delete_gate_bootstrapping_ciphertext_array(n, b);
+        delete_gate_bootstrapping_ciphertext_array(n, a);
+    }
+
+    // the costs of the circuits, which are recorded but not run
+    TEST_F(IntegerTest, depthAndBootstraps) {
+        static const int32_t n = 32;
+        LweSample *a = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *b = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *result = new_gate_bootstrapping_ciphertext_array(2 * n, params);
+        TfheIntegerCircuit *circuit = new_TfheIntegerCircuit(bk);
+
+        tfhe_integer_add(circuit, result, 0, a, b, n, TFHE_ADDER_RIPPLE);
+        ASSERT_EQ(2 * n - 1, tfhe_integer_nb_bootstraps(circuit));
+        ASSERT_EQ(n, tfhe_integer_depth(circuit));
+        tfhe_integer_clear(circuit);
+        tfhe_integer_add(circuit, result, 0, a, b, n, TFHE_ADDER_PREFIX);
+        ASSERT_EQ(5 + 2, tfhe_integer_depth(circuit));
+
+        tfhe_integer_clear(circuit);
+        tfhe_integer_mul(circuit, result, a, b, n, TFHE_MULTIPLIER_ARRAY);
+        const int32_t array_depth = tfhe_integer_depth(circuit);
+        tfhe_integer_clear(circuit);
+        tfhe_integer_mul(circuit, result, a, b, n, TFHE_MULTIPLIER_DADDA);
+        ASSERT_LT(tfhe_integer_depth(circuit) * 4, array_depth);
+
+        // two mux stages, and the shift bits of 4 or more share a single and-not stage
+        tfhe_integer_clear(circuit);
+        tfhe_integer_shift_left(circuit, result, a, 4, b, 6);
+        ASSERT_EQ(2 * 2 + 1, tfhe_integer_depth(circuit));
+
+        delete_TfheIntegerCircuit(circuit);
+        delete_gate_bootstrapping_ciphertext_array(2 * n, result);
+        delete_gate_bootstrapping_ciphertext_array(n, b);
+        delete_gate_bootstrapping_ciphertext_array(n, a);
+    }
+}
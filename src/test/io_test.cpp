@@ -61,15 +61,13 @@ namespace {
         const int32_t t = key->t;
         const int32_t base = key->base;
 	const int32_t n = key->out_params->n;
-	const int32_t length = N*t*base;
-	double variance = rand()/double(RAND_MAX);
-        LweSample* begin = key->ks0_raw;
-	LweSample* end = begin+length;
-	for (LweSample* it=begin; it!=end; ++it) {
-	    for (int32_t j=0; j<n; j++) it->a[j]=rand();
-            it->b=rand();
-            it->current_variance=variance;
-        }
+	for (int32_t i=0; i<N; i++)
+	    for (int32_t j=0; j<t; j++)
+		for (int32_t h=1; h<base; h++) {
+		    Torus32* entry = key->entry(i,j,h);
+		    for (int32_t p=0; p<=n; p++) entry[p]=rand();
+		}
+        key->current_variance=rand()/double(RAND_MAX);
     }
 
     //generate a random ks
@@ -219,27 +217,33 @@ namespace {
 	    assert_equals(a->all_sample+i,b->all_sample+i,tlwe_params);
     }
 
-    //equality test for keyswitch key (for the variance, only the max is
-    //compared)
+    //equality test for keyswitch key
     void assert_equals(const LweKeySwitchKey* a, const LweKeySwitchKey* b) {
 	ASSERT_EQ(a->n,b->n);
 	ASSERT_EQ(a->t,b->t);
 	ASSERT_EQ(a->basebit,b->basebit);
 	ASSERT_EQ(a->base,b->base);
 	assert_equals(a->out_params, b->out_params);
-	const int32_t length = a->n * a->t * a->base;
 	const int32_t outn = a->out_params->n;
-	double max_vara=-1;
-	double max_varb=-1;
-	for (int32_t i=0; i<length; i++) {
-	    const LweSample& sa = a->ks0_raw[i];
-	    const LweSample& sb = b->ks0_raw[i];
-	    for (int32_t j=0; j<outn; j++) ASSERT_EQ(sa.a[j],sb.a[j]);
-	    ASSERT_EQ(sa.b,sb.b);
-	    if (sa.current_variance>max_vara) max_vara=sa.current_variance;
-	    if (sb.current_variance>max_varb) max_varb=sb.current_variance;
-	}
-	ASSERT_EQ(max_vara,max_varb);
+	for (int32_t i=0; i<a->n; i++)
+	    for (int32_t j=0; j<a->t; j++)
+		for (int32_t h=1; h<a->base; h++)
+		    for (int32_t p=0; p<=outn; p++) 
+			ASSERT_EQ(a->entry(i,j,h)[p],b->entry(i,j,h)[p]);
+	ASSERT_EQ(a->current_variance,b->current_variance);
+    }
+
+    //equality test for lwe to tlwe keyswitch key
+    void assert_equals(const LweToTLweKeySwitchKey* a, const LweToTLweKeySwitchKey* b) {
+	ASSERT_EQ(a->n,b->n);
+	ASSERT_EQ(a->t,b->t);
+	ASSERT_EQ(a->basebit,b->basebit);
+	ASSERT_EQ(a->base,b->base);
+	assert_equals(a->out_params, b->out_params);
+	for (int32_t i=0; i<=a->n; i++)
+	    for (int32_t j=0; j<a->t; j++)
+		assert_equals(a->entry(i,j),b->entry(i,j),a->out_params);
+	ASSERT_EQ(a->current_variance,b->current_variance);
     }
 
     //equality test for bootstrapping key
@@ -453,6 +457,51 @@ namespace {
         }	
     }
 
+    TEST(IOTest, LweToTLweKeySwitchKeyIO) {
+        LweToTLweKeySwitchKey* ks = new_LweToTLweKeySwitchKey(16, 3, 2, tlweparams128_2);
+        ks->current_variance = rand()/double(RAND_MAX);
+        //the entries share the variance of the key
+        for (int32_t i=0; i<(ks->n+1)*ks->t; i++) {
+            tlweSampleUniform(ks->ks+i, tlweparams128_2);
+            ks->ks[i].current_variance = ks->current_variance;
+        }
+        ostringstream oss;
+        export_lweToTLweKeySwitchKey_toStream(oss, ks);
+        string result = oss.str();
+        istringstream iss(result);
+        LweToTLweKeySwitchKey* ks1 = new_lweToTLweKeySwitchKey_fromStream(iss);
+        assert_equals(ks,ks1);
+        delete_LweToTLweKeySwitchKey(ks1);
+        delete_LweToTLweKeySwitchKey(ks);
+    }
+
+    //keys in the legacy format (with the trivial entries h=0) can still be read
+    TEST(IOTest, LweKeySwitchKeyLegacyIO) {
+        for (const LweKeySwitchKey* ks: allks) {
+            const int32_t outn = ks->out_params->n;
+            const int32_t nb_blocks = ks->n * ks->t;
+            const size_t entry_size = (outn + 1) * sizeof(Torus32);
+            ostringstream oss;
+            export_lweKeySwitchKey_toStream(oss, ks);
+            string compact = oss.str();
+            //the content is the uid, the variance, then the entries without the h=0 terms
+            const size_t content_size = nb_blocks * (ks->base - 1) * entry_size;
+            const size_t header_size = compact.size() - content_size - sizeof(int32_t) - sizeof(double);
+            string legacy = compact.substr(0, header_size);
+            legacy.append((const char*) &LWE_KEYSWITCH_KEY_TYPE_UID, sizeof(int32_t));
+            legacy.append(compact, header_size + sizeof(int32_t), sizeof(double));
+            for (int32_t b = 0; b < nb_blocks; b++) {
+                legacy.append(entry_size, '\0');
+                legacy.append(compact, header_size + sizeof(int32_t) + sizeof(double) + b * (ks->base - 1) * entry_size,
+                              (ks->base - 1) * entry_size);
+            }
+            istringstream iss(legacy);
+            LweKeySwitchKey* ks1 = new_lweKeySwitchKey_fromStream(iss);
+            assert_equals(ks,ks1);
+            delete_LweKeySwitchKey(ks1);
+        }
+    }
+
     TEST(IOTest, LweBootstrappingKeyIO) {
         for (const LweBootstrappingKey* bk: allbk) {
             {
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    class LeveledTest : public ::testing::Test {
+    public:
+        const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+        const TFheGateBootstrappingCloudKeySet *bk = &key->cloud;
+        const TFheGateBootstrappingParameterSet *params = key->params;
+    };
+
+    // the error of the bootstrapped samples is within the estimated variance
+    TEST_F(LeveledTest, bootstrapVariance) {
+        static const int32_t NB_SAMPLES = 32;
+        LweSample *x = new_gate_bootstrapping_ciphertext(params);
+        const double variance = bootsBootstrapVariance(params);
+        ASSERT_GT(variance, 0.);
+        ASSERT_LT(variance, bootsLeveledMaxVariance(params));
+
+        double square_error = 0;
+        for (int32_t i = 0; i < NB_SAMPLES; i++) {
+            const int32_t bit = i % 2;
+            bootsLeveledSymEncrypt(x, bit, key);
+            bootsLeveledRefresh(x, x, bk);
+            ASSERT_EQ(variance, x->current_variance);
+            ASSERT_EQ(bit, bootsLeveledSymDecrypt(x, key));
+            const Torus32 error = lwePhase(x, key->lwe_key) - (bit ? modSwitchToTorus32(1, 2) : 0);
+            square_error += t32tod(error) * t32tod(error);
+        }
+        ASSERT_LE(square_error / NB_SAMPLES, 2. * variance);
+        delete_gate_bootstrapping_ciphertext(x);
+    }
+
+    // the samples are bootstrapped only when the variance of the sum would exceed the bound
+    TEST_F(LeveledTest, parityOfNoisySamples) {
+        static const int32_t NB_SAMPLES = 10;
+        const int32_t bits[NB_SAMPLES] = {1, 0, 1, 1, 0, 0, 1, 0, 1, 1};
+        LweSample *samples = new_gate_bootstrapping_ciphertext_array(NB_SAMPLES, params);
+        LweSample *result = new_gate_bootstrapping_ciphertext(params);
+        LweSample *gate = new_gate_bootstrapping_ciphertext(params);
+
+        int32_t parity = 0;
+        for (int32_t i = 0; i < NB_SAMPLES; i++) {
+            bootsLeveledSymEncrypt(samples + i, bits[i], key);
+            // as if they were the sums of many samples: three of them fit in the bound
+            samples[i].current_variance = 0.3 * bootsLeveledMaxVariance(params);
+            parity ^= bits[i];
+        }
+        ASSERT_EQ(3, bootsLeveledParity(result, samples, NB_SAMPLES, bk));
+        ASSERT_LE(result->current_variance, bootsLeveledMaxVariance(params));
+        ASSERT_EQ(parity, bootsLeveledSymDecrypt(result, key));
+        bootsLeveledToGate(gate, result, bk);
+        ASSERT_EQ(parity, bootsSymDecrypt(gate, key));
+
+        // the xor of three of them needs no bootstrapping, the fourth one needs one
+        ASSERT_EQ(0, bootsLeveledXOR(result, samples, samples + 1, bk));
+        ASSERT_EQ(0, bootsLeveledXOR(result, result, samples + 2, bk));
+        ASSERT_EQ(1, bootsLeveledXOR(result, samples + 3, result, bk));
+        ASSERT_EQ(bits[0] ^ bits[1] ^ bits[2] ^ bits[3], bootsLeveledSymDecrypt(result, key));
+
+        delete_gate_bootstrapping_ciphertext(gate);
+        delete_gate_bootstrapping_ciphertext(result);
+        delete_gate_bootstrapping_ciphertext_array(NB_SAMPLES, samples);
+    }
+
+    // a chain of xor and not gates on gate bootstrapping ciphertexts
+    TEST_F(LeveledTest, xorChainOfGateCiphertexts) {
+        static const int32_t NB_BITS = 8;
+        LweSample *in = new_gate_bootstrapping_ciphertext_array(NB_BITS, params);
+        LweSample *leveled = new_gate_bootstrapping_ciphertext_array(NB_BITS, params);
+        LweSample *result = new_gate_bootstrapping_ciphertext(params);
+
+        for (int32_t m = 0; m < 4; m++) {
+            int32_t expected = 1;
+            for (int32_t i = 0; i < NB_BITS; i++) {
+                const int32_t bit = (m * 37 >> i) & 1;
+                bootsSymEncrypt(in + i, bit, key);
+                bootsLeveledFromGate(leveled + i, in + i, bk);
+                expected ^= bit;
+            }
+            int32_t nb_bootstraps = 0;
+            LweSample *sum = leveled;
+            for (int32_t i = 1; i < NB_BITS; i++) nb_bootstraps += bootsLeveledXOR(sum, sum, leveled + i, bk);
+            bootsLeveledNOT(sum, sum, bk);
+            // the bound of the small parameters is far above their bootstrapping noise
+            ASSERT_EQ(0, nb_bootstraps);
+            bootsLeveledToGate(result, sum, bk);
+            ASSERT_EQ(expected, bootsSymDecrypt(result, key));
+        }
+
+        delete_gate_bootstrapping_ciphertext(result);
+        delete_gate_bootstrapping_ciphertext_array(NB_BITS, leveled);
+        delete_gate_bootstrapping_ciphertext_array(NB_BITS, in);
+    }
+
+    // the conversions and the leveled gates may write their result in their input
+    TEST_F(LeveledTest, resultIsInput) {
+        LweSample *x = new_gate_bootstrapping_ciphertext(params);
+        LweSample *y = new_gate_bootstrapping_ciphertext(params);
+        for (int32_t bit = 0; bit < 2; bit++) {
+            bootsSymEncrypt(x, bit, key);
+            const double variance = 4. * max(x->current_variance, bootsBootstrapVariance(params));
+            bootsLeveledFromGate(x, x, bk);
+            ASSERT_EQ(bit, bootsLeveledSymDecrypt(x, key));
+            ASSERT_EQ(variance, x->current_variance);
+            bootsLeveledRefresh(x, x, bk);
+            ASSERT_EQ(bit, bootsLeveledSymDecrypt(x, key));
+            bootsLeveledSymEncrypt(y, 1, key);
+            bootsLeveledXOR(x, x, y, bk);
+            ASSERT_EQ(1 - bit, bootsLeveledSymDecrypt(x, key));
+            bootsLeveledNOT(x, x, bk);
+            bootsLeveledToGate(x, x, bk);
+            ASSERT_EQ(bit, bootsSymDecrypt(x, key));
+        }
+        delete_gate_bootstrapping_ciphertext(y);
+        delete_gate_bootstrapping_ciphertext(x);
+    }
+}
@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
+#include <vector>
+// the headers of lwe-keyswitch-functions.cpp, which is included in the fixture below: they must be
+// included first, at namespace scope
 #include "lwe-functions.h"
 #include "lwekeyswitch.h"
 #include "numeric_functions.h"
+#include "tfhe_threads.h"
 
 using namespace std;
 
@@ -33,6 +37,17 @@ namespace {
             result->current_variance = alpha * alpha;
         }
 
+        //fake raw encryption: noiseless trivial ciphertext
+        static void lweSymEncryptRawWithExternalNoise(
+                Torus32 *a,
+                const Torus32 message,
+                const double noise,
+                const LweKey *key) {
+            const int32_t n = key->params->n;
+            for (int32_t i = 0; i < n; i++) a[i] = 0;
+            a[n] = message;
+        }
+
         //MOCK_METHOD4(lweSymEncrypt, void(LweSample*,const Torus32,const double, const LweKey*));
 
 #define TFHE_TEST_ENVIRONMENT 1
@@ -42,16 +57,13 @@ namespace {
 
     /**
      * fills the KeySwitching key array
-     * @param result The (n x t x base) array of samples. 
-     *        result[i][j][k] encodes k.s[i]/base^(j+1)
+     * @param result The keyswitch key, whose n,t,basebit fields are already set
+     *        result->entry(i,j,h) encodes h.s[i]/base^(j+1) (for 1<=h<base)
      * @param out_key The LWE key to encode all the output samples 
      * @param out_alpha The standard deviation of all output samples
      * @param in_key The (binary) input key
-     * @param n The size of the input key
-     * @param t The precision of the keyswitch (technically, 1/2.base^t)
-     * @param basebit Log_2 of base
      */
-    //void lweCreateKeySwitchKey_fromArray(LweSample*** result, 
+    //void lweCreateKeySwitchKey_fromArray(LweKeySwitchKey* result, 
     TEST_F(LweKeySwitchTest, lweCreateKeySwitchKey_fromArray) {
         //EXPECT_CALL(*this, lweSymEncrypt(_,_,_,_)).WillRepeatedly(Invoke(fake_lweSymEncrypt));
         LweKeySwitchKey *test = new_LweKeySwitchKey(300, 14, 2, params500_1em5);
@@ -63,13 +75,17 @@ namespace {
         int32_t base = test->base;
         int32_t *in_key = new int32_t[N];
         for (int32_t i = 0; i < N; i++) in_key[i] = (uniformTorus32_distrib(generator) % 2 == 0 ? 1 : 0);
-        lweCreateKeySwitchKey_fromArray(test->ks, key500, alpha, in_key, N, t, basebit);
+        const int32_t n_out = test->out_params->n;
+        lweCreateKeySwitchKey_fromArray(test, key500, alpha, in_key);
+        ASSERT_EQ(alpha * alpha, test->current_variance);
         for (int32_t i = 0; i < N; i++) {
             for (int32_t j = 0; j < t; j++) {
-                for (int32_t k = 0; k < base; k++) {
-                    LweSample *ks_ijk = &test->ks[i][j][k];
-                    ASSERT_EQ(alpha * alpha, ks_ijk->current_variance);
-                    ASSERT_EQ(k * in_key[i] * 1 << (32 - (j + 1) * basebit), ks_ijk->b);
+                for (int32_t k = 1; k < base; k++) {
+                    const Torus32 *ks_ijk = test->entry(i, j, k);
+                    //the entries are cache-line aligned and do not overlap
+                    ASSERT_EQ(0u, uint64_t(ks_ijk) % 64);
+                    ASSERT_GE(test->stride, n_out + 1);
+                    ASSERT_EQ(k * in_key[i] * 1 << (32 - (j + 1) * basebit), ks_ijk[n_out]);
                 }
             }
         }
@@ -81,18 +97,13 @@ namespace {
      * translates the message of the result sample by -sum(a[i].s[i]) where s is the secret
      * embedded in ks.
      * @param result the LWE sample to translate by -sum(ai.si). 
-     * @param ks The (n x t x base) key switching key 
-     *        ks[i][j][k] encodes k.s[i]/base^(j+1)
-     * @param params The common LWE parameters of ks and result
+     * @param ks The keyswitch key: ks->entry(i,j,h) encodes h.s[i]/base^(j+1)
      * @param ai The input torus array
-     * @param n The size of the input key
-     * @param t The precision of the keyswitch (technically, 1/2.base^t)
-     * @param basebit Log_2 of base
+     * @param begin,end Only the input coefficients begin<=i<end are processed
      */
     //void lweKeySwitchTranslate_fromArray(LweSample* result, 
-    //	    const LweSample*** ks, const LweParams* params, 
-    //	    const Torus32* ai, 
-    //	    const int32_t n, const int32_t t, const int32_t basebit)
+    //	    const LweKeySwitchKey* ks, const Torus32* ai, 
+    //	    const int32_t begin, const int32_t end)
     TEST_F(LweKeySwitchTest, lweKeySwitchTranslate_fromArray) {
         //EXPECT_CALL(*this, lweSymEncrypt(_,_,_,_)).WillRepeatedly(Invoke(fake_lweSymEncrypt));
         LweKeySwitchKey *test = new_LweKeySwitchKey(300, 14, 2, params500_1em5);
@@ -116,14 +127,13 @@ namespace {
             aibar[i] = (ai[i] + prec_offset) & prec_mask;
         }
         LweSample *res = new_LweSample(params500_1em5);
-        lweCreateKeySwitchKey_fromArray(test->ks, key500, alpha, in_key, N, t, basebit);
+        lweCreateKeySwitchKey_fromArray(test, key500, alpha, in_key);
         //we first try one by one
         lweNoiselessTrivial(res, b, params500_1em5);
         Torus32 barphi = b;
         ASSERT_EQ(barphi, res->b);
         for (int32_t i = 0; i < N; i++) {
-            lweKeySwitchTranslate_fromArray(res, (const LweSample ***) test->ks + i, params500_1em5, ai + i, 1, t,
-                                            basebit);
+            lweKeySwitchTranslate_fromArray(res, test, ai, i, i + 1);
             barphi -= aibar[i] * in_key[i];
             //verify the decomposition function
             //printf( "ai:  %08x\n"
@@ -141,7 +151,7 @@ namespace {
         }
         //now, test it all at once
         lweNoiselessTrivial(res, b, params500_1em5);
-        lweKeySwitchTranslate_fromArray(res, (const LweSample ***) test->ks, params500_1em5, ai, N, t, basebit);
+        lweKeySwitchTranslate_fromArray(res, test, ai, 0, N);
         ASSERT_LE(res->current_variance, alpha * alpha * N * t + 1e-10);
         ASSERT_EQ(barphi, res->b);
         delete[] in_key;
@@ -150,4 +160,77 @@ namespace {
         delete_LweSample(res);
         delete_LweKeySwitchKey(test);
     }
+
+    //the blocked keyswitch engine matches the naive row by row subtraction
+    TEST_F(LweKeySwitchTest, lweKeySwitchTranslateMatchesNaive) {
+        LweKeySwitchKey *test = new_LweKeySwitchKey(300, 8, 2, params500_1em5);
+        const int32_t N = test->n;
+        const int32_t t = test->t;
+        const int32_t basebit = test->basebit;
+        const int32_t n_out = test->out_params->n;
+        const int32_t prec_offset = 1 << (32 - (1 + basebit * t));
+        for (int32_t i = 0; i < N; i++)
+            for (int32_t j = 0; j < t; j++)
+                for (int32_t h = 1; h < test->base; h++)
+                    for (int32_t p = 0; p <= n_out; p++) test->entry(i, j, h)[p] = uniformTorus32_distrib(generator);
+        test->current_variance = 1e-10;
+        Torus32 *ai = new Torus32[N];
+        for (int32_t i = 0; i < N; i++) ai[i] = uniformTorus32_distrib(generator);
+
+        LweSample *res = new_LweSample(params500_1em5);
+        LweSample *expected = new_LweSample(params500_1em5);
+        lweNoiselessTrivial(res, 123456, params500_1em5);
+        lweNoiselessTrivial(expected, 123456, params500_1em5);
+        int32_t nb_terms = 0;
+        for (int32_t i = 0; i < N; i++) {
+            const uint32_t aibar = ai[i] + prec_offset;
+            for (int32_t j = 0; j < t; j++) {
+                const uint32_t aij = (aibar >> (32 - (j + 1) * basebit)) & (test->base - 1);
+                if (aij == 0) continue;
+                const Torus32 *row = test->entry(i, j, aij);
+                for (int32_t p = 0; p < n_out; p++) expected->a[p] -= row[p];
+                expected->b -= row[n_out];
+                nb_terms++;
+            }
+        }
+        lweKeySwitchTranslate_fromArray(res, test, ai, 0, N);
+        for (int32_t p = 0; p < n_out; p++) ASSERT_EQ(expected->a[p], res->a[p]);
+        ASSERT_EQ(expected->b, res->b);
+        ASSERT_DOUBLE_EQ(nb_terms * 1e-10, res->current_variance);
+        //empty range: nothing changes
+        lweKeySwitchTranslate_fromArray(res, test, ai, 5, 5);
+        ASSERT_EQ(expected->b, res->b);
+
+        delete_LweSample(expected);
+        delete_LweSample(res);
+        delete[] ai;
+        delete_LweKeySwitchKey(test);
+    }
+
+    //the vectorized block kernels match the portable one
+    TEST_F(LweKeySwitchTest, lweKeySwitchBlockKernels) {
+        const int32_t nb_rows = 37;
+        const int32_t row_size = 3 * KS_BLOCK;
+        vector<Torus32> data(nb_rows * row_size);
+        for (Torus32 &x: data) x = uniformTorus32_distrib(generator);
+        vector<const Torus32 *> rows(nb_rows + KS_PREFETCH_DISTANCE);
+        for (int32_t k = 0; k < nb_rows + KS_PREFETCH_DISTANCE; k++) rows[k] = data.data() + ((7 * k) % nb_rows) * row_size;
+        vector<Torus32> init(KS_BLOCK);
+        for (Torus32 &x: init) x = uniformTorus32_distrib(generator);
+
+        for (int32_t offset = 0; offset < row_size; offset += KS_BLOCK) {
+            vector<Torus32> expected(init);
+            lweKeySwitchBlock_scalar(expected.data(), rows.data(), nb_rows, offset, KS_BLOCK);
+#ifdef __AVX2__
+            vector<Torus32> acc2(init);
+            lweKeySwitchBlock_avx2(acc2.data(), rows.data(), nb_rows, offset);
+            ASSERT_EQ(expected, acc2);
+#endif
+#ifdef __AVX512F__
+            vector<Torus32> acc512(init);
+            lweKeySwitchBlock_avx512(acc512.data(), rows.data(), nb_rows, offset);
+            ASSERT_EQ(expected, acc512);
+#endif
+        }
+    }
 }
@@ -0,0 +1,317 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <vector>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    // 2-bit adder with carry: covers with 3 inputs, yosys cells, continuation lines and comments
+    const char ADDER_BLIF[] =
+            ".model adder2\n"
+            ".inputs a0 a1 \\\n"
+            "  b0 b1 cin\n"
+            ".outputs s0 s1 cout\n"
+            "# sum of the first bit\n"
+            ".names a0 b0 cin s0\n"
+            "100 1\n010 1\n001 1\n111 1\n"
+            ".names a0 b0 cin c1\n"
+            "11- 1\n1-1 1\n-11 1\n"
+            ".subckt $_XOR_ A=a1 B=b1 Y=x1\n"
+            ".names x1 c1 s1\n"
+            "00 0\n11 0\n"
+            ".subckt $_MUX_ A=a1 B=c1 S=x1 Y=cout  # carry = x1 ? c1 : a1\n"
+            ".end\n";
+
+    // 2-bit counter with enable, the first latch starts at 1
+    const char COUNTER_BLIF[] =
+            ".model counter\n"
+            ".inputs en\n"
+            ".outputs q0 q1\n"
+            ".latch d0 q0 re clk 1\n"
+            ".latch d1 q1 0\n"
+            ".names en q0 d0\n"
+            "01 1\n10 1\n"
+            ".names en q0 q1 d1\n"
+            "0-1 1\n110 1\n101 1\n"
+            ".end\n";
+
+    // flip-flops with an active high and an active low enable
+    const char ENABLE_BLIF[] =
+            ".model enable\n"
+            ".inputs clk d e\n"
+            ".outputs qp qn\n"
+            ".subckt $_DFFE_PP_ C=clk D=d E=e Q=qp\n"
+            ".subckt $_DFFE_PN_ C=clk D=d E=e Q=qn\n"
+            ".end\n";
+
+    // y = {1, a0|~a1, a0&a1}, q toggles at each cycle
+    const char TOGGLE_JSON[] = R"({
+      "creator": "Yosys",
+      "modules": {
+        "unused": {"ports": {}, "cells": {}},
+        "top": {
+          "attributes": {"top": "00000000000000000000000000000001"},
+          "ports": {
+            "clk": {"direction": "input", "bits": [2]},
+            "a": {"direction": "input", "bits": [3, 4]},
+            "y": {"direction": "output", "bits": [5, 6, "1"]},
+            "q": {"direction": "output", "bits": [7]}
+          },
+          "cells": {
+            "$and": {"type": "$_AND_", "connections": {"A": [3], "B": [4], "Y": [5]}},
+            "$ornot": {"type": "$_ORNOT_", "connections": {"A": [3], "B": [4], "Y": [6]}},
+            "$ff": {"type": "$_DFF_P_", "connections": {"C": [2], "D": [8], "Q": [7]}},
+            "$not": {"type": "$_NOT_", "connections": {"A": [7], "Y": [8]}}
+          }
+        }
+      }
+    })";
+
+    // constants, inverters and a dead gate, which the optimization removes
+    const char OPTIMIZE_BLIF[] =
+            ".model optimize\n"
+            ".inputs a b c s\n"
+            ".outputs y z m k\n"
+            ".names one\n1\n"
+            ".names a na\n0 1\n"
+            ".names b nb\n0 1\n"
+            ".names na b t\n11 1\n"            // andny(a,b)
+            ".names t one y\n11 1\n"           // and(t,1) = t
+            ".names c one z\n10 1\n01 1\n"    // xor(c,1) = not(c)
+            ".names a b unused\n11 1\n"
+            ".names s na nb m\n11- 1\n0-1 1\n" // s?not(a):not(b) = not(s?a:b)
+            ".names s na b k\n11- 1\n0-1 1\n"  // s?not(a):b
+            ".end\n";
+
+    TfheNetlist *blif(const char *text) {
+        istringstream in(text);
+        return new_TfheNetlist_fromBlifStream(in);
+    }
+
+    class NetlistTest : public ::testing::Test {
+    public:
+        const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+        const TFheGateBootstrappingCloudKeySet *bk = &key->cloud;
+        const TFheGateBootstrappingParameterSet *params = key->params;
+    };
+
+    TEST_F(NetlistTest, blifAdderPlain) {
+        TfheNetlist *netlist = blif(ADDER_BLIF);
+        ASSERT_TRUE(netlist != 0);
+        ASSERT_EQ(5, tfhe_netlist_nb_inputs(netlist));
+        ASSERT_EQ(3, tfhe_netlist_nb_outputs(netlist));
+        ASSERT_EQ(0, tfhe_netlist_nb_registers(netlist));
+        ASSERT_STREQ("b0", tfhe_netlist_input_name(netlist, 2));
+        ASSERT_STREQ("cout", tfhe_netlist_output_name(netlist, 2));
+        for (int32_t m = 0; m < 32; m++) {
+            int32_t in[5], out[3];
+            for (int32_t i = 0; i < 5; i++) in[i] = (m >> i) & 1;
+            tfhe_netlist_eval_plain(netlist, out, in, 0);
+            const int32_t expected = (in[0] + 2 * in[1]) + (in[2] + 2 * in[3]) + in[4];
+            ASSERT_EQ(expected, out[0] + 2 * out[1] + 4 * out[2]) << m;
+        }
+        delete_TfheNetlist(netlist);
+    }
+
+    //the gates of a level only depend on the previous levels
+    TEST_F(NetlistTest, levelsAreTopological) {
+        TfheNetlist *netlist = blif(ADDER_BLIF);
+        vector<int32_t> ready(netlist->nb_wires, 0);
+        for (int32_t w: netlist->inputs) ready[w] = 1;
+        int32_t nb_bootstraps = 0;
+        for (const TfheNetlistLevel &level: netlist->levels) {
+            vector<int32_t> done;
+            for (int32_t g = level.begin; g < level.end; g++) {
+                const TfheNetlistGate &gate = netlist->gates[g];
+                ASSERT_EQ(g < level.free_begin, tfhe_gate_nb_bootstraps(gate.type) > 0);
+                // the muxes start first
+                if (g > level.begin && g < level.free_begin) {
+                    ASSERT_LE(tfhe_gate_nb_bootstraps(gate.type), tfhe_gate_nb_bootstraps(netlist->gates[g - 1].type));
+                }
+                for (int32_t i = 0; i < tfhe_gate_nb_inputs(gate.type); i++) ASSERT_TRUE(ready[gate.in[i]]);
+                nb_bootstraps += tfhe_gate_nb_bootstraps(gate.type);
+                if (g < level.free_begin) done.push_back(gate.out);
+                else ready[gate.out] = 1;
+                if (g + 1 == level.free_begin) for (int32_t w: done) ready[w] = 1;
+            }
+        }
+        ASSERT_EQ(tfhe_netlist_nb_bootstraps(netlist), nb_bootstraps);
+        delete_TfheNetlist(netlist);
+    }
+
+    TEST_F(NetlistTest, blifAdderEncrypted) {
+        TfheNetlist *netlist = blif(ADDER_BLIF);
+        LweSample *in = new_gate_bootstrapping_ciphertext_array(5, params);
+        LweSample *out = new_gate_bootstrapping_ciphertext_array(3, params);
+        for (int32_t trial = 0; trial < 4; trial++) {
+            const int32_t m = rand() % 32;
+            for (int32_t i = 0; i < 5; i++) bootsSymEncrypt(in + i, (m >> i) & 1, key);
+            tfhe_netlist_eval(netlist, out, in, 0, bk, 1 + trial % 2);
+            const int32_t expected = (m & 3) + ((m >> 2) & 3) + ((m >> 4) & 1);
+            ASSERT_EQ(expected, int32_t(bootsSymDecryptInt(out, 3, key)));
+        }
+        delete_gate_bootstrapping_ciphertext_array(3, out);
+        delete_gate_bootstrapping_ciphertext_array(5, in);
+        delete_TfheNetlist(netlist);
+    }
+
+    TEST_F(NetlistTest, blifCounter) {
+        TfheNetlist *netlist = blif(COUNTER_BLIF);
+        ASSERT_TRUE(netlist != 0);
+        ASSERT_EQ(2, tfhe_netlist_nb_registers(netlist));
+        ASSERT_EQ(1, tfhe_netlist_register_init(netlist, 0));
+        ASSERT_EQ(0, tfhe_netlist_register_init(netlist, 1));
+
+        LweSample *en = new_gate_bootstrapping_ciphertext(params);
+        LweSample *out = new_gate_bootstrapping_ciphertext_array(2, params);
+        LweSample *state = new_gate_bootstrapping_ciphertext_array(2, params);
+        int32_t plain_state[2] = {1, 0}, plain_out[2];
+        for (int32_t i = 0; i < 2; i++) bootsCONSTANT(state + i, plain_state[i], bk);
+        int32_t count = 1;
+        for (int32_t cycle = 0; cycle < 5; cycle++) {
+            const int32_t enable = (cycle != 2);
+            bootsSymEncrypt(en, enable, key);
+            tfhe_netlist_eval(netlist, out, en, state, bk, 0);
+            tfhe_netlist_eval_plain(netlist, plain_out, &enable, plain_state);
+            // the outputs are the registers before the clock edge
+            ASSERT_EQ(count, int32_t(bootsSymDecryptInt(out, 2, key)));
+            ASSERT_EQ(count, plain_out[0] + 2 * plain_out[1]);
+            count = (count + enable) % 4;
+            ASSERT_EQ(count, int32_t(bootsSymDecryptInt(state, 2, key)));
+            ASSERT_EQ(count, plain_state[0] + 2 * plain_state[1]);
+        }
+        delete_gate_bootstrapping_ciphertext_array(2, state);
+        delete_gate_bootstrapping_ciphertext_array(2, out);
+        delete_gate_bootstrapping_ciphertext(en);
+        delete_TfheNetlist(netlist);
+    }
+
+    TEST_F(NetlistTest, blifEnableFlipFlops) {
+        TfheNetlist *netlist = blif(ENABLE_BLIF);
+        ASSERT_TRUE(netlist != 0);
+        ASSERT_EQ(2, tfhe_netlist_nb_registers(netlist));
+
+        LweSample *in = new_gate_bootstrapping_ciphertext_array(3, params);
+        LweSample *out = new_gate_bootstrapping_ciphertext_array(2, params);
+        LweSample *state = new_gate_bootstrapping_ciphertext_array(2, params);
+        int32_t plain_state[2] = {0, 0}, plain_out[2];
+        for (int32_t i = 0; i < 2; i++) bootsCONSTANT(state + i, 0, bk);
+        int32_t expected[2] = {0, 0};
+        const int32_t cycles[][2] = {{1, 1}, {0, 1}, {0, 0}, {1, 0}, {1, 1}, {0, 0}};
+        for (const int32_t *cycle: cycles) {
+            const int32_t plain_in[3] = {0, cycle[0], cycle[1]};
+            for (int32_t i = 0; i < 3; i++) bootsSymEncrypt(in + i, plain_in[i], key);
+            tfhe_netlist_eval(netlist, out, in, state, bk, 0);
+            tfhe_netlist_eval_plain(netlist, plain_out, plain_in, plain_state);
+            for (int32_t i = 0; i < 2; i++) {
+                ASSERT_EQ(expected[i], plain_out[i]);
+                ASSERT_EQ(expected[i], bootsSymDecrypt(out + i, key));
+            }
+            // qp loads d when e is 1, qn when e is 0
+            if (cycle[1] == 1) expected[0] = cycle[0];
+            else expected[1] = cycle[0];
+            for (int32_t i = 0; i < 2; i++) {
+                ASSERT_EQ(expected[i], plain_state[i]);
+                ASSERT_EQ(expected[i], bootsSymDecrypt(state + i, key));
+            }
+        }
+        delete_gate_bootstrapping_ciphertext_array(2, state);
+        delete_gate_bootstrapping_ciphertext_array(2, out);
+        delete_gate_bootstrapping_ciphertext_array(3, in);
+        delete_TfheNetlist(netlist);
+    }
+
+    TEST_F(NetlistTest, yosysJson) {
+        istringstream json(TOGGLE_JSON);
+        TfheNetlist *netlist = new_TfheNetlist_fromYosysJsonStream(json);
+        ASSERT_TRUE(netlist != 0);
+        ASSERT_EQ(3, tfhe_netlist_nb_inputs(netlist));
+        ASSERT_EQ(4, tfhe_netlist_nb_outputs(netlist));
+        ASSERT_EQ(1, tfhe_netlist_nb_registers(netlist));
+        ASSERT_STREQ("a[1]", tfhe_netlist_input_name(netlist, 2));
+        ASSERT_STREQ("y[2]", tfhe_netlist_output_name(netlist, 2));
+        ASSERT_STREQ("q", tfhe_netlist_output_name(netlist, 3));
+        int32_t state = 0;
+        for (int32_t m = 0; m < 8; m++) {
+            const int32_t in[3] = {0, m & 1, (m >> 1) & 1};
+            int32_t out[4];
+            tfhe_netlist_eval_plain(netlist, out, in, &state);
+            ASSERT_EQ(in[1] & in[2], out[0]);
+            ASSERT_EQ(in[1] | (1 - in[2]), out[1]);
+            ASSERT_EQ(1, out[2]);
+            ASSERT_EQ(m & 1, out[3]);
+            ASSERT_EQ(1 - (m & 1), state);
+        }
+        delete_TfheNetlist(netlist);
+    }
+
+    //the optimized netlists compute the same functions with fewer bootstraps
+    TEST_F(NetlistTest, optimize) {
+        const char *texts[] = {OPTIMIZE_BLIF, ADDER_BLIF, COUNTER_BLIF};
+        for (const char *text: texts) {
+            TfheNetlist *original = blif(text);
+            TfheNetlist *optimized = blif(text);
+            const int32_t saved = tfhe_netlist_optimize(optimized);
+            ASSERT_EQ(tfhe_netlist_nb_bootstraps(original) - saved, tfhe_netlist_nb_bootstraps(optimized));
+            const int32_t nb_inputs = tfhe_netlist_nb_inputs(original);
+            const int32_t nb_registers = tfhe_netlist_nb_registers(original);
+            ASSERT_EQ(nb_inputs, tfhe_netlist_nb_inputs(optimized));
+            ASSERT_EQ(nb_registers, tfhe_netlist_nb_registers(optimized));
+            for (int32_t m = 0; m < (1 << (nb_inputs + nb_registers)); m++) {
+                int32_t in[8], state1[8], state2[8], out1[8], out2[8];
+                for (int32_t i = 0; i < nb_inputs; i++) in[i] = (m >> i) & 1;
+                for (int32_t i = 0; i < nb_registers; i++) state1[i] = state2[i] = (m >> (nb_inputs + i)) & 1;
+                tfhe_netlist_eval_plain(original, out1, in, state1);
+                tfhe_netlist_eval_plain(optimized, out2, in, state2);
+                for (int32_t i = 0; i < tfhe_netlist_nb_outputs(original); i++) ASSERT_EQ(out1[i], out2[i]);
+                for (int32_t i = 0; i < nb_registers; i++) ASSERT_EQ(state1[i], state2[i]);
+            }
+            delete_TfheNetlist(optimized);
+            delete_TfheNetlist(original);
+        }
+
+        TfheNetlist *netlist = blif(OPTIMIZE_BLIF);
+        ASSERT_EQ(8, tfhe_netlist_nb_bootstraps(netlist));
+        ASSERT_EQ(3, tfhe_netlist_optimize(netlist));
+        ASSERT_EQ(0, tfhe_netlist_optimize(netlist));
+        // andny, and the two muxes, all on the inputs
+        ASSERT_EQ(1, tfhe_netlist_nb_levels(netlist));
+        LweSample *in = new_gate_bootstrapping_ciphertext_array(4, params);
+        LweSample *out = new_gate_bootstrapping_ciphertext_array(4, params);
+        for (int32_t trial = 0; trial < 3; trial++) {
+            int32_t plain_in[4], plain_out[4];
+            for (int32_t i = 0; i < 4; i++) {
+                plain_in[i] = rand() % 2;
+                bootsSymEncrypt(in + i, plain_in[i], key);
+            }
+            tfhe_netlist_eval(netlist, out, in, 0, bk, 0);
+            tfhe_netlist_eval_plain(netlist, plain_out, plain_in, 0);
+            for (int32_t i = 0; i < 4; i++) ASSERT_EQ(plain_out[i], bootsSymDecrypt(out + i, key));
+        }
+        delete_gate_bootstrapping_ciphertext_array(4, out);
+        delete_gate_bootstrapping_ciphertext_array(4, in);
+        delete_TfheNetlist(netlist);
+    }
+
+    TEST_F(NetlistTest, invalidNetlists) {
+        const char *invalid[] = {
+                // combinational loop
+                ".model loop\n.inputs a\n.outputs x\n.names a y x\n11 1\n.names x y\n0 1\n.end\n",
+                // wire without driver
+                ".model undriven\n.inputs a\n.outputs x\n.names a b x\n11 1\n.end\n",
+                // two drivers
+                ".model twice\n.inputs a\n.outputs x\n.names a x\n1 1\n.names a x\n0 1\n.end\n",
+                // unknown cell
+                ".model cell\n.inputs a\n.outputs x\n.subckt adder A=a Y=x\n.end\n",
+                // mixed cover
+                ".model cover\n.inputs a b\n.outputs x\n.names a b x\n11 1\n00 0\n.end\n",
+        };
+        for (const char *text: invalid) ASSERT_TRUE(blif(text) == 0) << text;
+        istringstream json("{\"modules\": {\"top\": {\"ports\": [}}}");
+        ASSERT_TRUE(new_TfheNetlist_fromYosysJsonStream(json) == 0);
+    }
+
+}
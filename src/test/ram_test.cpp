@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    //writes at encrypted addresses, with a refresh every 2 writes, then reads every word
+    TEST(RamTest, writeThenReadAtEncryptedAddresses) {
+        const TFheGateBootstrappingSecretKeySet *key = small_circuit_bootstrapping_keyset();
+        const TfheCircuitBootstrappingKey *cbk = small_circuit_bootstrapping_key();
+        const int32_t m = 3;
+        const int32_t word_size = 4;
+        TfheRam *ram = new_TfheRam(m, word_size, cbk, 2, 2);
+
+        vector<uint32_t> expected(1 << m, 0);
+        LweSample *address = new_gate_bootstrapping_ciphertext_array(m, key->params);
+        LweSample *word = new_gate_bootstrapping_ciphertext_array(word_size, key->params);
+        for (int32_t x: {5, 2, 5}) {
+            const uint32_t value = rand() % 16;
+            for (int32_t i = 0; i < m; i++) bootsSymEncrypt(address + i, (x >> i) & 1, key);
+            for (int32_t b = 0; b < word_size; b++) bootsSymEncrypt(word + b, (value >> b) & 1, key);
+            tfhe_ram_write_bits(ram, address, word);
+            expected[x] = value;
+        }
+        ASSERT_EQ(1, ram->nb_writes);
+        for (int32_t x = 0; x < (1 << m); x++) {
+            for (int32_t i = 0; i < m; i++) bootsSymEncrypt(address + i, (x >> i) & 1, key);
+            tfhe_ram_read_bits(word, ram, address);
+            for (int32_t b = 0; b < word_size; b++) ASSERT_EQ(int32_t((expected[x] >> b) & 1), bootsSymDecrypt(word + b, key));
+        }
+
+        delete_gate_bootstrapping_ciphertext_array(word_size, word);
+        delete_gate_bootstrapping_ciphertext_array(m, address);
+        delete_TfheRam(ram);
+    }
+
+}
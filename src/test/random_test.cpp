@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <cmath>
+#include <numeric_functions.h>
+
+using namespace std;
+
+namespace {
+
+    class RandomTest : public ::testing::Test {
+    };
+
+    // keystream of ChaCha20 with the zero key (RFC 7539, A.1 test vectors #1 and #2)
+    TEST_F(RandomTest, chachaTestVector) {
+        TfheRandomEngine engine;
+        const uint32_t key[TfheRandomEngine::KEY_WORDS] = {0};
+        engine.seed_key(key);
+        ASSERT_EQ(0xade0b876u, engine());
+        ASSERT_EQ(0x903df1a0u, engine());
+        engine.discard(14);
+        ASSERT_EQ(0xbee7079fu, engine());
+    }
+
+    // the bulk functions output the same stream as the successive calls
+    TEST_F(RandomTest, fillAndDiscard) {
+        static const int32_t SIZE = 1000;
+        seed_seq seeds = {1, 2, 3};
+        TfheRandomEngine engine(seeds);
+        TfheRandomEngine copy = engine;
+        vector<uint32_t> expected(SIZE);
+        for (uint32_t &x: expected) x = engine();
+
+        vector<uint32_t> actual(SIZE);
+        actual[0] = copy();
+        copy.fill(actual.data() + 1, 500);
+        copy.discard(100);
+        copy.fill(actual.data() + 601, SIZE - 601);
+        for (int32_t i = 0; i <= 500; i++) ASSERT_EQ(expected[i], actual[i]);
+        for (int32_t i = 601; i < SIZE; i++) ASSERT_EQ(expected[i], actual[i]);
+    }
+
+    TEST_F(RandomTest, standardNormal) {
+        static const int32_t SIZE = 100000;
+        seed_seq seeds = {42};
+        TfheRandomEngine engine(seeds);
+        vector<double> values(SIZE);
+        engine.fill_standard_normal(values.data(), SIZE);
+        double mean = 0, var = 0;
+        for (double v: values) mean += v;
+        mean /= SIZE;
+        for (double v: values) var += (v - mean) * (v - mean);
+        var /= SIZE;
+        ASSERT_LE(abs(mean), 0.02);
+        ASSERT_LE(abs(var - 1.), 0.02);
+    }
+
+    TEST_F(RandomTest, bulkFunctions) {
+        static const int32_t SIZE = 4096;
+        seed_seq seeds = {42};
+        generator.seed(seeds);
+
+        vector<int32_t> bits(SIZE);
+        uniformBinary_array(bits.data(), SIZE);
+        int32_t nb_ones = 0;
+        for (int32_t b: bits) {
+            ASSERT_TRUE(b == 0 || b == 1);
+            nb_ones += b;
+        }
+        ASSERT_GT(nb_ones, SIZE / 2 - 200);
+        ASSERT_LT(nb_ones, SIZE / 2 + 200);
+
+        vector<Torus32> messages(SIZE), noisy(SIZE);
+        uniformTorus32_array(messages.data(), SIZE);
+        gaussian32_array(noisy.data(), messages.data(), SIZE, 1e-3);
+        double var = 0;
+        for (int32_t i = 0; i < SIZE; i++) var += pow(t32tod(noisy[i] - messages[i]), 2);
+        var /= SIZE;
+        ASSERT_LE(abs(var / 1e-6 - 1.), 0.1);
+    }
+
+}
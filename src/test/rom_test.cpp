@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    //a ROM of 2^9 bytes: 7 low address bits rotate a polynomial, 2 high bits select it
+    TEST(RomTest, readAtEncryptedAddress) {
+        const TFheGateBootstrappingSecretKeySet *key = small_circuit_bootstrapping_keyset();
+        const TfheCircuitBootstrappingKey *cbk = small_circuit_bootstrapping_key();
+        const int32_t m = 9;
+        const int32_t word_size = 8;
+
+        vector<uint32_t> table(1 << m);
+        for (uint32_t &word: table) word = rand() % 256;
+        TfheRom *rom = new_TfheRom(table.data(), m, word_size, cbk, 2);
+        ASSERT_EQ(7, rom->nu);
+
+        LweSample *address = new_gate_bootstrapping_ciphertext_array(m, key->params);
+        LweSample *word = new_gate_bootstrapping_ciphertext_array(word_size, key->params);
+        for (int32_t x: {0, 127, 128, 300, 511}) {
+            for (int32_t i = 0; i < m; i++) bootsSymEncrypt(address + i, (x >> i) & 1, key);
+            tfhe_rom_read_bits(word, rom, address);
+            for (int32_t b = 0; b < word_size; b++) ASSERT_EQ(int32_t((table[x] >> b) & 1), bootsSymDecrypt(word + b, key));
+        }
+
+        delete_gate_bootstrapping_ciphertext_array(word_size, word);
+        delete_gate_bootstrapping_ciphertext_array(m, address);
+        delete_TfheRom(rom);
+    }
+
+}
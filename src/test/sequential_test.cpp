@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    // 3-bit counter enabled by en, and two registers swapped at each cycle
+    const char *COUNTER_BLIF =
+            ".model counter\n"
+            ".inputs en\n"
+            ".outputs q0 q1 q2 s0 wrap\n"
+            ".latch d0 q0 0\n.latch d1 q1 0\n.latch d2 q2 1\n"
+            ".latch s1 s0 0\n.latch s0 s1 1\n"
+            ".names en q0 d0\n10 1\n01 1\n"
+            ".names en q0 c1\n11 1\n"
+            ".names c1 q1 d1\n10 1\n01 1\n"
+            ".names c1 q1 c2\n11 1\n"
+            ".names c2 q2 d2\n10 1\n01 1\n"
+            ".names c2 q2 wrap\n11 1\n"
+            ".end\n";
+
+    class SequentialTest : public ::testing::Test {
+    public:
+        const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+        const TFheGateBootstrappingCloudKeySet *bk = &key->cloud;
+        const TFheGateBootstrappingParameterSet *params = key->params;
+    };
+
+    //the cycles evaluated by windows give the same outputs and registers as the plaintext evaluation
+    TEST_F(SequentialTest, runByWindows) {
+        istringstream in(COUNTER_BLIF);
+        TfheNetlist *netlist = new_TfheNetlist_fromBlifStream(in);
+        ASSERT_TRUE(netlist != 0);
+        const int32_t nb_outputs = tfhe_netlist_nb_outputs(netlist);
+        const int32_t nb_registers = tfhe_netlist_nb_registers(netlist);
+        ASSERT_EQ(5, nb_registers);
+
+        const int32_t nb_cycles = 5;
+        int32_t plain_state[5];
+        for (int32_t r = 0; r < nb_registers; r++) plain_state[r] = tfhe_netlist_register_init(netlist, r);
+        LweSample *inputs = new_gate_bootstrapping_ciphertext_array(nb_cycles, params);
+        LweSample *outputs = new_gate_bootstrapping_ciphertext_array(nb_cycles * nb_outputs, params);
+        int32_t plain_inputs[nb_cycles];
+        for (int32_t c = 0; c < nb_cycles; c++) {
+            plain_inputs[c] = (c != 2);
+            bootsSymEncrypt(inputs + c, plain_inputs[c], key);
+        }
+
+        // a window of 2 cycles: 2 full windows, then a window of 1 cycle
+        TfheSequentialEngine *engine = new_TfheSequentialEngine(netlist, bk, 0, 2);
+        tfhe_sequential_run(engine, outputs, inputs, nb_cycles);
+        for (int32_t c = 0; c < nb_cycles; c++) {
+            int32_t plain_outputs[5];
+            tfhe_netlist_eval_plain(netlist, plain_outputs, plain_inputs + c, plain_state);
+            for (int32_t i = 0; i < nb_outputs; i++)
+                ASSERT_EQ(plain_outputs[i], bootsSymDecrypt(outputs + c * nb_outputs + i, key));
+        }
+        LweSample *state = tfhe_sequential_state(engine);
+        for (int32_t r = 0; r < nb_registers; r++) ASSERT_EQ(plain_state[r], bootsSymDecrypt(state + r, key));
+
+        ASSERT_EQ(nb_cycles, tfhe_sequential_nb_cycles(engine));
+        for (int32_t c = 0; c < nb_cycles; c++) {
+            const TfheCycleStats stats = tfhe_sequential_cycle_stats(engine, c);
+            ASSERT_GE(stats.start, 0);
+            ASSERT_GT(stats.end, stats.start);
+        }
+        // the cycles of a window overlap: the next one starts before the end of the previous one
+        ASSERT_LT(tfhe_sequential_cycle_stats(engine, 1).start, tfhe_sequential_cycle_stats(engine, 0).end);
+        ASSERT_LT(tfhe_sequential_cycle_stats(engine, 3).start, tfhe_sequential_cycle_stats(engine, 2).end);
+        // the windows run one after the other
+        ASSERT_GE(tfhe_sequential_cycle_stats(engine, 2).start, tfhe_sequential_cycle_stats(engine, 1).end);
+        ASSERT_GE(tfhe_sequential_cycle_stats(engine, 4).start, tfhe_sequential_cycle_stats(engine, 3).end);
+
+        // the reset state gives the outputs of the first cycle again
+        tfhe_sequential_reset(engine);
+        tfhe_sequential_run(engine, outputs, inputs, 1);
+        for (int32_t r = 0; r < nb_registers; r++) plain_state[r] = tfhe_netlist_register_init(netlist, r);
+        int32_t plain_outputs[5];
+        tfhe_netlist_eval_plain(netlist, plain_outputs, plain_inputs, plain_state);
+        for (int32_t i = 0; i < nb_outputs; i++) ASSERT_EQ(plain_outputs[i], bootsSymDecrypt(outputs + i, key));
+        ASSERT_EQ(nb_cycles + 1, tfhe_sequential_nb_cycles(engine));
+
+        delete_TfheSequentialEngine(engine);
+        delete_gate_bootstrapping_ciphertext_array(nb_cycles * nb_outputs, outputs);
+        delete_gate_bootstrapping_ciphertext_array(nb_cycles, inputs);
+        delete_TfheNetlist(netlist);
+    }
+
+}
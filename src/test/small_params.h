@@ -0,0 +1,94 @@
+#ifndef TFHE_TEST_SMALL_PARAMS_H
+#define TFHE_TEST_SMALL_PARAMS_H
+
+#include <cmath>
+#include "tfhe.h"
+
+namespace {
+
+    /** the distance between two torus values, in [0,1/2] */
+    inline double torus_distance(Torus32 x, Torus32 y) {
+        return fabs(t32tod(x - y));
+    }
+
+    /**
+     * tiny (insecure!) gate bootstrapping parameters, with a very small noise, so that
+     * the tests can generate a real cloud key and run real gates in a few milliseconds
+     */
+    inline const TFheGateBootstrappingParameterSet *new_small_test_parameters() {
+        static const int32_t N = 1024; //the only size supported by the spqlios fft
+        static const int32_t k = 1;
+        static const int32_t n = 64;
+        static const int32_t bk_l = 2;
+        static const int32_t bk_Bgbit = 10;
+        static const int32_t ks_basebit = 2;
+        static const int32_t ks_length = 8;
+        static const double ks_stdev = 1e-6;
+        static const double bk_stdev = 1e-9;
+        static const double max_stdev = 0.012467;
+
+        LweParams *params_in = new_LweParams(n, ks_stdev, max_stdev);
+        TLweParams *params_accum = new_TLweParams(N, k, bk_stdev, max_stdev);
+        TGswParams *params_bk = new_TGswParams(bk_l, bk_Bgbit, params_accum);
+        return new TFheGateBootstrappingParameterSet(ks_length, ks_basebit, params_in, params_bk);
+    }
+
+    /** the keyset of the small parameters (generated once, with a fixed seed) */
+    inline const TFheGateBootstrappingSecretKeySet *small_test_keyset() {
+        static const TFheGateBootstrappingSecretKeySet *keyset = 0;
+        if (keyset == 0) {
+            uint32_t seed = 314;
+            tfhe_random_generator_setSeed(&seed, 1);
+            keyset = new_random_gate_bootstrapping_secret_keyset(new_small_test_parameters());
+        }
+        return keyset;
+    }
+
+    /**
+     * tiny (insecure!) parameters for the circuit bootstrapping: the bootstrapping key has a finer
+     * decomposition and a smaller noise than new_small_test_parameters, so that the rows of the
+     * circuit bootstrapped TGsw samples are precise enough for a sequence of external products
+     */
+    inline const TFheGateBootstrappingParameterSet *new_small_circuit_bootstrapping_parameters() {
+        static const int32_t N = 1024;
+        static const int32_t k = 1;
+        static const int32_t n = 64;
+        static const int32_t bk_l = 6;
+        static const int32_t bk_Bgbit = 5;
+        static const int32_t ks_basebit = 2;
+        static const int32_t ks_length = 8;
+        static const double ks_stdev = 1e-6;
+        static const double bk_stdev = 2.4e-10;
+        static const double max_stdev = 0.012467;
+
+        LweParams *params_in = new_LweParams(n, ks_stdev, max_stdev);
+        TLweParams *params_accum = new_TLweParams(N, k, bk_stdev, max_stdev);
+        TGswParams *params_bk = new_TGswParams(bk_l, bk_Bgbit, params_accum);
+        return new TFheGateBootstrappingParameterSet(ks_length, ks_basebit, params_in, params_bk);
+    }
+
+    /** the keyset of the circuit bootstrapping parameters (generated once, with a fixed seed) */
+    inline const TFheGateBootstrappingSecretKeySet *small_circuit_bootstrapping_keyset() {
+        static const TFheGateBootstrappingSecretKeySet *keyset = 0;
+        if (keyset == 0) {
+            uint32_t seed = 2718;
+            tfhe_random_generator_setSeed(&seed, 1);
+            keyset = new_random_gate_bootstrapping_secret_keyset(new_small_circuit_bootstrapping_parameters());
+        }
+        return keyset;
+    }
+
+    /** the circuit bootstrapping key of small_circuit_bootstrapping_keyset, to TGsw samples of l=4, Bg=16 */
+    inline const TfheCircuitBootstrappingKey *small_circuit_bootstrapping_key() {
+        static const TfheCircuitBootstrappingKey *cbk = 0;
+        if (cbk == 0) {
+            const TFheGateBootstrappingSecretKeySet *keyset = small_circuit_bootstrapping_keyset();
+            const TGswParams *params = new_TGswParams(4, 4, keyset->params->tgsw_params->tlwe_params);
+            cbk = new_TfheCircuitBootstrappingKey(keyset, params, 6, 4);
+        }
+        return cbk;
+    }
+
+}
+
+#endif //TFHE_TEST_SMALL_PARAMS_H
@@ -0,0 +1,149 @@
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <queue>
+#include <vector>
+#include <sys/time.h>
+#include "tfhe.h"
+
+using namespace std;
+
+// compares the fifo and the critical path scheduling of the gate executor on a multiplier:
+//   test-gate-scheduling [nb_bits [nb_threads]]
+// prints the measured time of each policy, and the makespan of an ideal list scheduling
+// (in bootstraps) with the same number of threads, which does not depend on the machine
+
+
+static double now() {
+    timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + 1e-6 * t.tv_usec;
+}
+
+// (x + y + carry) mod 2, and the next carry
+static void add_bit(TfheGateExecutor *executor, LweSample *sum, LweSample *carry, const LweSample *x,
+                    const LweSample *y, LweSample *temp) {
+    tfhe_executor_add_gate(executor, TFHE_GATE_XOR, temp, x, y, 0);
+    tfhe_executor_add_gate(executor, TFHE_GATE_AND, temp + 1, x, y, 0);
+    tfhe_executor_add_gate(executor, TFHE_GATE_XOR, sum, temp, carry, 0);
+    tfhe_executor_add_gate(executor, TFHE_GATE_MUX, carry, temp, carry, temp + 1);
+}
+
+// the makespan of a list scheduling of the recorded gates on nb_threads threads, with a global ready list
+static int32_t simulate(TfheGateExecutor *executor, TfheSchedulingPolicy policy, int32_t nb_threads) {
+    executor->update_priorities();
+    const vector<TfheGateNode> &gates = executor->gates;
+    const int32_t nb_gates = gates.size();
+    vector<int32_t> pending(nb_gates);
+    auto later = [&](int32_t g1, int32_t g2) {
+        if (gates[g1].priority != gates[g2].priority) return gates[g1].priority < gates[g2].priority;
+        return g1 > g2;
+    };
+    priority_queue<int32_t, vector<int32_t>, decltype(later)> by_priority(later);
+    deque<int32_t> fifo;
+    auto push = [&](int32_t g) {
+        if (policy == TFHE_SCHEDULE_FIFO) fifo.push_back(g);
+        else by_priority.push(g);
+    };
+    for (int32_t g = 0; g < nb_gates; g++) {
+        pending[g] = gates[g].nb_predecessors;
+        if (pending[g] == 0) push(g);
+    }
+    // the running gates, by end time
+    priority_queue<pair<int32_t, int32_t>, vector<pair<int32_t, int32_t> >, greater<pair<int32_t, int32_t> > > running;
+    int32_t time = 0, nb_done = 0;
+    while (nb_done < nb_gates) {
+        while (int32_t(running.size()) < nb_threads && !(fifo.empty() && by_priority.empty())) {
+            int32_t g;
+            if (policy == TFHE_SCHEDULE_FIFO) {
+                g = fifo.front();
+                fifo.pop_front();
+            } else {
+                g = by_priority.top();
+                by_priority.pop();
+            }
+            running.push(make_pair(time + tfhe_gate_nb_bootstraps(gates[g].type), g));
+        }
+        const pair<int32_t, int32_t> done = running.top();
+        running.pop();
+        time = done.first;
+        nb_done++;
+        for (int32_t s: gates[done.second].successors) if (--pending[s] == 0) push(s);
+    }
+    return time;
+}
+
+int32_t main(int32_t argc, char **argv) {
+    const int32_t nb_bits = (argc > 1) ? atoi(argv[1]) : 8;
+    const int32_t nb_threads = (argc > 2) ? atoi(argv[2]) : tfhe_get_nb_threads();
+
+    TFheGateBootstrappingParameterSet *params = new_default_gate_bootstrapping_parameters(110);
+    uint32_t seed[] = {314, 1592, 657};
+    tfhe_random_generator_setSeed(seed, 3);
+    TFheGateBootstrappingSecretKeySet *key = new_random_gate_bootstrapping_secret_keyset(params);
+    const TFheGateBootstrappingCloudKeySet *bk = &key->cloud;
+
+    // the schoolbook multiplier: the partial products of each row are added to the accumulator
+    LweSample *a = new_gate_bootstrapping_ciphertext_array(nb_bits, params);
+    LweSample *b = new_gate_bootstrapping_ciphertext_array(nb_bits, params);
+    LweSample *product = new_gate_bootstrapping_ciphertext_array(2 * nb_bits, params);
+    LweSample *partial = new_gate_bootstrapping_ciphertext_array(nb_bits * nb_bits, params);
+    LweSample *carries = new_gate_bootstrapping_ciphertext_array(nb_bits, params);
+    LweSample *temps = new_gate_bootstrapping_ciphertext_array(2 * nb_bits * nb_bits, params);
+    TfheGateExecutor *executor = new_TfheGateExecutor(bk);
+    for (int32_t i = 0; i < nb_bits; i++) {
+        for (int32_t j = 0; j < nb_bits; j++)
+            tfhe_executor_add_gate(executor, TFHE_GATE_AND, partial + i * nb_bits + j, a + j, b + i, 0);
+    }
+    for (int32_t j = 0; j < 2 * nb_bits; j++) {
+        if (j < nb_bits) tfhe_executor_add_gate(executor, TFHE_GATE_COPY, product + j, partial + j, 0, 0);
+        else tfhe_executor_add_constant(executor, product + j, 0);
+    }
+    for (int32_t i = 1; i < nb_bits; i++) {
+        LweSample *carry = carries + i;
+        tfhe_executor_add_constant(executor, carry, 0);
+        for (int32_t j = 0; j < nb_bits; j++) {
+            LweSample *sum = product + i + j;
+            add_bit(executor, sum, carry, sum, partial + i * nb_bits + j, temps + 2 * (i * nb_bits + j));
+        }
+        tfhe_executor_add_gate(executor, TFHE_GATE_COPY, product + i + nb_bits, carry, 0, 0);
+    }
+
+    int32_t nb_bootstraps = 0;
+    for (const TfheGateNode &node: executor->gates) nb_bootstraps += tfhe_gate_nb_bootstraps(node.type);
+    const int32_t critical_path = tfhe_executor_critical_path(executor);
+    cout << nb_bits << "-bit multiplier: " << executor->gates.size() << " gates, " << nb_bootstraps
+         << " bootstraps, critical path " << critical_path << ", " << nb_threads << " threads" << endl;
+    cout << "lower bound of the makespan: "
+         << max(critical_path, (nb_bootstraps + nb_threads - 1) / nb_threads) << " bootstraps" << endl;
+
+    const int32_t x = rand() & ((1 << nb_bits) - 1);
+    const int32_t y = rand() & ((1 << nb_bits) - 1);
+    const TfheSchedulingPolicy policies[] = {TFHE_SCHEDULE_FIFO, TFHE_SCHEDULE_CRITICAL_PATH};
+    const char *names[] = {"fifo", "critical path"};
+    for (int32_t p = 0; p < 2; p++) {
+        for (int32_t i = 0; i < nb_bits; i++) {
+            bootsSymEncrypt(a + i, (x >> i) & 1, key);
+            bootsSymEncrypt(b + i, (y >> i) & 1, key);
+        }
+        tfhe_executor_set_policy(executor, policies[p]);
+        const double start = now();
+        tfhe_executor_run(executor, nb_threads);
+        const double time = now() - start;
+        int64_t result = 0;
+        for (int32_t i = 0; i < 2 * nb_bits; i++) result |= int64_t(bootsSymDecrypt(product + i, key)) << i;
+        cout << names[p] << ": " << time << " s, ideal makespan " << simulate(executor, policies[p], nb_threads)
+             << " bootstraps" << (result == int64_t(x) * y ? "" : " WRONG RESULT") << endl;
+    }
+
+    delete_TfheGateExecutor(executor);
+    delete_gate_bootstrapping_ciphertext_array(2 * nb_bits * nb_bits, temps);
+    delete_gate_bootstrapping_ciphertext_array(nb_bits, carries);
+    delete_gate_bootstrapping_ciphertext_array(nb_bits * nb_bits, partial);
+    delete_gate_bootstrapping_ciphertext_array(2 * nb_bits, product);
+    delete_gate_bootstrapping_ciphertext_array(nb_bits, b);
+    delete_gate_bootstrapping_ciphertext_array(nb_bits, a);
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "tfhe.h"
+
+using namespace std;
+
+// benchmarks the word-level arithmetic:
+//   test-integer-arithmetic [max_bits [max_threads]]
+// for each operation at 8, 16, 32... up to max_bits bits (64 by default), prints the number of bootstraps
+// and the depth of its circuit, then its time on 1, 2, 4... up to max_threads threads
+
+
+typedef unsigned __int128 uint128;
+
+struct Operation {
+    const char *name;
+    /** records the operation: the result has 2n bits, shift has log2(n) bits */
+    function<void(TfheIntegerCircuit *, LweSample *, const LweSample *, const LweSample *, const LweSample *,
+                  int32_t)> record;
+    /** the plain result */
+    function<uint128(uint64_t, uint64_t, int32_t, int32_t)> plain;
+};
+
+static uint64_t mask(int32_t n) {
+    return (n == 64) ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+}
+
+static uint64_t random_bits(int32_t n) {
+    uint64_t result = 0;
+    for (int32_t i = 0; i < 4; i++) result = (result << 16) ^ uint64_t(rand() & 0xffff);
+    return result & mask(n);
+}
+
+int32_t main(int32_t argc, char **argv) {
+    const int32_t max_bits = (argc > 1) ? atoi(argv[1]) : 64;
+    const int32_t max_threads = (argc > 2) ? atoi(argv[2]) : tfhe_get_nb_threads();
+
+    TFheGateBootstrappingParameterSet *params = new_default_gate_bootstrapping_parameters(110);
+    uint32_t seed[] = {314, 1592, 657};
+    tfhe_random_generator_setSeed(seed, 3);
+    TFheGateBootstrappingSecretKeySet *key = new_random_gate_bootstrapping_secret_keyset(params);
+    const TFheGateBootstrappingCloudKeySet *bk = &key->cloud;
+
+    const Operation operations[] = {
+            {"add (ripple)",
+                    [](TfheIntegerCircuit *c, LweSample *r, const LweSample *a, const LweSample *b, const LweSample *,
+                       int32_t n) { tfhe_integer_add(c, r, r + n, a, b, n, TFHE_ADDER_RIPPLE); },
+                    [](uint64_t x, uint64_t y, int32_t, int32_t) { return uint128(x) + y; }},
+            {"add (prefix)",
+                    [](TfheIntegerCircuit *c, LweSample *r, const LweSample *a, const LweSample *b, const LweSample *,
+                       int32_t n) { tfhe_integer_add(c, r, r + n, a, b, n, TFHE_ADDER_PREFIX); },
+                    [](uint64_t x, uint64_t y, int32_t, int32_t) { return uint128(x) + y; }},
+            {"sub (prefix)",
+                    [](TfheIntegerCircuit *c, LweSample *r, const LweSample *a, const LweSample *b, const LweSample *,
+                       int32_t n) { tfhe_integer_sub(c, r, 0, a, b, n, TFHE_ADDER_PREFIX); },
+                    [](uint64_t x, uint64_t y, int32_t n, int32_t) { return uint128((x - y) & mask(n)); }},
+            {"less than",
+                    [](TfheIntegerCircuit *c, LweSample *r, const LweSample *a, const LweSample *b, const LweSample *,
+                       int32_t n) { tfhe_integer_less_than(c, r, a, b, n, 0); },
+                    [](uint64_t x, uint64_t y, int32_t, int32_t) { return uint128(x < y); }},
+            {"equal",
+                    [](TfheIntegerCircuit *c, LweSample *r, const LweSample *a, const LweSample *b, const LweSample *,
+                       int32_t n) { tfhe_integer_equal(c, r, a, b, n); },
+                    [](uint64_t x, uint64_t y, int32_t, int32_t) { return uint128(x == y); }},
+            {"shift left",
+                    [](TfheIntegerCircuit *c, LweSample *r, const LweSample *a, const LweSample *, const LweSample *s,
+                       int32_t n) { tfhe_integer_shift_left(c, r, a, n, s, __builtin_ctz(n)); },
+                    [](uint64_t x, uint64_t, int32_t n, int32_t s) { return uint128((x << s) & mask(n)); }},
+            {"mul (array)",
+                    [](TfheIntegerCircuit *c, LweSample *r, const LweSample *a, const LweSample *b, const LweSample *,
+                       int32_t n) { tfhe_integer_mul(c, r, a, b, n, TFHE_MULTIPLIER_ARRAY); },
+                    [](uint64_t x, uint64_t y, int32_t, int32_t) { return uint128(x) * y; }},
+            {"mul (dadda)",
+                    [](TfheIntegerCircuit *c, LweSample *r, const LweSample *a, const LweSample *b, const LweSample *,
+                       int32_t n) { tfhe_integer_mul(c, r, a, b, n, TFHE_MULTIPLIER_DADDA); },
+                    [](uint64_t x, uint64_t y, int32_t, int32_t) { return uint128(x) * y; }},
+    };
+
+    for (int32_t n = 8; n <= max_bits && n <= 64; n *= 2) {
+        const int32_t nb_shift_bits = __builtin_ctz(n);
+        LweSample *a = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *b = new_gate_bootstrapping_ciphertext_array(n, params);
+        LweSample *shift = new_gate_bootstrapping_ciphertext_array(nb_shift_bits, params);
+        LweSample *result = new_gate_bootstrapping_ciphertext_array(2 * n, params);
+
+        for (const Operation &operation: operations) {
+            TfheIntegerCircuit *circuit = new_TfheIntegerCircuit(bk);
+            operation.record(circuit, result, a, b, shift, n);
+            cout << n << "-bit " << operation.name << ": " << tfhe_integer_nb_bootstraps(circuit)
+                 << " bootstraps, depth " << tfhe_integer_depth(circuit) << endl;
+
+            for (int32_t nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2) {
+                const uint64_t x = random_bits(n), y = random_bits(n);
+                const int32_t s = rand() % n;
+                for (int32_t i = 0; i < n; i++) {
+                    bootsSymEncrypt(a + i, (x >> i) & 1, key);
+                    bootsSymEncrypt(b + i, (y >> i) & 1, key);
+                }
+                for (int32_t i = 0; i < nb_shift_bits; i++) bootsSymEncrypt(shift + i, (s >> i) & 1, key);
+                for (int32_t i = 0; i < 2 * n; i++) bootsCONSTANT(result + i, 0, bk);
+                const double start = tfhe_steady_time();
+                tfhe_integer_run(circuit, nb_threads);
+                const double time = tfhe_steady_time() - start;
+                uint128 plain = 0;
+                for (int32_t i = 0; i < 2 * n; i++) plain |= uint128(bootsSymDecrypt(result + i, key)) << i;
+                cout << "    " << nb_threads << " threads: " << time << " s"
+                     << (plain == operation.plain(x, y, n, s) ? "" : " WRONG RESULT") << endl;
+            }
+            delete_TfheIntegerCircuit(circuit);
+        }
+
+        delete_gate_bootstrapping_ciphertext_array(2 * n, result);
+        delete_gate_bootstrapping_ciphertext_array(nb_shift_bits, shift);
+        delete_gate_bootstrapping_ciphertext_array(n, b);
+        delete_gate_bootstrapping_ciphertext_array(n, a);
+    }
+
+    delete_gate_bootstrapping_secret_keyset(key);
+    delete_gate_bootstrapping_parameters(params);
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+#include "tfhe.h"
+
+using namespace std;
+
+namespace {
+
+    const LweParams *in_params = new_LweParams(64, 0., 1.);
+    const LweParams *out_params = new_LweParams(32, 1e-5, 1.);
+
+    class ThreadsTest : public ::testing::Test {
+    public:
+        //generates a small keyswitch key with the given seed and number of threads
+        LweKeySwitchKey *create_ks(uint32_t seed, int32_t nb_threads, const LweParams *ks_out_params = out_params) {
+            LweKey *in_key = new_LweKey(in_params);
+            LweKey *out_key = new_LweKey(ks_out_params);
+            for (int32_t i = 0; i < in_params->n; i++) in_key->key[i] = i % 3 == 0;
+            for (int32_t i = 0; i < ks_out_params->n; i++) out_key->key[i] = i % 2 == 0;
+
+            LweKeySwitchKey *ks = new_LweKeySwitchKey(in_params->n, 4, 2, ks_out_params);
+            tfhe_set_nb_threads(nb_threads);
+            tfhe_random_generator_setSeed(&seed, 1);
+            lweCreateKeySwitchKey(ks, in_key, out_key);
+            tfhe_set_nb_threads(0);
+
+            delete_LweKey(out_key);
+            delete_LweKey(in_key);
+            return ks;
+        }
+    };
+
+    TEST_F(ThreadsTest, parallelForCallsEachTaskOnce) {
+        const int32_t nb_tasks = 1000;
+        vector<atomic<int32_t>> counts(nb_tasks);
+        for (auto &c: counts) c = 0;
+        for (int32_t nb_threads = 1; nb_threads <= 8; nb_threads *= 2) {
+            tfhe_parallel_for(nb_tasks, [&](int32_t i) { counts[i]++; }, nb_threads);
+        }
+        for (int32_t i = 0; i < nb_tasks; i++) ASSERT_EQ(4, counts[i]);
+    }
+
+    TEST_F(ThreadsTest, nbThreadsSetting) {
+        tfhe_set_nb_threads(3);
+        ASSERT_EQ(3, tfhe_get_nb_threads());
+        tfhe_set_nb_threads(0);
+        ASSERT_GE(tfhe_get_nb_threads(), 1);
+    }
+
+    //the generated key must not depend on the number of threads
+    TEST_F(ThreadsTest, keySwitchKeyGenerationIsDeterministic) {
+        LweKeySwitchKey *ks1 = create_ks(42, 1);
+        LweKeySwitchKey *ks4 = create_ks(42, 4);
+        const int32_t n_out = out_params->n;
+        for (int32_t i = 0; i < ks1->n; i++) {
+            for (int32_t j = 0; j < ks1->t; j++) {
+                for (int32_t h = 1; h < ks1->base; h++) {
+                    for (int32_t p = 0; p <= n_out; p++) ASSERT_EQ(ks1->entry(i, j, h)[p], ks4->entry(i, j, h)[p]);
+                }
+            }
+        }
+        delete_LweKeySwitchKey(ks4);
+        delete_LweKeySwitchKey(ks1);
+    }
+
+    //many short loops in a row, and nested loops (which run inline)
+    TEST_F(ThreadsTest, threadTeamReuseAndNesting) {
+        TfheThreadTeam team;
+        const int32_t nb_tasks = 16;
+        vector<atomic<int32_t>> counts(nb_tasks * nb_tasks);
+        for (auto &c: counts) c = 0;
+        for (int32_t iter = 0; iter < 200; iter++) {
+            team.run(nb_tasks, [&](int32_t i) { counts[i]++; }, 1 + iter % 4);
+        }
+        for (int32_t i = 0; i < nb_tasks; i++) ASSERT_EQ(200, counts[i]);
+
+        for (auto &c: counts) c = 0;
+        team.run(nb_tasks, [&](int32_t i) {
+            team.run(nb_tasks, [&](int32_t j) { counts[i * nb_tasks + j]++; }, 4);
+            tfhe_parallel_for(nb_tasks, [&](int32_t j) { counts[i * nb_tasks + j]++; }, 4);
+        }, 4);
+        for (int32_t i = 0; i < nb_tasks * nb_tasks; i++) ASSERT_EQ(2, counts[i]);
+    }
+
+    //the keyswitch split across the gate threads gives the same result
+    TEST_F(ThreadsTest, parallelKeySwitch) {
+        //several blocks of output coefficients
+        LweParams *big_out_params = new_LweParams(300, 1e-5, 1.);
+        LweKeySwitchKey *ks = create_ks(42, 1, big_out_params);
+        LweKey *in_key = new_LweKey(in_params);
+        lweKeyGen(in_key);
+        LweSample *sample = new_LweSample(in_params);
+        LweSample *res1 = new_LweSample(big_out_params);
+        LweSample *res4 = new_LweSample(big_out_params);
+        for (int32_t trial = 0; trial < 20; trial++) {
+            lweSymEncrypt(sample, trial << 20, 1e-5, in_key);
+            tfhe_set_nb_gate_threads(1);
+            lweKeySwitch(res1, ks, sample);
+            tfhe_set_nb_gate_threads(4);
+            lweKeySwitch(res4, ks, sample);
+            tfhe_set_nb_gate_threads(1);
+            ASSERT_EQ(res1->b, res4->b);
+            for (int32_t p = 0; p < big_out_params->n; p++) ASSERT_EQ(res1->a[p], res4->a[p]);
+            ASSERT_EQ(res1->current_variance, res4->current_variance);
+        }
+        delete_LweSample(res4);
+        delete_LweSample(res1);
+        delete_LweSample(sample);
+        delete_LweKey(in_key);
+        delete_LweKeySwitchKey(ks);
+        delete_LweParams(big_out_params);
+    }
+
+    //the values cross the queue in order, whatever the interleaving of the two threads
+    TEST_F(ThreadsTest, spscQueue) {
+        static const int32_t NB_VALUES = 100000;
+        TfheSpscQueue<int32_t> queue(7);
+        int32_t value;
+        ASSERT_FALSE(queue.try_pop(value));
+        for (int32_t i = 0; i < 7; i++) ASSERT_TRUE(queue.try_push(i));
+        ASSERT_FALSE(queue.try_push(7));
+        for (int32_t i = 0; i < 7; i++) ASSERT_EQ(i, queue.pop());
+
+        thread producer([&queue] {
+            for (int32_t i = 0; i < NB_VALUES; i++) queue.push(i);
+        });
+        for (int32_t i = 0; i < NB_VALUES; i++) ASSERT_EQ(i, queue.pop());
+        producer.join();
+        ASSERT_FALSE(queue.try_pop(value));
+    }
+
+    TEST_F(ThreadsTest, numaTopology) {
+        const int32_t nb_nodes = tfhe_numa_nb_nodes();
+        ASSERT_GE(nb_nodes, 1);
+        ASSERT_GE(tfhe_numa_current_node(), 0);
+        ASSERT_LT(tfhe_numa_current_node(), nb_nodes);
+        for (int32_t nb_workers = 1; nb_workers <= 16; nb_workers++) {
+            ASSERT_EQ(0, tfhe_numa_node_of_worker(0, nb_workers));
+            for (int32_t i = 1; i < nb_workers; i++) {
+                ASSERT_GE(tfhe_numa_node_of_worker(i, nb_workers), tfhe_numa_node_of_worker(i - 1, nb_workers));
+                ASSERT_LT(tfhe_numa_node_of_worker(i, nb_workers), nb_nodes);
+            }
+        }
+    }
+
+}
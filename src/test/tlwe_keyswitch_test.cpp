@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+#include "tfhe.h"
+#include "small_params.h"
+
+using namespace std;
+
+namespace {
+
+    class TLweKeySwitchTest : public ::testing::Test {
+    public:
+        // the packing key of small_test_keyset, shared by the tests of this fixture
+        static LweToTLweKeySwitchKey *ks;
+
+        static void SetUpTestCase() {
+            const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+            const TLweKey *out_key = &key->tgsw_key->tlwe_key;
+            ks = new_LweToTLweKeySwitchKey(key->lwe_key->params->n, 6, 4, out_key->params);
+            tLweCreateKeySwitchKey(ks, key->lwe_key, out_key);
+        }
+
+        static void TearDownTestCase() {
+            delete_LweToTLweKeySwitchKey(ks);
+            ks = 0;
+        }
+
+        //the coefficient q of the packing of nb_samples LWE samples is the phase of the sample q
+        void check_packing(int32_t nb_samples, int32_t nb_threads) {
+            const TFheGateBootstrappingSecretKeySet *key = small_test_keyset();
+            const LweKey *in_key = key->lwe_key;
+            const TLweKey *out_key = &key->tgsw_key->tlwe_key;
+            const TLweParams *out_params = out_key->params;
+            const int32_t N = out_params->N;
+
+            LweSample *samples = new_LweSample_array(nb_samples, in_key->params);
+            vector<Torus32> mu(nb_samples);
+            for (int32_t q = 0; q < nb_samples; q++) {
+                mu[q] = modSwitchToTorus32(rand() % 8, 8);
+                lweSymEncrypt(samples + q, mu[q], in_key->params->alpha_min, in_key);
+            }
+            TLweSample *result = new_TLweSample(out_params);
+            TorusPolynomial *phase = new_TorusPolynomial(N);
+            tLwePackingKeySwitch(result, ks, samples, nb_samples, nb_threads);
+            tLwePhase(phase, result, out_key);
+            for (int32_t q = 0; q < N; q++) {
+                const Torus32 expected = (q < nb_samples) ? mu[q] : 0;
+                ASSERT_LT(torus_distance(phase->coefsT[q], expected), 1e-3);
+            }
+
+            delete_TorusPolynomial(phase);
+            delete_TLweSample(result);
+            delete_LweSample_array(nb_samples, samples);
+        }
+    };
+
+    LweToTLweKeySwitchKey *TLweKeySwitchTest::ks = 0;
+
+    //a few samples are rotated one by one
+    TEST_F(TLweKeySwitchTest, packFewSamples) {
+        check_packing(1, 1);
+        check_packing(10, 2);
+    }
+
+    //N samples are packed with fft products
+    TEST_F(TLweKeySwitchTest, packManySamples) {
+        check_packing(1024, 2);
+    }
+
+}
@@ -10,6 +10,9 @@
 #include <tlwe_functions.h>
 #include <numeric_functions.h>
 #include <polynomials_arithmetic.h>
+#include <lwekey.h>
+#include <lwesamples.h>
+#include <lwe-functions.h>
 
 using namespace std;
 
@@ -53,6 +56,11 @@ namespace {
     const double toler = 1e-8;
 
     class TLweTest : public ::testing::Test {
+    protected:
+        virtual void SetUp() {
+            seed_seq seeds = {42};
+            generator.seed(seeds);
+        }
     };
 
 
@@ -633,6 +641,58 @@ namespace {
      */
 
 
+    /*
+       Testing the function tLweExtractLweSamples
+     * EXPORT void tLweExtractLweSamples(LweSample* result, const TLweSample* x, const int32_t first,
+     *                                   const int32_t nb_samples, const LweParams* params, const TLweParams* rparams,
+     *                                   Torus32* rev)
+     *
+     * tLweExtractLweSamples extracts the coefficients first..first+nb_samples-1 of x, which must be
+     * the same samples as tLweExtractLweSampleIndex, and whose phases are the coefficients of the phase of x
+     */
+    TEST_F(TLweTest, tLweExtractLweSamples) {
+        for (const TLweKey *key: all_keys) {
+            const TLweParams *params = key->params;
+            const LweParams *extract_params = &params->extracted_lweparams;
+            const int32_t N = params->N;
+            const int32_t n = extract_params->n;
+            const int32_t first = rand() % (N / 2);
+            const int32_t nb_samples = N / 2;
+            TLweSample *sample = new_TLweSample(params);
+            TorusPolynomial *phase = new_TorusPolynomial(N);
+            LweSample *extracted = new_LweSample_array(nb_samples, extract_params);
+            LweSample *expected = new_LweSample(extract_params);
+            LweKey *extract_key = new_LweKey(extract_params);
+            Torus32 *rev = new Torus32[2 * N];
+            tLweExtractKey(extract_key, key);
+            fillRandom(sample, params);
+            // phase = b - sum a[i].key[i] (naive products: the fft only supports N=1024)
+            TorusPolynomial *product = new_TorusPolynomial(N);
+            torusPolynomialCopy(phase, sample->b);
+            for (int32_t i = 0; i < params->k; ++i) {
+                torusPolynomialMultNaive(product, &key->key[i], &sample->a[i]);
+                torusPolynomialSubTo(phase, product);
+            }
+            delete_TorusPolynomial(product);
+
+            tLweExtractLweSamples(extracted, sample, first, nb_samples, extract_params, params, rev);
+            for (int32_t s = 0; s < nb_samples; ++s) {
+                tLweExtractLweSampleIndex(expected, sample, first + s, extract_params, params);
+                for (int32_t j = 0; j < n; ++j) ASSERT_EQ(expected->a[j], extracted[s].a[j]);
+                ASSERT_EQ(expected->b, extracted[s].b);
+                ASSERT_EQ(phase->coefsT[first + s], lwePhase(extracted + s, extract_key));
+            }
+
+            delete[] rev;
+            delete_LweKey(extract_key);
+            delete_LweSample(expected);
+            delete_LweSample_array(nb_samples, extracted);
+            delete_TorusPolynomial(phase);
+            delete_TLweSample(sample);
+        }
+    }
+
+
 
 
 
@@ -0,0 +1,179 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/time.h>
+#include "tfhe.h"
+
+using namespace std;
+
+// evaluates a netlist (BLIF or Yosys JSON) on ciphertexts, or on plaintext bits
+
+static void usage() {
+    cerr << "usage: tfhe-netlist [options] netlist.(blif|json)\n"
+            "  without -k nor -p, prints the statistics of the netlist (after its optimization)\n"
+            "  -p bits   evaluates the netlist on the plaintext input bits (e.g. -p 0110) and prints the output bits\n"
+            "  -k file   the cloud key (written by export_tfheGateBootstrappingCloudKeySet_toFile)\n"
+            "  -i file   the input ciphertexts, one per input bit\n"
+            "  -o file   the output ciphertexts, one per output bit\n"
+            "  -s file   the register ciphertexts: read if the file exists (else the initial values), then\n"
+            "            rewritten with the next values\n"
+            "  -t n      the number of threads (default: one per core)\n"
+            "  -n n      evaluates n clock cycles: the input and output files hold the bits of each cycle,\n"
+            "            and the time of each cycle is printed (default: 1)\n"
+            "  -w list   evaluates on the tfhe-worker processes at these comma separated addresses\n"
+            "            (e.g. unix:/tmp/w0,host1:7000) instead of locally\n";
+    exit(1);
+}
+
+static FILE *open_file(const char *filename, const char *mode) {
+    FILE *F = fopen(filename, mode);
+    if (F == 0) {
+        cerr << "cannot open " << filename << endl;
+        exit(1);
+    }
+    return F;
+}
+
+static double now() {
+    timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + 1e-6 * t.tv_usec;
+}
+
+int32_t main(int32_t argc, char **argv) {
+    const char *plain_bits = 0;
+    const char *key_file = 0;
+    const char *input_file = 0;
+    const char *output_file = 0;
+    const char *state_file = 0;
+    int32_t nb_threads = 0;
+    int32_t nb_cycles = 1;
+    vector<string> workers;
+    int32_t arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg += 2) {
+        if (arg + 1 >= argc || argv[arg][2] != 0) usage();
+        const char *value = argv[arg + 1];
+        switch (argv[arg][1]) {
+            case 'p': plain_bits = value; break;
+            case 'k': key_file = value; break;
+            case 'i': input_file = value; break;
+            case 'o': output_file = value; break;
+            case 's': state_file = value; break;
+            case 't': nb_threads = atoi(value); break;
+            case 'n': nb_cycles = atoi(value); break;
+            case 'w': {
+                istringstream list(value);
+                string address;
+                while (getline(list, address, ',')) if (!address.empty()) workers.push_back(address);
+                break;
+            }
+            default: usage();
+        }
+    }
+    if (arg + 1 != argc || nb_cycles < 1 || (nb_cycles > 1 && !workers.empty())) usage();
+
+    TfheNetlist *netlist = new_TfheNetlist_fromFileName(argv[arg]);
+    if (netlist == 0) return 1;
+    const int32_t nb_saved_bootstraps = tfhe_netlist_optimize(netlist);
+    const int32_t nb_inputs = tfhe_netlist_nb_inputs(netlist);
+    const int32_t nb_outputs = tfhe_netlist_nb_outputs(netlist);
+    const int32_t nb_registers = tfhe_netlist_nb_registers(netlist);
+    int32_t status = 0;
+
+    if (plain_bits != 0) {
+        if (int32_t(strlen(plain_bits)) != nb_inputs) {
+            cerr << "expected " << nb_inputs << " input bits" << endl;
+            return 1;
+        }
+        int32_t *inputs = new int32_t[nb_inputs];
+        int32_t *outputs = new int32_t[nb_outputs];
+        int32_t *state = new int32_t[nb_registers];
+        for (int32_t i = 0; i < nb_inputs; i++) inputs[i] = plain_bits[i] == '1';
+        for (int32_t i = 0; i < nb_registers; i++) state[i] = tfhe_netlist_register_init(netlist, i);
+        tfhe_netlist_eval_plain(netlist, outputs, inputs, state);
+        for (int32_t i = 0; i < nb_outputs; i++) cout << outputs[i];
+        cout << endl;
+        delete[] state;
+        delete[] outputs;
+        delete[] inputs;
+    } else if (key_file != 0) {
+        if (input_file == 0 || output_file == 0) usage();
+        FILE *F = open_file(key_file, "rb");
+        TFheGateBootstrappingCloudKeySet *bk = new_tfheGateBootstrappingCloudKeySet_fromFile(F);
+        fclose(F);
+        const TFheGateBootstrappingParameterSet *params = bk->params;
+
+        LweSample *inputs = new_gate_bootstrapping_ciphertext_array(nb_cycles * nb_inputs, params);
+        LweSample *outputs = new_gate_bootstrapping_ciphertext_array(nb_cycles * nb_outputs, params);
+        LweSample *state = new_gate_bootstrapping_ciphertext_array(nb_registers, params);
+        F = open_file(input_file, "rb");
+        for (int32_t i = 0; i < nb_cycles * nb_inputs; i++)
+            import_gate_bootstrapping_ciphertext_fromFile(F, inputs + i, params);
+        fclose(F);
+        F = state_file ? fopen(state_file, "rb") : 0;
+        for (int32_t i = 0; i < nb_registers; i++) {
+            if (F) import_gate_bootstrapping_ciphertext_fromFile(F, state + i, params);
+            else bootsCONSTANT(state + i, tfhe_netlist_register_init(netlist, i), bk);
+        }
+        if (F) fclose(F);
+
+        const double start = now();
+        if (nb_cycles > 1) {
+            TfheSequentialEngine *engine = new_TfheSequentialEngine(netlist, bk, nb_threads, 0);
+            LweSample *engine_state = tfhe_sequential_state(engine);
+            for (int32_t i = 0; i < nb_registers; i++) lweCopy(engine_state + i, state + i, params->in_out_params);
+            tfhe_sequential_run(engine, outputs, inputs, nb_cycles);
+            for (int32_t i = 0; i < nb_registers; i++) lweCopy(state + i, engine_state + i, params->in_out_params);
+            for (int32_t c = 0; c < nb_cycles; c++) {
+                const TfheCycleStats stats = tfhe_sequential_cycle_stats(engine, c);
+                cerr << "cycle " << c << ": " << stats.start << " s to " << stats.end << " s" << endl;
+            }
+            delete_TfheSequentialEngine(engine);
+        } else if (workers.empty()) {
+            tfhe_netlist_eval(netlist, outputs, inputs, state, bk, nb_threads);
+        } else {
+            vector<const char *> addresses;
+            for (const string &address: workers) addresses.push_back(address.c_str());
+            TfheDistributedNetlist *distributed = new_TfheDistributedNetlist(netlist, addresses.data(),
+                                                                             addresses.size(), params);
+            if (distributed == 0 || !tfhe_distributed_eval(distributed, outputs, inputs, state)) status = 1;
+            else cerr << "transferred " << tfhe_distributed_nb_transfers(distributed) << " ciphertexts" << endl;
+            if (distributed) delete_TfheDistributedNetlist(distributed);
+        }
+
+        // on an error of the workers, nothing is written, but everything is freed
+        if (status == 0) {
+            cerr << "evaluated " << nb_cycles * tfhe_netlist_nb_bootstraps(netlist) << " bootstraps in "
+                 << now() - start << " s" << endl;
+            F = open_file(output_file, "wb");
+            for (int32_t i = 0; i < nb_cycles * nb_outputs; i++)
+                export_gate_bootstrapping_ciphertext_toFile(F, outputs + i, params);
+            fclose(F);
+            if (state_file) {
+                F = open_file(state_file, "wb");
+                for (int32_t i = 0; i < nb_registers; i++)
+                    export_gate_bootstrapping_ciphertext_toFile(F, state + i, params);
+                fclose(F);
+            }
+        }
+        delete_gate_bootstrapping_ciphertext_array(nb_registers, state);
+        delete_gate_bootstrapping_ciphertext_array(nb_cycles * nb_outputs, outputs);
+        delete_gate_bootstrapping_ciphertext_array(nb_cycles * nb_inputs, inputs);
+        delete_gate_bootstrapping_cloud_keyset(bk);
+    } else {
+        cout << "inputs: " << nb_inputs << endl;
+        cout << "outputs: " << nb_outputs << endl;
+        cout << "registers: " << nb_registers << endl;
+        cout << "gates: " << tfhe_netlist_nb_gates(netlist) << endl;
+        cout << "bootstraps: " << tfhe_netlist_nb_bootstraps(netlist) << " (" << nb_saved_bootstraps
+             << " saved by the optimization)" << endl;
+        cout << "levels: " << tfhe_netlist_nb_levels(netlist) << endl;
+    }
+
+    delete_TfheNetlist(netlist);
+    return status;
+}
@@ -0,0 +1,51 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include "tfhe.h"
+
+using namespace std;
+
+// a worker of the distributed netlist evaluation (see tfhe-netlist -w)
+
+static void usage() {
+    cerr << "usage: tfhe-worker [options] address\n"
+            "  address   unix:/path/to/socket, or host:port (e.g. *:7000 on all the interfaces)\n"
+            "  -k file   the cloud key (written by export_tfheGateBootstrappingCloudKeySet_toFile)\n"
+            "  -t n      the number of threads (default: one per core)\n"
+            "  -n n      exits after n sessions (default: serves forever)\n";
+    exit(1);
+}
+
+int32_t main(int32_t argc, char **argv) {
+    const char *key_file = 0;
+    int32_t nb_threads = 0;
+    int32_t nb_sessions = 0;
+    int32_t arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; arg += 2) {
+        if (arg + 1 >= argc || argv[arg][2] != 0) usage();
+        const char *value = argv[arg + 1];
+        switch (argv[arg][1]) {
+            case 'k': key_file = value; break;
+            case 't': nb_threads = atoi(value); break;
+            case 'n': nb_sessions = atoi(value); break;
+            default: usage();
+        }
+    }
+    if (arg + 1 != argc || key_file == 0) usage();
+
+    FILE *F = fopen(key_file, "rb");
+    if (F == 0) {
+        cerr << "cannot open " << key_file << endl;
+        return 1;
+    }
+    TFheGateBootstrappingCloudKeySet *bk = new_tfheGateBootstrappingCloudKeySet_fromFile(F);
+    fclose(F);
+
+    const int32_t listen_socket = tfhe_worker_listen(argv[arg]);
+    if (listen_socket < 0) return 1;
+    cerr << "listening on " << argv[arg] << endl;
+    tfhe_worker_serve(listen_socket, bk, nb_threads, nb_sessions);
+
+    delete_gate_bootstrapping_cloud_keyset(bk);
+    return 0;
+}